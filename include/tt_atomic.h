@@ -95,4 +95,21 @@ bool tt_atomic_compare_exchange(tt_atomic_int_t *atomic, int32_t *expected,
  */
 void tt_atomic_thread_fence(tt_memory_order_t order);
 
+/**
+ * @brief Hint to the CPU that the caller is busy-waiting
+ *
+ * Lowers power and frees pipeline resources for a sibling hardware thread
+ * while spinning. Compiles to a plain compiler barrier on targets without a
+ * dedicated instruction.
+ */
+static inline void tt_atomic_cpu_relax(void) {
+#if defined(__x86_64__) || defined(__i386__)
+  __builtin_ia32_pause();
+#elif defined(__aarch64__) || (defined(__arm__) && __ARM_ARCH >= 7)
+  __asm__ __volatile__("yield" ::: "memory");
+#else
+  __asm__ __volatile__("" ::: "memory");
+#endif
+}
+
 #endif // TT_ATOMIC_H_
@@ -0,0 +1,124 @@
+/**
+ * @file tt_barrier.h
+ * @author Mihai Gurei <mihai.gurei@protonmail.com>
+ * @date 2025-01-16
+ * @brief Thread barriers and countdown latches
+ * @copyright Copyright (c) 2025 AnAlphaBeta. All rights reserved.
+ */
+
+#ifndef TT_BARRIER_H_
+#define TT_BARRIER_H_
+
+#include "tt_platform.h"
+#include "tt_types.h"
+
+/* Polls of the wait word before a waiter parks in the kernel */
+#ifndef TT_BARRIER_SPIN_COUNT
+#define TT_BARRIER_SPIN_COUNT 512
+#endif
+
+/**
+ * @brief Reusable barrier for a fixed number of threads
+ *
+ * Each round is a generation: the last thread to arrive resets the arrival
+ * count and bumps the generation, which releases everybody waiting on the
+ * previous one. Waiters spin for TT_BARRIER_SPIN_COUNT polls, then park on
+ * the generation word.
+ */
+typedef struct {
+  volatile uint32_t arrived;    /**< Threads arrived in this generation*/
+  volatile uint32_t generation; /**< Completed rounds, wait word*/
+  volatile uint32_t waiters;    /**< Threads parked on generation*/
+  uint32_t count;               /**< Threads per round*/
+  bool initialized;             /**< Initialization state*/
+} tt_barrier_t;
+
+/**
+ * @brief One-shot countdown latch
+ *
+ * Waiters are released once the count reaches zero and stay released.
+ */
+typedef struct {
+  volatile uint32_t count;   /**< Remaining count downs, wait word*/
+  volatile uint32_t waiters; /**< Threads parked on count*/
+  bool initialized;          /**< Initialization state*/
+} tt_latch_t;
+
+/**
+ * @brief Initialize a barrier
+ * @param barrier Pointer to barrier
+ * @param count Number of threads that must call tt_barrier_wait per round
+ * @return TT_SUCCESS on success, TT_ERROR_INVALID_PARAM if count is 0
+ */
+tt_error_t tt_barrier_init(tt_barrier_t *barrier, uint32_t count);
+
+/**
+ * @brief Destroy a barrier
+ * @param barrier Pointer to barrier
+ * @return TT_SUCCESS on success, TT_ERROR_BUSY if a round is in progress
+ */
+tt_error_t tt_barrier_destroy(tt_barrier_t *barrier);
+
+/**
+ * @brief Block until all threads of the round have arrived
+ * @param barrier Pointer to barrier
+ * @param is_last Set to true for exactly one thread per round, may be NULL
+ * @return TT_SUCCESS on success, error code otherwise
+ */
+tt_error_t tt_barrier_wait(tt_barrier_t *barrier, bool *is_last);
+
+/**
+ * @brief Initialize a latch
+ * @param latch Pointer to latch
+ * @param count Number of count downs before waiters are released
+ * @return TT_SUCCESS on success, error code otherwise
+ */
+tt_error_t tt_latch_init(tt_latch_t *latch, uint32_t count);
+
+/**
+ * @brief Destroy a latch
+ * @param latch Pointer to latch
+ * @return TT_SUCCESS on success, TT_ERROR_BUSY if threads are still waiting
+ */
+tt_error_t tt_latch_destroy(tt_latch_t *latch);
+
+/**
+ * @brief Decrement the latch, releasing waiters when it reaches zero
+ * @param latch Pointer to latch
+ * @param n Amount to count down
+ * @return TT_SUCCESS on success, TT_ERROR_INVALID_PARAM if n exceeds the
+ * remaining count
+ */
+tt_error_t tt_latch_count_down(tt_latch_t *latch, uint32_t n);
+
+/**
+ * @brief Block until the latch reaches zero
+ * @param latch Pointer to latch
+ * @return TT_SUCCESS on success, error code otherwise
+ */
+tt_error_t tt_latch_wait(tt_latch_t *latch);
+
+/**
+ * @brief Block at most timeout_ms milliseconds for the latch to reach zero
+ * @param latch Pointer to latch
+ * @param timeout_ms Maximum time to wait in milliseconds
+ * @return TT_SUCCESS on success, TT_ERROR_TIMEOUT if the latch is still
+ * counting
+ */
+tt_error_t tt_latch_timedwait(tt_latch_t *latch, uint32_t timeout_ms);
+
+/**
+ * @brief Check whether the latch has reached zero
+ * @param latch Pointer to latch
+ * @return TT_SUCCESS if released, TT_ERROR_BUSY if still counting
+ */
+tt_error_t tt_latch_try_wait(tt_latch_t *latch);
+
+/**
+ * @brief Count down by one, then wait for the latch to reach zero
+ * @param latch Pointer to latch
+ * @return TT_SUCCESS on success, error code otherwise
+ */
+tt_error_t tt_latch_arrive_and_wait(tt_latch_t *latch);
+
+#endif // TT_BARRIER_H_
@@ -0,0 +1,193 @@
+/**
+ * @file tt_co.h
+ * @author Mihai Gurei <mihai.gurei@protonmail.com>
+ * @date 2025-02-12
+ * @brief Stackless coroutines and a cooperative round-robin scheduler
+ * @copyright Copyright (c) 2025 AnAlphaBeta. All rights reserved.
+ */
+
+#ifndef TT_CO_H_
+#define TT_CO_H_
+
+#include "tt_ringbuf.h"
+#include "tt_types.h"
+
+/**
+ * @brief Coroutine state: the line to resume at, 0 before the first run
+ *
+ * A coroutine is a plain function that runs from the top on every call and
+ * jumps back to where it last stopped, so it needs no stack of its own. The
+ * price is that its locals do not survive a TT_CO_YIELD or a wait: keep state
+ * that must outlive one in the argument or in statics. A coroutine body must
+ * not use the TT_CO_* macros inside a switch statement of its own.
+ */
+typedef struct {
+  uint16_t line;
+} tt_co_t;
+
+/**
+ * @brief Result of one call to a coroutine
+ */
+typedef enum {
+  TT_CO_WAITING = 0, /**< Blocked in a TT_CO_WAIT_* condition*/
+  TT_CO_YIELDED,     /**< Gave up the processor in TT_CO_YIELD*/
+  TT_CO_EXITED,      /**< Left early through TT_CO_EXIT*/
+  TT_CO_ENDED        /**< Reached TT_CO_END*/
+} tt_co_state_t;
+
+/**
+ * @brief Coroutine function prototype
+ *
+ * @param co Coroutine state
+ * @param arg Argument given to tt_co_spawn
+ * @return State reported by the TT_CO_* macros
+ */
+typedef tt_co_state_t (*tt_co_func_t)(tt_co_t *co, void *arg);
+
+/* Resume points are case labels reached by falling through on purpose */
+#if defined(__has_attribute)
+#if __has_attribute(fallthrough)
+#define TT_CO_FALLTHROUGH __attribute__((fallthrough))
+#endif
+#endif
+#ifndef TT_CO_FALLTHROUGH
+#define TT_CO_FALLTHROUGH                                                      \
+  do {                                                                         \
+  } while (0)
+#endif
+
+/* Start over from TT_CO_BEGIN on the next call */
+#define TT_CO_INIT(co) ((co)->line = 0)
+
+/* Open the coroutine body */
+#define TT_CO_BEGIN(co)                                                        \
+  {                                                                            \
+    bool tt_co_yielded = true;                                                 \
+    (void)tt_co_yielded;                                                       \
+    switch ((co)->line) {                                                      \
+    case 0:
+
+/* Close the coroutine body, the next call starts over */
+#define TT_CO_END(co)                                                          \
+  }                                                                            \
+  TT_CO_INIT(co);                                                              \
+  return TT_CO_ENDED;                                                          \
+  }
+
+/* Return to the caller, resume after this point on the next call */
+#define TT_CO_YIELD(co)                                                        \
+  do {                                                                         \
+    tt_co_yielded = false;                                                     \
+    (co)->line = __LINE__;                                                     \
+    TT_CO_FALLTHROUGH;                                                         \
+  case __LINE__:                                                               \
+    if (!tt_co_yielded) {                                                      \
+      return TT_CO_YIELDED;                                                    \
+    }                                                                          \
+  } while (0)
+
+/* Return to the caller until cond holds, checked again on every call */
+#define TT_CO_WAIT_UNTIL(co, cond)                                             \
+  do {                                                                         \
+    (co)->line = __LINE__;                                                     \
+    TT_CO_FALLTHROUGH;                                                         \
+  case __LINE__:                                                               \
+    if (!(cond)) {                                                             \
+      return TT_CO_WAITING;                                                    \
+    }                                                                          \
+  } while (0)
+
+#define TT_CO_WAIT_WHILE(co, cond) TT_CO_WAIT_UNTIL(co, !(cond))
+
+/* Wait for a byte to read from, or room to write to, a ring buffer */
+#define TT_CO_WAIT_READABLE(co, rb)                                            \
+  TT_CO_WAIT_UNTIL(co, !tt_ringbuf_is_empty(rb))
+#define TT_CO_WAIT_WRITABLE(co, rb)                                            \
+  TT_CO_WAIT_UNTIL(co, !tt_ringbuf_is_full(rb))
+
+/* Leave the coroutine, the next call starts over */
+#define TT_CO_EXIT(co)                                                         \
+  do {                                                                         \
+    TT_CO_INIT(co);                                                            \
+    return TT_CO_EXITED;                                                       \
+  } while (0)
+
+/**
+ * @brief Coroutine slot of a scheduler
+ *
+ * Owned by the caller, so the scheduler never allocates: a static array of
+ * these is all a target without a heap needs.
+ */
+typedef struct tt_co_task_t {
+  tt_co_t co;
+  tt_co_func_t func;
+  void *arg;
+  struct tt_co_task_t *next;
+} tt_co_task_t;
+
+/**
+ * @brief Cooperative round-robin scheduler
+ *
+ * Runs every coroutine once per pass, in spawn order. It is not thread safe;
+ * one thread, or the main loop of a bare-metal target, drives it.
+ */
+typedef struct {
+  tt_co_task_t *head;
+  tt_co_task_t *tail;
+  size_t count; /**< Coroutines not finished yet*/
+} tt_co_sched_t;
+
+/**
+ * @brief Initialize an empty scheduler
+ * @param sched Scheduler to initialize
+ * @return TT_SUCCESS on success, error code otherwise
+ */
+tt_error_t tt_co_sched_init(tt_co_sched_t *sched);
+
+/**
+ * @brief Add a coroutine to the end of the round
+ *
+ * The task must stay valid until the coroutine finishes, after which the
+ * scheduler no longer touches it.
+ *
+ * @param sched Scheduler
+ * @param task Slot for the coroutine
+ * @param func Coroutine function
+ * @param arg Coroutine argument
+ * @return TT_SUCCESS on success, error code otherwise
+ */
+tt_error_t tt_co_spawn(tt_co_sched_t *sched, tt_co_task_t *task,
+                       tt_co_func_t func, void *arg);
+
+/**
+ * @brief Run every coroutine once
+ *
+ * Coroutines that end or exit are dropped. Coroutines spawned during the pass
+ * first run on the next one.
+ *
+ * @param sched Scheduler
+ * @param progress Set to true when any coroutine did not just report
+ * TT_CO_WAITING, may be NULL
+ * @return TT_SUCCESS on success, error code otherwise
+ */
+tt_error_t tt_co_sched_step(tt_co_sched_t *sched, bool *progress);
+
+/**
+ * @brief Run passes until every coroutine has finished
+ *
+ * Polls for as long as a coroutine waits, so the conditions it waits on must
+ * be changed by another coroutine or from outside, e.g. an interrupt.
+ *
+ * @param sched Scheduler
+ * @return TT_SUCCESS on success, error code otherwise
+ */
+tt_error_t tt_co_sched_run(tt_co_sched_t *sched);
+
+/**
+ * @brief Number of coroutines not finished yet
+ * @param sched Scheduler
+ * @return Number of coroutines, 0 for NULL
+ */
+size_t tt_co_sched_count(const tt_co_sched_t *sched);
+
+#endif // TT_CO_H_
@@ -10,18 +10,92 @@
 #define TT_ERROR_H_
 
 #include "tt_mutex.h"
+#include "tt_once.h"
 #include "tt_platform.h"
 #include "tt_thread.h"
 #include "tt_types.h"
 
+#if defined(TT_TARGET_FREERTOS)
+/* Task local storage slot holding the per-task error state */
+#ifndef TT_ERROR_TLS_INDEX
+#define TT_ERROR_TLS_INDEX 0
+#endif
+#endif
+
+/* Recent errors remembered per thread, must be a power of two */
+#ifndef TT_ERROR_RING_SIZE
+#define TT_ERROR_RING_SIZE 8
+#endif
+
+/* Callbacks that can be registered at the same time */
+#ifndef TT_ERROR_MAX_CALLBACKS
+#define TT_ERROR_MAX_CALLBACKS 4
+#endif
+
+/* Errors buffered for the async dispatcher, must be a power of two */
+#ifndef TT_ERROR_QUEUE_SIZE
+#define TT_ERROR_QUEUE_SIZE 64
+#endif
+
+/**
+ * @brief Error callback function
+ */
+typedef void (*tt_error_callback_t)(tt_error_t);
+
+/**
+ * @brief Error delivered to event callbacks
+ */
+typedef struct {
+  tt_error_t code;       /**< Error code*/
+  uint32_t repeats;      /**< Occurrences suppressed since the last delivery*/
+  uint64_t timestamp_ns; /**< Monotonic time of the report*/
+} tt_error_event_t;
+
+/**
+ * @brief Error callback function receiving the full event
+ */
+typedef void (*tt_error_event_callback_t)(const tt_error_event_t *event);
+
+/* Selects every error code in the rate limiting setters */
+#define TT_ERROR_ALL_CODES TT_ERROR_CODE_COUNT
+
+/**
+ * @brief Error occurrence captured by TT_ERROR_RAISE
+ *
+ * Strings point at static storage, nothing is formatted when recording.
+ */
+typedef struct {
+  tt_error_t code;       /**< Error code*/
+  const char *file;      /**< Source file of the raise site*/
+  const char *func;      /**< Function of the raise site*/
+  uint32_t line;         /**< Source line of the raise site*/
+  uint64_t timestamp_ns; /**< Monotonic time of the raise*/
+} tt_error_record_t;
+
+#if !defined(TT_ERROR_NO_STATS)
+/**
+ * @brief Occurrence statistics of one error code
+ */
+typedef struct {
+  tt_error_t code;        /**< Error code*/
+  uint64_t count;         /**< Times reported*/
+  uint64_t first_seen_ns; /**< Monotonic time of the first report, 0 if none*/
+  uint64_t last_seen_ns;  /**< Monotonic time of the last report, 0 if none*/
+} tt_error_stats_t;
+#endif /* TT_ERROR_NO_STATS */
+
 /**
  * @brief Error context structure
+ *
+ * The last error is kept per thread, outside of this structure, so that
+ * reporting never takes a lock and threads do not see each other's errors.
  */
 typedef struct {
-  tt_error_t last_error;        /**< Last error occured*/
-  void (*callback)(tt_error_t); /**< Error callback function*/
-  tt_mutex_t mutex;             /**< Mutex for thread safety*/
-  bool initialized;             /**< Initialization state*/
+  tt_error_callback_t callbacks[TT_ERROR_MAX_CALLBACKS]; /**< Atomic slots*/
+  tt_error_event_callback_t
+      event_callbacks[TT_ERROR_MAX_CALLBACKS]; /**< Atomic slots*/
+  tt_mutex_t mutex; /**< Serializes registration and dispatcher control*/
+  tt_once_t once;   /**< Initialization state*/
 } tt_error_context_t;
 
 /**
@@ -37,14 +111,14 @@ tt_error_t tt_error_init(void);
 tt_error_t tt_error_deinit(void);
 
 /**
- * @brief Get the last error that occured
+ * @brief Get the last error that occured on the calling thread
  * @return The last error code
  */
 tt_error_t tt_error_get_last(void);
 
 /**
- * @brief Set the last error code
- * @param error Error code to convert
+ * @brief Set the last error code of the calling thread
+ * @param error Error code to set
  * @return TT_SUCCESS if set successfully, error code otherwise
  */
 tt_error_t tt_error_set_last(tt_error_t error);
@@ -70,10 +144,163 @@ tt_error_t tt_error_clear(void);
 
 /**
  * @brief Register a callback for error handling
- * @param callback Function pointer to error handle
+ *
+ * Replaces every registered callback, event callbacks included, with this
+ * one.
+ *
+ * @param callback Function pointer to error handle, NULL removes all
  * @return TT_SUCCESS if callback was register successfully, error code
  * otherwise
  */
 tt_error_t tt_error_register_callback(void (*callback)(tt_error_t));
 
+/**
+ * @brief Add a callback next to the already registered ones
+ * @param callback Function pointer to error handler
+ * @return TT_SUCCESS on success, TT_ERROR_BUFFER_FULL if
+ * TT_ERROR_MAX_CALLBACKS are already registered, error code otherwise
+ */
+tt_error_t tt_error_add_callback(tt_error_callback_t callback);
+
+/**
+ * @brief Remove a callback added with tt_error_add_callback
+ *
+ * With async dispatch, the callback may still be running on the dispatcher
+ * thread when this returns.
+ *
+ * @param callback Function pointer to error handler
+ * @return TT_SUCCESS on success, TT_ERROR_NOT_FOUND if not registered
+ */
+tt_error_t tt_error_remove_callback(tt_error_callback_t callback);
+
+/**
+ * @brief Add a callback receiving the code, timestamp and repeat count
+ * @param callback Function pointer to event handler
+ * @return TT_SUCCESS on success, TT_ERROR_BUFFER_FULL if
+ * TT_ERROR_MAX_CALLBACKS are already registered, error code otherwise
+ */
+tt_error_t tt_error_add_event_callback(tt_error_event_callback_t callback);
+
+/**
+ * @brief Remove a callback added with tt_error_add_event_callback
+ * @param callback Function pointer to event handler
+ * @return TT_SUCCESS on success, TT_ERROR_NOT_FOUND if not registered
+ */
+tt_error_t tt_error_remove_event_callback(tt_error_event_callback_t callback);
+
+/**
+ * @brief Limit how often callbacks are invoked for an error code
+ *
+ * Token bucket: up to burst deliveries back to back, refilled at
+ * per_second. Reports over the limit still update the last error and the
+ * statistics. They are counted and handed to event callbacks as repeats
+ * with the next delivered occurrence of the code.
+ *
+ * @param code Error code, or TT_ERROR_ALL_CODES
+ * @param per_second Sustained deliveries per second, 0 removes the limit
+ * @param burst Deliveries allowed back to back, at least 1
+ * @return TT_SUCCESS on success, TT_ERROR_INVALID_PARAM on a bad code
+ */
+tt_error_t tt_error_set_rate_limit(tt_error_t code, uint32_t per_second,
+                                   uint32_t burst);
+
+/**
+ * @brief Collapse bursts of the same error code
+ *
+ * After a delivery, further occurrences of the code within window_ms are
+ * suppressed and reported as repeats of the next delivered one.
+ *
+ * @param code Error code, or TT_ERROR_ALL_CODES
+ * @param window_ms Deduplication window, 0 disables it
+ * @return TT_SUCCESS on success, TT_ERROR_INVALID_PARAM on a bad code
+ */
+tt_error_t tt_error_set_dedup_window(tt_error_t code, uint32_t window_ms);
+
+/**
+ * @brief Deliver callbacks from a dispatcher thread
+ *
+ * Once started, tt_error_set_last only pushes the error to a lock-free
+ * queue of TT_ERROR_QUEUE_SIZE entries, and a thread created with
+ * tt_thread_create runs the callbacks. Errors reported while the queue is
+ * full are dropped and counted.
+ *
+ * @return TT_SUCCESS on success, TT_ERROR_ALREADY_INITIALIZED if already
+ * running or still stopping, TT_ERROR_NOT_IMPLEMENTED without TT_CAP_THREADS
+ */
+tt_error_t tt_error_dispatch_start(void);
+
+/**
+ * @brief Deliver the queued errors, stop the dispatcher thread and go back
+ * to calling callbacks on the reporting thread
+ *
+ * The callbacks it drains may register or remove callbacks, but must not
+ * call this function themselves.
+ *
+ * @return TT_SUCCESS on success, TT_ERROR_NOT_INITIALIZED if not running
+ */
+tt_error_t tt_error_dispatch_stop(void);
+
+/**
+ * @brief Get the number of errors dropped because the queue was full
+ * @return Dropped errors since tt_error_dispatch_start
+ */
+uint32_t tt_error_dispatch_dropped(void);
+
+#if !defined(TT_ERROR_NO_STATS)
+/**
+ * @brief Copy the per-code statistics without stopping reporters
+ *
+ * Entries are indexed by error code. Each entry is re-read until its count
+ * is stable, so its timestamps are never older than the reports its count
+ * includes. Codes outside the enum are accounted under TT_ERROR_UNKNOWN.
+ *
+ * @param stats Output array
+ * @param max Capacity of stats, TT_ERROR_CODE_COUNT to get every code
+ * @return Number of entries copied
+ */
+size_t tt_error_stats_snapshot(tt_error_stats_t *stats, size_t max);
+
+/**
+ * @brief Zero all per-code statistics
+ */
+void tt_error_stats_reset(void);
+#endif /* TT_ERROR_NO_STATS */
+
+/**
+ * @brief Record an error with its raise site, then set it as last error
+ *
+ * Use through TT_ERROR_RAISE. Recording works before tt_error_init, only the
+ * last error update and callback need it.
+ *
+ * @param code Error code
+ * @param file Source file, must have static storage
+ * @param line Source line
+ * @param func Function name, must have static storage
+ * @return code, so that callers can write return TT_ERROR_RAISE(...)
+ */
+tt_error_t tt_error_raise_at(tt_error_t code, const char *file, int line,
+                             const char *func);
+
+/* Report an error together with the place it was raised from */
+#define TT_ERROR_RAISE(code)                                                   \
+  tt_error_raise_at((code), __FILE__, __LINE__, __func__)
+
+/**
+ * @brief Copy the calling thread's most recent raised errors
+ * @param records Output array, newest first
+ * @param max Capacity of records
+ * @return Number of records copied
+ */
+size_t tt_error_recent(tt_error_record_t *records, size_t max);
+
+/**
+ * @brief Print the calling thread's most recent raised errors to stdout
+ */
+void tt_error_dump_recent(void);
+
+/**
+ * @brief Forget the calling thread's raised errors
+ */
+void tt_error_clear_recent(void);
+
 #endif // TT_ERROR_H_
@@ -0,0 +1,165 @@
+/**
+ * @file tt_fiber.h
+ * @author Mihai Gurei <mihai.gurei@protonmail.com>
+ * @date 2025-02-10
+ * @brief Stackful user-space fibers scheduled on worker threads
+ * @copyright Copyright (c) 2025 AnAlphaBeta. All rights reserved.
+ */
+
+#ifndef TT_FIBER_H_
+#define TT_FIBER_H_
+
+#include "tt_platform.h"
+#include "tt_types.h"
+
+/* Default usable stack size of a fiber, one guard page comes on top */
+#ifndef TT_FIBER_STACK_SIZE
+#define TT_FIBER_STACK_SIZE (64 * 1024)
+#endif
+
+/* Buckets of the table that tracks fibers blocked in tt_fiber_wait */
+#ifndef TT_FIBER_WAIT_BUCKETS
+#define TT_FIBER_WAIT_BUCKETS 256
+#endif
+
+/* tt_fiber_wait timeout that never expires */
+#define TT_FIBER_WAIT_FOREVER UINT32_MAX
+
+/**
+ * @brief Fiber scheduler handle
+ */
+typedef struct tt_fiber_scheduler_t tt_fiber_scheduler_t;
+
+/**
+ * @brief Fiber handle
+ */
+typedef struct tt_fiber_t tt_fiber_t;
+
+/**
+ * @brief Fiber function prototype
+ */
+typedef void (*tt_fiber_func_t)(void *arg);
+
+/**
+ * @brief Create a fiber scheduler
+ *
+ * Starts num_workers threads, each running its own queue of fibers. A fiber
+ * stays on the worker it was first given to, so it always sees the same
+ * thread-local storage. Switching between fibers is a handful of register
+ * moves in assembly on x86-64 and AArch64, and goes through ucontext
+ * elsewhere or when TT_FIBER_UCONTEXT is defined.
+ *
+ * Fiber stacks are mapped with a guard page below them and are kept in a
+ * pool when their fiber finishes, for the next fiber to reuse.
+ *
+ * @param scheduler Pointer to store the scheduler handle
+ * @param num_workers Number of worker threads
+ * @param stack_size Usable stack size of every fiber, 0 for
+ * TT_FIBER_STACK_SIZE
+ * @return TT_SUCCESS on success, TT_ERROR_NOT_IMPLEMENTED without
+ * TT_CAP_THREADS, error code otherwise
+ */
+tt_error_t tt_fiber_scheduler_create(tt_fiber_scheduler_t **scheduler,
+                                     size_t num_workers, size_t stack_size);
+
+/**
+ * @brief Wait for every fiber to finish, then stop the workers
+ *
+ * Must not be called from a fiber of the same scheduler. Every joinable fiber
+ * must have been joined before.
+ *
+ * @param scheduler Scheduler handle
+ * @return TT_SUCCESS on success, error code otherwise
+ */
+tt_error_t tt_fiber_scheduler_destroy(tt_fiber_scheduler_t *scheduler);
+
+/**
+ * @brief Start a fiber
+ *
+ * Workers are picked round robin.
+ *
+ * @param scheduler Scheduler handle
+ * @param func Fiber function
+ * @param arg Fiber argument
+ * @param fiber Pointer to store a handle for tt_fiber_join, or NULL for a
+ * fiber that cleans up after itself
+ * @return TT_SUCCESS on success, error code otherwise
+ */
+tt_error_t tt_fiber_spawn(tt_fiber_scheduler_t *scheduler,
+                          tt_fiber_func_t func, void *arg,
+                          tt_fiber_t **fiber);
+
+/**
+ * @brief Wait for a fiber to finish and release its handle
+ *
+ * From a fiber only the calling fiber blocks, its worker keeps going.
+ *
+ * @param fiber Fiber handle from tt_fiber_spawn
+ * @return TT_SUCCESS on success, error code otherwise
+ */
+tt_error_t tt_fiber_join(tt_fiber_t *fiber);
+
+/**
+ * @brief Let the other ready fibers of this worker run
+ * @return TT_SUCCESS on success, TT_ERROR_NOT_INITIALIZED outside a fiber
+ */
+tt_error_t tt_fiber_yield(void);
+
+/**
+ * @brief Put the calling fiber to sleep
+ *
+ * Outside a fiber the calling thread sleeps instead.
+ *
+ * @param ms Time to sleep in milliseconds
+ * @return TT_SUCCESS on success, error code otherwise
+ */
+tt_error_t tt_fiber_sleep(uint32_t ms);
+
+/**
+ * @brief Block the calling fiber while a 32-bit word holds a value
+ *
+ * The fiber counterpart of tt_platform_futex_wait, to build blocking
+ * primitives that park fibers rather than worker threads. The check and the
+ * park are atomic with respect to tt_fiber_wake. Outside a fiber the calling
+ * thread blocks on the futex, and tt_fiber_wake wakes it too. May return
+ * spuriously, so callers re-check their condition in a loop.
+ *
+ * @param addr Address of the word to wait on
+ * @param expected Value the word must hold for the fiber to park
+ * @param timeout_ms Timeout in milliseconds, or TT_FIBER_WAIT_FOREVER
+ * @return TT_SUCCESS when woken or the value changed, TT_ERROR_TIMEOUT when
+ * the timeout passed
+ */
+tt_error_t tt_fiber_wait(volatile uint32_t *addr, uint32_t expected,
+                         uint32_t timeout_ms);
+
+/**
+ * @brief Wake fibers and threads blocked in tt_fiber_wait on a word
+ *
+ * May be called from any thread, fiber or not.
+ *
+ * @param addr Address of the word
+ * @param count Maximum number of waiters to wake, or TT_PLATFORM_WAKE_ALL
+ * @return TT_SUCCESS on success, error code otherwise
+ */
+tt_error_t tt_fiber_wake(volatile uint32_t *addr, uint32_t count);
+
+/**
+ * @brief Get the fiber running on the calling thread
+ * @return Fiber handle, or NULL outside a fiber
+ */
+tt_fiber_t *tt_fiber_self(void);
+
+/**
+ * @brief Number of sleep and wait timeouts currently armed
+ *
+ * A timeout is disarmed as soon as its fiber resumes, so this is at most the
+ * number of fibers blocked with a timeout. Meant for diagnostics: the value
+ * may be stale by the time it is returned.
+ *
+ * @param scheduler Scheduler
+ * @return Number of armed timeouts across all workers, 0 for NULL
+ */
+size_t tt_fiber_scheduler_timers(const tt_fiber_scheduler_t *scheduler);
+
+#endif // TT_FIBER_H_
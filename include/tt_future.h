@@ -0,0 +1,121 @@
+/**
+ * @file tt_future.h
+ * @author Mihai Gurei <mihai.gurei@protonmail.com>
+ * @date 2025-01-30
+ * @brief Futures for results produced on other threads
+ * @copyright Copyright (c) 2025 AnAlphaBeta. All rights reserved.
+ */
+
+#ifndef TT_FUTURE_H_
+#define TT_FUTURE_H_
+
+#include "tt_threadpool.h"
+#include "tt_types.h"
+
+/**
+ * @brief Future handle
+ *
+ * Reference counted: every function that hands out a future gives the caller
+ * one reference, to be dropped with tt_future_release.
+ */
+typedef struct tt_future_t tt_future_t;
+
+/**
+ * @brief Function producing the value of a future
+ */
+typedef void *(*tt_future_func_t)(void *arg);
+
+/**
+ * @brief Continuation mapping the value of a future to the value of the next
+ */
+typedef void *(*tt_future_then_func_t)(void *value, void *arg);
+
+/**
+ * @brief Create a future that is completed with tt_future_set
+ * @param future Pointer to store the future
+ * @return TT_SUCCESS on success, TT_ERROR_NOT_IMPLEMENTED without
+ * TT_CAP_THREADS, error code otherwise
+ */
+tt_error_t tt_future_create(tt_future_t **future);
+
+/**
+ * @brief Run a function on a thread pool and get its result as a future
+ * @param pool Thread pool
+ * @param func Function whose return value completes the future
+ * @param arg Function argument
+ * @param future Pointer to store the future
+ * @return TT_SUCCESS on success, error code otherwise
+ */
+tt_error_t tt_future_async(tt_threadpool_t *pool, tt_future_func_t func,
+                           void *arg, tt_future_t **future);
+
+/**
+ * @brief Complete a future
+ *
+ * Wakes every waiter, then runs the registered continuations on the calling
+ * thread in registration order.
+ *
+ * @param future Future
+ * @param value Result value
+ * @return TT_SUCCESS on success, TT_ERROR_ALREADY_INITIALIZED if the future
+ * was already completed
+ */
+tt_error_t tt_future_set(tt_future_t *future, void *value);
+
+/**
+ * @brief Check whether a future has been completed
+ * @param future Future
+ * @return true if a value is available, false otherwise or if future is NULL
+ */
+bool tt_future_is_ready(const tt_future_t *future);
+
+/**
+ * @brief Wait for the value of a future
+ * @param future Future
+ * @param value Pointer to store the value, may be NULL
+ * @return TT_SUCCESS on success, error code otherwise
+ */
+tt_error_t tt_future_get(tt_future_t *future, void **value);
+
+/**
+ * @brief Wait for the value of a future with a timeout
+ * @param future Future
+ * @param value Pointer to store the value, may be NULL
+ * @param timeout_ms Timeout in milliseconds
+ * @return TT_SUCCESS on success, TT_ERROR_TIMEOUT if the future was not
+ * completed in time, error code otherwise
+ */
+tt_error_t tt_future_timedget(tt_future_t *future, void **value,
+                              uint32_t timeout_ms);
+
+/**
+ * @brief Chain a continuation onto a future
+ *
+ * The continuation runs on the thread that completes @p future, or right away
+ * on the calling thread if it is already complete. Its return value completes
+ * @p next.
+ *
+ * @param future Future to continue
+ * @param func Continuation
+ * @param arg Continuation argument
+ * @param next Pointer to store the future of the continuation
+ * @return TT_SUCCESS on success, error code otherwise
+ */
+tt_error_t tt_future_then(tt_future_t *future, tt_future_then_func_t func,
+                          void *arg, tt_future_t **next);
+
+/**
+ * @brief Take an additional reference to a future
+ * @param future Future
+ * @return TT_SUCCESS on success, error code otherwise
+ */
+tt_error_t tt_future_retain(tt_future_t *future);
+
+/**
+ * @brief Drop a reference to a future, freeing it with the last one
+ * @param future Future
+ * @return TT_SUCCESS on success, error code otherwise
+ */
+tt_error_t tt_future_release(tt_future_t *future);
+
+#endif // TT_FUTURE_H_
@@ -0,0 +1,80 @@
+/**
+ * @file tt_lockdep.h
+ * @author Mihai Gurei <mihai.gurei@protonmail.com>
+ * @date 2025-01-14
+ * @brief Lock dependency validator for debug builds
+ * @copyright Copyright (c) 2025 AnAlphaBeta. All rights reserved.
+ */
+
+#ifndef TT_LOCKDEP_H_
+#define TT_LOCKDEP_H_
+
+#include "tt_types.h"
+
+#if defined(TT_LOCKDEP)
+/* Maximum number of lock classes, at most 64 (one bitmap word per class) */
+#ifndef TT_LOCKDEP_MAX_CLASSES
+#define TT_LOCKDEP_MAX_CLASSES 64
+#endif
+
+/* Maximum number of locks a single thread can hold at once */
+#ifndef TT_LOCKDEP_MAX_DEPTH
+#define TT_LOCKDEP_MAX_DEPTH 16
+#endif
+
+/**
+ * @brief Register a lock with the validator
+ *
+ * Named locks share one class per name, unnamed locks get a class of their
+ * own keyed by address. The table holds TT_LOCKDEP_MAX_CLASSES classes at
+ * once; locks registered after it fills up are not checked, and a warning is
+ * printed the first time that happens. Give per-object locks a common name
+ * with tt_mutex_init_named so they all share one class.
+ *
+ * @param lock Address identifying the lock instance
+ * @param name Static class name, NULL for an anonymous class
+ * @return Class id, -1 if the class table is full
+ */
+int tt_lockdep_register(const void *lock, const char *name);
+
+/**
+ * @brief Forget a lock instance, dropping its class if anonymous
+ * @param lock Address identifying the lock instance
+ * @param class_id Class id returned by tt_lockdep_register
+ */
+void tt_lockdep_unregister(const void *lock, int class_id);
+
+/**
+ * @brief Record an acquisition by the current thread
+ *
+ * Called before blocking on the lock, so an inverted acquisition order is
+ * reported before it can deadlock.
+ *
+ * @param lock Address identifying the lock instance
+ * @param class_id Class id returned by tt_lockdep_register
+ * @param file Source file of the acquisition, may be NULL
+ * @param line Source line of the acquisition
+ * @param check false for non-blocking acquisitions, which cannot deadlock
+ */
+void tt_lockdep_acquire(const void *lock, int class_id, const char *file,
+                        int line, bool check);
+
+/**
+ * @brief Record a release by the current thread
+ * @param lock Address identifying the lock instance
+ */
+void tt_lockdep_release(const void *lock);
+
+/**
+ * @brief Get the number of lock order violations reported so far
+ * @return Violation count
+ */
+uint32_t tt_lockdep_violations(void);
+
+/**
+ * @brief Clear the dependency graph and the violation count
+ */
+void tt_lockdep_reset(void);
+#endif /* TT_LOCKDEP */
+
+#endif // TT_LOCKDEP_H_
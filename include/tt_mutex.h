@@ -9,10 +9,52 @@
 #ifndef TT_MUTEX_H_
 #define TT_MUTEX_H_
 
+#include "tt_lockdep.h"
 #include "tt_platform.h"
 #include "tt_types.h"
 #include <stddef.h>
 
+#if defined(TT_MUTEX_STATS)
+/* Number of log2 histogram buckets, bucket i counts durations in
+ * [2^i, 2^(i+1)) ns and the last bucket collects everything above */
+#define TT_MUTEX_STATS_BUCKETS 32
+
+/* Maximum number of distinct lock names tracked */
+#ifndef TT_MUTEX_STATS_MAX_LOCKS
+#define TT_MUTEX_STATS_MAX_LOCKS 64
+#endif
+
+/**
+ * @brief Contention statistics shared by all mutexes with the same name
+ */
+typedef struct {
+  const char *name;                          /**< Name given at init*/
+  uint64_t acquisitions;                     /**< Successful acquisitions*/
+  uint64_t contended;                        /**< Acquisitions that waited*/
+  uint64_t wait_total_ns;                    /**< Total time spent waiting*/
+  uint64_t wait_max_ns;                      /**< Longest single wait*/
+  uint64_t hold_total_ns;                    /**< Total time held*/
+  uint32_t wait_hist[TT_MUTEX_STATS_BUCKETS]; /**< Wait time histogram*/
+  uint32_t hold_hist[TT_MUTEX_STATS_BUCKETS]; /**< Hold time histogram*/
+} tt_mutex_stats_t;
+#endif /* TT_MUTEX_STATS */
+
+/**
+ * @brief Mutex priority protocol
+ */
+typedef enum {
+  TT_MUTEX_PROTOCOL_NONE = 0, /**< Owner priority is not affected*/
+  TT_MUTEX_PROTOCOL_INHERIT,  /**< Owner inherits the highest waiter priority*/
+} tt_mutex_protocol_t;
+
+/**
+ * @brief Mutex attributes
+ */
+struct tt_mutex_attr_t {
+  tt_mutex_protocol_t protocol; /**< Priority protocol*/
+  const char *name;             /**< Static name for lock instrumentation*/
+};
+
 #if defined(TT_CAP_MUTEX)
 /**
  * @brief Mutex structure for thread synchronization
@@ -20,6 +62,13 @@
 struct tt_mutex_t {
   void *lock;       /**< Pointer to platform specific implementation*/
   bool initialized; /**< Initialization state*/
+#if defined(TT_MUTEX_STATS)
+  tt_mutex_stats_t *stats; /**< Statistics slot, NULL if untracked*/
+  uint64_t hold_start_ns;  /**< Time of the current acquisition*/
+#endif
+#if defined(TT_LOCKDEP)
+  int lockdep_class; /**< Lock class id, -1 if untracked*/
+#endif
 };
 
 /**
@@ -28,6 +77,31 @@ struct tt_mutex_t {
  * @return TT_SUCCESS on success, error code otherwise
  */
 tt_error_t tt_mutex_init(tt_mutex_t *mutex);
+
+/**
+ * @brief Initialize a mutex with a name used by lock instrumentation
+ * @param mutex Pointer to mutex structure
+ * @param name Static string naming the lock, mutexes sharing a name share
+ * their statistics
+ * @return TT_SUCCESS on success, error code otherwise
+ */
+tt_error_t tt_mutex_init_named(tt_mutex_t *mutex, const char *name);
+
+/**
+ * @brief Initialize mutex attributes with default values
+ * @param attr Pointer to mutex attributes structure
+ * @return TT_SUCCESS on success, error code otherwise
+ */
+tt_error_t tt_mutex_attr_init(tt_mutex_attr_t *attr);
+
+/**
+ * @brief Initialize a mutex with attributes
+ * @param mutex Pointer to mutex structure
+ * @param attr Mutex attributes (NULL for defaults)
+ * @return TT_SUCCESS on success, TT_ERROR_NOT_IMPLEMENTED if the requested
+ * protocol is not supported, error code otherwise
+ */
+tt_error_t tt_mutex_init_attr(tt_mutex_t *mutex, const tt_mutex_attr_t *attr);
 /**
  * @brief Destroy a mutex
  * @param mutex Pointer to mutex structure
@@ -56,6 +130,15 @@ tt_error_t tt_mutex_unlock(tt_mutex_t *mutex);
  */
 tt_error_t tt_mutex_trylock(tt_mutex_t *mutex);
 
+/**
+ * @brief Lock a mutex, blocking at most timeout_ms milliseconds
+ * @param mutex Pointer to mutex structure
+ * @param timeout_ms Maximum time to wait in milliseconds
+ * @return TT_SUCCESS on success, TT_ERROR_TIMEOUT if the mutex was not
+ * acquired in time, error code otherwise
+ */
+tt_error_t tt_mutex_timedlock(tt_mutex_t *mutex, uint32_t timeout_ms);
+
 /**
  * @brief Check if mutex is locked
  * @param mutex Pointer to mutex structure
@@ -69,21 +152,108 @@ bool tt_mutex_is_locked(tt_mutex_t *mutex);
  * @brief Mutex structure for thread synchronization
  */
 struct tt_mutex_t {
-  volatile int *lock; /**< Atomic lock value*/
-  bool initialized;   /**< Initialization state*/
+  volatile uint8_t lock; /**< TT_MUTEX_UNLOCKED or TT_MUTEX_LOCKED*/
+  bool initialized;      /**< Initialization state*/
+#if defined(TT_MUTEX_STATS)
+  tt_mutex_stats_t *stats; /**< Statistics slot, NULL if untracked*/
+  uint64_t hold_start_ns;  /**< Time of the current acquisition*/
+#endif
+#if defined(TT_LOCKDEP)
+  int lockdep_class; /**< Lock class id, -1 if untracked*/
+#endif
 };
 
 /* Initial lock value */
 #define TT_MUTEX_UNLOCKED 0
 #define TT_MUTEX_LOCKED 1
 
+/* Upper bound on CPU pause hints between two acquisition attempts */
+#define TT_MUTEX_SPIN_BACKOFF_MAX 64
+
+/**
+ * @brief Hook called by waiters once their backoff is exhausted
+ *
+ * Lets a cooperative scheduler run the lock owner instead of burning the
+ * waiter's time slice.
+ */
+typedef void (*tt_mutex_yield_hook_t)(void);
+
+/**
+ * @brief Install the hook called by contended lock waiters
+ * @param hook Yield function, or NULL to keep spinning
+ */
+void tt_mutex_set_yield_hook(tt_mutex_yield_hook_t hook);
+
 tt_error_t tt_mutex_init(tt_mutex_t *mutex);
+tt_error_t tt_mutex_init_named(tt_mutex_t *mutex, const char *name);
+tt_error_t tt_mutex_attr_init(tt_mutex_attr_t *attr);
+tt_error_t tt_mutex_init_attr(tt_mutex_t *mutex, const tt_mutex_attr_t *attr);
 tt_error_t tt_mutex_destroy(tt_mutex_t *mutex);
 tt_error_t tt_mutex_lock(tt_mutex_t *mutex);
 tt_error_t tt_mutex_unlock(tt_mutex_t *mutex);
 tt_error_t tt_mutex_trylock(tt_mutex_t *mutex);
+tt_error_t tt_mutex_timedlock(tt_mutex_t *mutex, uint32_t timeout_ms);
 bool tt_mutex_is_locked(tt_mutex_t *mutex);
 
 #endif /* TT_CAP_MUTEX */
 
+#if defined(TT_LOCKDEP)
+/**
+ * @brief Lock a mutex, recording the call site for the lock validator
+ * @param mutex Pointer to mutex structure
+ * @param file Source file of the call
+ * @param line Source line of the call
+ * @return TT_SUCCESS on success, error code otherwise
+ */
+tt_error_t tt_mutex_lock_at(tt_mutex_t *mutex, const char *file, int line);
+
+/**
+ * @brief Timed lock, recording the call site for the lock validator
+ * @param mutex Pointer to mutex structure
+ * @param timeout_ms Maximum time to wait in milliseconds
+ * @param file Source file of the call
+ * @param line Source line of the call
+ * @return TT_SUCCESS on success, TT_ERROR_TIMEOUT on timeout, error code
+ * otherwise
+ */
+tt_error_t tt_mutex_timedlock_at(tt_mutex_t *mutex, uint32_t timeout_ms,
+                                 const char *file, int line);
+
+/* Capture the acquisition site of every lock in debug builds */
+#define tt_mutex_lock(mutex) tt_mutex_lock_at((mutex), __FILE__, __LINE__)
+#define tt_mutex_timedlock(mutex, timeout_ms)                                  \
+  tt_mutex_timedlock_at((mutex), (timeout_ms), __FILE__, __LINE__)
+#endif /* TT_LOCKDEP */
+
+#if defined(TT_MUTEX_STATS)
+/**
+ * @brief Copy lock statistics, most contended first
+ * @param stats Array receiving the statistics
+ * @param max Capacity of the array
+ * @return Number of entries written
+ */
+size_t tt_mutex_stats_snapshot(tt_mutex_stats_t *stats, size_t max);
+
+/**
+ * @brief Print the most contended locks to stdout
+ * @param top_n Maximum number of locks to report
+ */
+void tt_mutex_stats_dump(size_t top_n);
+
+/**
+ * @brief Reset all counters and histograms, keeping registered names
+ *
+ * Safe while the mutexes are in use, but not a single atomic step: a lock
+ * taken during the reset may be counted in some fields and not others.
+ */
+void tt_mutex_stats_reset(void);
+
+#else /* Instrumentation compiled out */
+
+static inline void tt_mutex_stats_dump(size_t top_n __attribute__((unused))) {
+}
+static inline void tt_mutex_stats_reset(void) {}
+
+#endif /* TT_MUTEX_STATS */
+
 #endif // TT_MUTEX_H_
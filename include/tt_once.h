@@ -0,0 +1,85 @@
+/**
+ * @file tt_once.h
+ * @author Mihai Gurei <mihai.gurei@protonmail.com>
+ * @date 2025-01-14
+ * @brief One-time initialization
+ * @copyright Copyright (c) 2025 AnAlphaBeta. All rights reserved.
+ */
+
+#ifndef TT_ONCE_H_
+#define TT_ONCE_H_
+
+#include "tt_types.h"
+
+/* Once states */
+#define TT_ONCE_UNINIT 0  /**< Function not run yet*/
+#define TT_ONCE_RUNNING 1 /**< Function running, nobody waiting*/
+#define TT_ONCE_WAITING 2 /**< Function running, callers parked*/
+#define TT_ONCE_DONE 3    /**< Function completed successfully*/
+
+/**
+ * @brief One-time initialization flag
+ *
+ * Once the function has completed, tt_call_once costs a single acquire
+ * load. Callers arriving while it runs park on the flag instead of
+ * spinning.
+ */
+typedef struct {
+  volatile uint32_t state; /**< One of the TT_ONCE_* states*/
+} tt_once_t;
+
+/* Static initializer */
+#define TT_ONCE_INIT {TT_ONCE_UNINIT}
+
+/**
+ * @brief Initialization function run by tt_call_once
+ * @return TT_SUCCESS on success, error code otherwise
+ */
+typedef tt_error_t (*tt_once_func_t)(void);
+
+/**
+ * @brief Slow path of tt_call_once, do not call directly
+ * @param once Pointer to once flag
+ * @param func Initialization function
+ * @return TT_SUCCESS once func has completed, its error code otherwise
+ */
+tt_error_t tt_call_once_slow(tt_once_t *once, tt_once_func_t func);
+
+/**
+ * @brief Check whether the once function has completed
+ * @param once Pointer to once flag
+ * @return true if func completed successfully, false otherwise
+ */
+static inline bool tt_once_is_done(const tt_once_t *once) {
+  return __atomic_load_n(&once->state, __ATOMIC_ACQUIRE) == TT_ONCE_DONE;
+}
+
+/**
+ * @brief Run func exactly once
+ *
+ * Concurrent callers wait for the running call to finish. If func fails,
+ * the flag is left unset and the next caller runs it again.
+ *
+ * @param once Pointer to once flag
+ * @param func Initialization function
+ * @return TT_SUCCESS once func has completed, its error code otherwise
+ */
+static inline tt_error_t tt_call_once(tt_once_t *once, tt_once_func_t func) {
+  if (tt_once_is_done(once)) {
+    return TT_SUCCESS;
+  }
+  return tt_call_once_slow(once, func);
+}
+
+/**
+ * @brief Rearm a once flag so that the next tt_call_once runs again
+ *
+ * For module deinit paths. Must not race with tt_call_once on the same flag.
+ *
+ * @param once Pointer to once flag
+ */
+static inline void tt_once_reset(tt_once_t *once) {
+  __atomic_store_n(&once->state, TT_ONCE_UNINIT, __ATOMIC_RELEASE);
+}
+
+#endif // TT_ONCE_H_
@@ -0,0 +1,101 @@
+/**
+ * @file tt_parallel.h
+ * @author Mihai Gurei <mihai.gurei@protonmail.com>
+ * @date 2025-02-03
+ * @brief Parallel loops and reductions over index ranges
+ * @copyright Copyright (c) 2025 AnAlphaBeta. All rights reserved.
+ */
+
+#ifndef TT_PARALLEL_H_
+#define TT_PARALLEL_H_
+
+#include "tt_types.h"
+
+/* Automatic grain size aims for this many chunks per worker */
+#ifndef TT_PARALLEL_CHUNKS_PER_WORKER
+#define TT_PARALLEL_CHUNKS_PER_WORKER 8
+#endif
+
+/*
+ * Chunk boundaries fall on multiples of this many iterations whenever the
+ * range allows it: 16 four-byte samples fill one 64-byte cache line, so
+ * neighbouring chunks do not write the same line of an aligned output array.
+ */
+#ifndef TT_PARALLEL_SPLIT_ALIGN
+#define TT_PARALLEL_SPLIT_ALIGN 16
+#endif
+
+/* Largest accumulator tt_parallel_reduce supports, one cache line */
+#define TT_PARALLEL_REDUCE_MAX_SIZE 64
+
+/**
+ * @brief Loop body run over a sub-range [begin, end)
+ */
+typedef void (*tt_parallel_for_func_t)(size_t begin, size_t end, void *ctx);
+
+/**
+ * @brief Accumulate a sub-range [begin, end) into acc
+ */
+typedef void (*tt_parallel_reduce_func_t)(size_t begin, size_t end, void *acc,
+                                          void *ctx);
+
+/**
+ * @brief Combine the accumulator of the following sub-range into acc
+ */
+typedef void (*tt_parallel_join_func_t)(void *acc, const void *other,
+                                        void *ctx);
+
+/**
+ * @brief Run a loop body over [begin, end) on the shared worker set
+ *
+ * The range is split recursively in halves until pieces are no larger than
+ * grain, and the halves are spread by the work-stealing scheduler, so uneven
+ * iterations balance out. The workers are started on first use, one per core
+ * reported by tt_platform_get_info. Without TT_CAP_THREADS the body runs
+ * once over the whole range on the calling thread.
+ *
+ * @param begin First index
+ * @param end One past the last index
+ * @param grain Largest piece handed to one body call, 0 to size it
+ * automatically
+ * @param func Loop body
+ * @param ctx Body context
+ * @return TT_SUCCESS on success, error code otherwise
+ */
+tt_error_t tt_parallel_for(size_t begin, size_t end, size_t grain,
+                           tt_parallel_for_func_t func, void *ctx);
+
+/**
+ * @brief Reduce [begin, end) into result on the shared worker set
+ *
+ * Splits like tt_parallel_for. Every split-off piece starts from a copy of
+ * identity in its own cache line, and pieces are joined left to right, so
+ * join only needs to be associative.
+ *
+ * @param begin First index
+ * @param end One past the last index
+ * @param grain Largest piece handed to one reduce call, 0 to size it
+ * automatically
+ * @param result Accumulator, must hold the identity value on entry
+ * @param size Accumulator size in bytes, at most TT_PARALLEL_REDUCE_MAX_SIZE
+ * @param identity Identity value of the reduction
+ * @param reduce Range accumulation function
+ * @param join Accumulator join function
+ * @param ctx Function context
+ * @return TT_SUCCESS on success, error code otherwise
+ */
+tt_error_t tt_parallel_reduce(size_t begin, size_t end, size_t grain,
+                              void *result, size_t size, const void *identity,
+                              tt_parallel_reduce_func_t reduce,
+                              tt_parallel_join_func_t join, void *ctx);
+
+/**
+ * @brief Stop the shared worker set
+ *
+ * No parallel call may be running. The next one starts the workers again.
+ *
+ * @return TT_SUCCESS on success, error code otherwise
+ */
+tt_error_t tt_parallel_cleanup(void);
+
+#endif // TT_PARALLEL_H_
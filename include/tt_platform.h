@@ -14,8 +14,9 @@
 
 // Forward declarations for thread-related types
 typedef struct tt_mutex_t tt_mutex_t;
+typedef struct tt_mutex_attr_t tt_mutex_attr_t;
 typedef struct tt_thread_t tt_thread_t;
-typedef struct tt_thread_table_entry_t tt_thread_table_entry_t;
+typedef struct tt_thread_table_segment_t tt_thread_table_segment_t;
 typedef struct tt_thread_attr_t tt_thread_attr_t;
 typedef void *(*tt_thread_func_t)(void *);
 
@@ -120,6 +121,17 @@ tt_error_t tt_platform_cleanup(void);
  */
 tt_error_t tt_platform_get_info(tt_platform_info_t *info);
 
+/**
+ * @brief Get monotonic time
+ * @return Nanoseconds elapsed since an arbitrary, fixed point in the past
+ */
+uint64_t tt_platform_time_monotonic_ns(void);
+
+/* Deadline value that never expires */
+#define TT_PLATFORM_WAIT_FOREVER UINT64_MAX
+/* Wake count that releases every waiter */
+#define TT_PLATFORM_WAKE_ALL UINT32_MAX
+
 // Platform-specific thread operations (when TT_CAP_THREADS)
 #if defined(TT_CAP_THREADS)
 /**
@@ -153,6 +165,15 @@ tt_error_t tt_platform_thread_join(tt_thread_t *thread, void **retval);
 tt_error_t tt_platform_thread_set_priority(tt_thread_t *thread,
                                            tt_thread_priority_t priority);
 
+/**
+ * @brief Set the CPU affinity of a platform-specific thread
+ * @param thread Thread handle
+ * @param affinity CPUs to run on, bit n = CPU n, 0 for every CPU
+ * @return TT_SUCCESS on success, error code otherwise
+ */
+tt_error_t tt_platform_thread_set_affinity(tt_thread_t *thread,
+                                           uint64_t affinity);
+
 /**
  * @brief Suspend thread execution
  * @param thread Thread handle
@@ -167,6 +188,25 @@ tt_error_t tt_platform_thread_suspend(tt_thread_t *thread);
  */
 tt_error_t tt_platform_thread_resume(tt_thread_t *thread);
 
+/**
+ * @brief Keep up to capacity finished OS threads for reuse
+ * @param capacity Maximum number of idle threads kept
+ * @return TT_SUCCESS on success, error code otherwise
+ */
+tt_error_t tt_platform_thread_cache_init(size_t capacity);
+
+/**
+ * @brief Stop caching OS threads and let the idle ones exit
+ * @return TT_SUCCESS on success, error code otherwise
+ */
+tt_error_t tt_platform_thread_cache_cleanup(void);
+
+/**
+ * @brief Park the calling thread while a suspension is pending
+ * @return TT_SUCCESS on success, error code otherwise
+ */
+tt_error_t tt_platform_thread_checkpoint(void);
+
 /**
  * @brief Sleep current thread for specified milliseconds
  * @param ms Time to sleep in milliseconds
@@ -196,6 +236,51 @@ tt_error_t tt_platform_thread_destroy(tt_thread_t *thread);
  * @return TT_SUCCESS on success, error code otherwise
  */
 tt_error_t tt_platform_thread_exit(void *retval);
+
+/**
+ * @brief Map a stack with an inaccessible guard page below it
+ *
+ * An overflow faults on the guard page instead of silently corrupting the
+ * memory underneath.
+ *
+ * @param size Usable size in bytes, rounded up to whole pages on return
+ * @param stack Pointer to store the lowest usable address
+ * @return TT_SUCCESS on success, error code otherwise
+ */
+tt_error_t tt_platform_stack_alloc(size_t *size, void **stack);
+
+/**
+ * @brief Unmap a stack from tt_platform_stack_alloc
+ * @param stack Lowest usable address
+ * @param size Usable size returned by tt_platform_stack_alloc
+ * @return TT_SUCCESS on success, error code otherwise
+ */
+tt_error_t tt_platform_stack_free(void *stack, size_t size);
+
+/**
+ * @brief Block current thread while a 32-bit word holds an expected value
+ *
+ * The check and the sleep are atomic with respect to
+ * tt_platform_futex_wake. The call may return spuriously, so callers must
+ * re-check their condition in a loop.
+ *
+ * @param addr Address of the word to wait on
+ * @param expected Value the word must hold for the thread to sleep
+ * @param deadline_ns Absolute tt_platform_time_monotonic_ns deadline, or
+ * TT_PLATFORM_WAIT_FOREVER
+ * @return TT_SUCCESS when woken or the value changed, TT_ERROR_TIMEOUT when
+ * the deadline passed
+ */
+tt_error_t tt_platform_futex_wait(volatile uint32_t *addr, uint32_t expected,
+                                  uint64_t deadline_ns);
+
+/**
+ * @brief Wake threads blocked in tt_platform_futex_wait on a word
+ * @param addr Address of the word
+ * @param count Maximum number of threads to wake, or TT_PLATFORM_WAKE_ALL
+ * @return TT_SUCCESS on success, error code otherwise
+ */
+tt_error_t tt_platform_futex_wake(volatile uint32_t *addr, uint32_t count);
 #endif
 
 // Platform-specific synchronization primitives (when TT_CAP_MUTEX is supported)
@@ -203,12 +288,11 @@ tt_error_t tt_platform_thread_exit(void *retval);
 /**
  * @brief Initialization of platform-specifi mutex
  * @param mutex Pointer to mutex
- * @param attr Pointer to mutex attributes
+ * @param attr Pointer to mutex attributes (NULL for defaults)
  * @return TT_SUCCESS on success, error code otherwise
  */
-/* tt_error_t tt_platform_mutex_init(tt_mutex_t *mutex, */
-/*                                   const tt_mutex_attr_t *attr); */
-tt_error_t tt_platform_mutex_init(tt_mutex_t *mutex);
+tt_error_t tt_platform_mutex_init(tt_mutex_t *mutex,
+                                  const tt_mutex_attr_t *attr);
 
 /**
  * @brief Destroy platform-specific mutesx
@@ -238,6 +322,15 @@ tt_error_t tt_platform_mutex_unlock(tt_mutex_t *mutex);
  */
 tt_error_t tt_platform_mutex_trylock(tt_mutex_t *mutex);
 
+/**
+ * @brief Lock platform-specific mutex, giving up after a timeout
+ * @param mutex Pointer to mutex
+ * @param timeout_ms Maximum time to wait in milliseconds
+ * @return TT_SUCCESS on success, TT_ERROR_TIMEOUT if the mutex was not
+ * acquired in time, error code otherwise
+ */
+tt_error_t tt_platform_mutex_timedlock(tt_mutex_t *mutex, uint32_t timeout_ms);
+
 /**
  * @brief Check if mutex is locked
  * @param mutex Pointer to mutex structure
@@ -0,0 +1,79 @@
+/**
+ * @file tt_sem.h
+ * @author Mihai Gurei <mihai.gurei@protonmail.com>
+ * @date 2025-01-12
+ * @brief Counting semaphore
+ * @copyright Copyright (c) 2025 AnAlphaBeta. All rights reserved.
+ */
+
+#ifndef TT_SEM_H_
+#define TT_SEM_H_
+
+#include "tt_platform.h"
+#include "tt_types.h"
+
+/**
+ * @brief Counting semaphore
+ *
+ * Post and wait are a single atomic operation while units are available.
+ * Waiters only park in the kernel (tt_platform_futex_wait) when the count
+ * is zero.
+ */
+typedef struct {
+  volatile uint32_t count;   /**< Available units*/
+  volatile uint32_t waiters; /**< Threads parked on count*/
+  bool initialized;          /**< Initialization state*/
+} tt_sem_t;
+
+/**
+ * @brief Initialize a semaphore
+ * @param sem Pointer to semaphore
+ * @param initial_count Number of units initially available
+ * @return TT_SUCCESS on success, error code otherwise
+ */
+tt_error_t tt_sem_init(tt_sem_t *sem, uint32_t initial_count);
+
+/**
+ * @brief Destroy a semaphore
+ * @param sem Pointer to semaphore
+ * @return TT_SUCCESS on success, TT_ERROR_BUSY if threads are still waiting
+ */
+tt_error_t tt_sem_destroy(tt_sem_t *sem);
+
+/**
+ * @brief Release one unit, waking a waiter if any
+ * @param sem Pointer to semaphore
+ * @return TT_SUCCESS on success, error code otherwise
+ */
+tt_error_t tt_sem_post(tt_sem_t *sem);
+
+/**
+ * @brief Acquire one unit, blocking while none is available
+ * @param sem Pointer to semaphore
+ * @return TT_SUCCESS on success, error code otherwise
+ */
+tt_error_t tt_sem_wait(tt_sem_t *sem);
+
+/**
+ * @brief Try to acquire one unit without blocking
+ * @param sem Pointer to semaphore
+ * @return TT_SUCCESS on success, TT_ERROR_BUSY if no unit is available
+ */
+tt_error_t tt_sem_trywait(tt_sem_t *sem);
+
+/**
+ * @brief Acquire one unit, blocking at most timeout_ms milliseconds
+ * @param sem Pointer to semaphore
+ * @param timeout_ms Maximum time to wait in milliseconds
+ * @return TT_SUCCESS on success, TT_ERROR_TIMEOUT if no unit became available
+ */
+tt_error_t tt_sem_timedwait(tt_sem_t *sem, uint32_t timeout_ms);
+
+/**
+ * @brief Get the number of available units
+ * @param sem Pointer to semaphore
+ * @return Current count, 0 if sem is NULL
+ */
+uint32_t tt_sem_get_value(const tt_sem_t *sem);
+
+#endif // TT_SEM_H_
@@ -0,0 +1,105 @@
+/**
+ * @file tt_task.h
+ * @author Mihai Gurei <mihai.gurei@protonmail.com>
+ * @date 2025-01-27
+ * @brief Work-stealing task scheduler
+ * @copyright Copyright (c) 2025 AnAlphaBeta. All rights reserved.
+ */
+
+#ifndef TT_TASK_H_
+#define TT_TASK_H_
+
+#include "tt_platform.h"
+#include "tt_types.h"
+
+/* Initial per-worker deque capacity, the deque doubles when it fills up */
+#ifndef TT_TASK_DEQUE_SIZE
+#define TT_TASK_DEQUE_SIZE 64
+#endif
+
+/* Failed steal rounds before an idle worker or a sync parks */
+#ifndef TT_TASK_SPIN_COUNT
+#define TT_TASK_SPIN_COUNT 64
+#endif
+
+/**
+ * @brief Scheduler handle
+ */
+typedef struct tt_scheduler_t tt_scheduler_t;
+
+/**
+ * @brief Task function prototype
+ */
+typedef void (*tt_task_func_t)(void *arg);
+
+/**
+ * @brief Set of spawned tasks that can be waited for together
+ *
+ * Usually lives on the stack of the task that spawns the children.
+ */
+typedef struct {
+  tt_scheduler_t *scheduler; /**< Scheduler the tasks run on*/
+  volatile uint32_t pending; /**< Unfinished tasks plus waiter flag*/
+} tt_task_group_t;
+
+/**
+ * @brief Create a work-stealing scheduler
+ *
+ * Every worker owns a Chase-Lev deque. Tasks spawned from a worker are pushed
+ * and popped at the bottom of its own deque; idle workers steal from the top
+ * of random victims and park when nothing is left. Tasks spawned from other
+ * threads go through a shared injection queue.
+ *
+ * @param scheduler Pointer to store the scheduler handle
+ * @param num_workers Number of worker threads
+ * @param attr Worker thread attributes, or NULL for defaults
+ * @return TT_SUCCESS on success, TT_ERROR_NOT_IMPLEMENTED without
+ * TT_CAP_THREADS, error code otherwise
+ */
+tt_error_t tt_scheduler_create(tt_scheduler_t **scheduler, size_t num_workers,
+                               const tt_thread_attr_t *attr);
+
+/**
+ * @brief Stop the workers and free the scheduler
+ *
+ * Every task group must have been synced before.
+ *
+ * @param scheduler Scheduler handle
+ * @return TT_SUCCESS on success, error code otherwise
+ */
+tt_error_t tt_scheduler_destroy(tt_scheduler_t *scheduler);
+
+/**
+ * @brief Initialize a task group
+ * @param group Pointer to task group
+ * @param scheduler Scheduler the group's tasks run on
+ * @return TT_SUCCESS on success, error code otherwise
+ */
+tt_error_t tt_task_group_init(tt_task_group_t *group, tt_scheduler_t *scheduler);
+
+/**
+ * @brief Spawn a task into a group
+ *
+ * From a worker of the group's scheduler this takes no lock: the task goes to
+ * the bottom of the worker's own deque.
+ *
+ * @param group Task group
+ * @param func Task function
+ * @param arg Task argument
+ * @return TT_SUCCESS on success, error code otherwise
+ */
+tt_error_t tt_task_spawn(tt_task_group_t *group, tt_task_func_t func,
+                         void *arg);
+
+/**
+ * @brief Wait for every task spawned into a group
+ *
+ * A worker keeps running its own and stolen tasks while it waits; other
+ * threads park until the group is done.
+ *
+ * @param group Task group
+ * @return TT_SUCCESS on success, error code otherwise
+ */
+tt_error_t tt_task_sync(tt_task_group_t *group);
+
+#endif // TT_TASK_H_
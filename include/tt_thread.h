@@ -23,6 +23,9 @@ struct tt_thread_attr_t {
   tt_thread_priority_t priority;
   size_t stack_size;
   const char *name;
+  uint64_t affinity;  /**< CPUs to run on, bit n = CPU n, 0 for any*/
+  uint64_t numa_mask; /**< Preferred memory nodes, bit n = node n, 0 for any;
+                         only the lowest counts on kernels before 5.15*/
 };
 
 /**
@@ -62,6 +65,33 @@ tt_error_t tt_thread_attr_init(tt_thread_attr_t *attr);
 tt_error_t tt_thread_create(tt_thread_t **thread, const tt_thread_attr_t *attr,
                             tt_thread_func_t func, void *arg);
 
+/**
+ * @brief Enable reuse of OS threads by tt_thread_create
+ *
+ * Opt-in. While enabled, a thread that finishes its function does not exit:
+ * it parks, with its stack still mapped, until tt_thread_create hands it the
+ * next function. At most @p capacity threads are kept idle; the others exit
+ * as before. A reused thread gets the name, priority, affinity and NUMA
+ * preference of its new attributes, and tt_thread_self and the last error
+ * start out fresh. Other thread-local data the function left behind is not
+ * reset, so functions run this way must not rely on zeroed _Thread_local
+ * variables. Calling again changes the capacity.
+ *
+ * @param capacity Maximum number of idle threads kept, at least 1
+ * @return TT_SUCCESS on success, TT_ERROR_NOT_IMPLEMENTED where the platform
+ * cannot reuse threads
+ */
+tt_error_t tt_thread_cache_init(size_t capacity);
+
+/**
+ * @brief Disable thread reuse and let the idle threads exit
+ *
+ * Threads still running finish normally and exit afterwards.
+ *
+ * @return TT_SUCCESS on success, error code otherwise
+ */
+tt_error_t tt_thread_cache_cleanup(void);
+
 /**
  * @brief Join with a terminated thread
  * @param thread Thread handle
@@ -81,14 +111,37 @@ tt_error_t tt_thread_get_state(const tt_thread_t *thread,
 
 /**
  * @brief Set thread priority
+ *
+ * On Linux HIGH and REALTIME select SCHED_RR and SCHED_FIFO. Without the
+ * privilege for real-time scheduling TT_ERROR_THREAD_PRIORITY is returned and
+ * the thread keeps its previous policy. The same mapping applies to
+ * tt_thread_attr_t.priority at creation.
+ *
  * @param thread Thread handle
  * @param priority New priority level
  * @return TT_SUCCESS on success, error code otherwise
  */
 tt_error_t tt_thread_set_priority(tt_thread_t *thread,
                                   tt_thread_priority_t priority);
+
+/**
+ * @brief Pin a running thread to a set of CPUs
+ * @param thread Thread handle
+ * @param affinity CPUs to run on, bit n = CPU n, 0 to allow every CPU
+ * @return TT_SUCCESS on success, TT_ERROR_INVALID_PARAM if the mask holds no
+ * usable CPU, TT_ERROR_NOT_IMPLEMENTED where affinity is not supported
+ */
+tt_error_t tt_thread_set_affinity(tt_thread_t *thread, uint64_t affinity);
+
 /**
  * @brief Suspend thread execution
+ *
+ * Suspension is cooperative on Linux: the request is recorded and the thread
+ * parks at its next safe point, i.e. tt_thread_checkpoint, tt_thread_sleep,
+ * or before blocking in a semaphore or barrier wait. Its state reads
+ * TT_THREAD_STATE_SUSPENDED once it is parked, and it uses no CPU until
+ * resumed. A thread suspending itself parks straight away.
+ *
  * @param thread Thread handle
  * @return TT_SUCCESS on success, error code otherwise
  */
@@ -96,11 +149,25 @@ tt_error_t tt_thread_suspend(tt_thread_t *thread);
 
 /**
  * @brief Resume thread execution
+ *
+ * Cancels a pending suspension or wakes a parked thread.
+ *
  * @param thread Thread handle
  * @return TT_SUCCESS on success, error code otherwisw
  */
 tt_error_t tt_thread_resume(tt_thread_t *thread);
 
+/**
+ * @brief Safe point for tt_thread_suspend
+ *
+ * Returns at once unless the calling thread has a suspension pending, in
+ * which case it parks until tt_thread_resume. Long running loops should call
+ * this regularly, with no locks held.
+ *
+ * @return TT_SUCCESS on success, error code otherwise
+ */
+tt_error_t tt_thread_checkpoint(void);
+
 /**
  * @brief Sleep current thread for specified milliseconds
  * @param ms Time to sleep in milliseconds
@@ -110,7 +177,11 @@ tt_error_t tt_thread_sleep(uint32_t ms);
 
 /**
  * @brief Get current thread handle
- * @return Current thread handle or NULL on error
+ *
+ * Constant time and lock free: the handle is read from thread-local storage.
+ *
+ * @return Current thread handle, or NULL if the calling thread was not
+ *         created with tt_thread_create
  */
 tt_thread_t *tt_thread_self(void);
 
@@ -154,6 +225,13 @@ tt_thread_create(tt_thread_t **thread __attribute__((unused)),
                  void *arg __attribute__((unused))) {
   return TT_ERROR_NOT_IMPLEMENTED;
 }
+static inline tt_error_t tt_thread_cache_init(size_t capacity
+                                              __attribute__((unused))) {
+  return TT_ERROR_NOT_IMPLEMENTED;
+}
+static inline tt_error_t tt_thread_cache_cleanup(void) {
+  return TT_ERROR_NOT_IMPLEMENTED;
+}
 static inline tt_error_t tt_thread_join(tt_thread_t *thread
                                         __attribute__((unused)),
                                         void **retval __attribute__((unused))) {
@@ -171,6 +249,12 @@ static inline tt_error_t tt_thread_set_priority(tt_thread_t *thread
                                                 __attribute__((unused))) {
   return TT_ERROR_NOT_IMPLEMENTED;
 }
+static inline tt_error_t tt_thread_set_affinity(tt_thread_t *thread
+                                                __attribute__((unused)),
+                                                uint64_t affinity
+                                                __attribute__((unused))) {
+  return TT_ERROR_NOT_IMPLEMENTED;
+}
 static inline tt_error_t tt_thread_suspend(tt_thread_t *thread
                                            __attribute__((unused))) {
   return TT_ERROR_NOT_IMPLEMENTED;
@@ -179,6 +263,9 @@ static inline tt_error_t tt_thread_resume(tt_thread_t *thread
                                           __attribute__((unused))) {
   return TT_ERROR_NOT_IMPLEMENTED;
 }
+static inline tt_error_t tt_thread_checkpoint(void) {
+  return TT_SUCCESS; // Nothing can be suspended
+}
 static inline tt_error_t tt_thread_sleep(uint32_t ms __attribute__((unused))) {
   return TT_ERROR_NOT_IMPLEMENTED;
 }
@@ -29,11 +29,28 @@ typedef void *tt_platform_thread_handle_t;
 
 #endif
 
-// Maximum number of threads the can be tracked
+// Maximum number of threads the can be tracked by fixed-size platform tables
 #ifndef TT_MAX_THREADS
 #define TT_MAX_THREADS 32
 #endif
 
+// Thread table slots per segment, one bit each in the segment bitmap
+#define TT_THREAD_TABLE_SEGMENT_SLOTS 64
+
+// Upper bound on thread table segments, allocated on demand
+#ifndef TT_THREAD_TABLE_MAX_SEGMENTS
+#define TT_THREAD_TABLE_MAX_SEGMENTS 64
+#endif
+
+#define TT_THREAD_TABLE_CAPACITY                                               \
+  (TT_THREAD_TABLE_SEGMENT_SLOTS * TT_THREAD_TABLE_MAX_SEGMENTS)
+
+// Upper bound on thread object slab segments, 64 objects each. Objects
+// beyond that come from malloc
+#ifndef TT_THREAD_SLAB_MAX_SEGMENTS
+#define TT_THREAD_SLAB_MAX_SEGMENTS 16
+#endif
+
 /**
  * @brief Thread structure
  */
@@ -47,21 +64,46 @@ struct tt_thread_t {
   size_t stack_size;                  /**< Stack size (if applicable)*/
   void *retval;                       /**< Return value*/
   bool is_active;                     /**< Slot is in use*/
+  uint64_t numa_mask;                 /**< Preferred memory nodes*/
+  uint32_t table_slot;                /**< Index in the thread table*/
+  volatile uint32_t suspend_request;  /**< Non-zero parks at a checkpoint*/
+  bool cached;                        /**< Runs on a reusable OS thread*/
+  volatile uint32_t done;             /**< Completion word when cached*/
+  uint32_t slab_slot;                 /**< Index in the object slab*/
 };
 
 /**
- * @brief Thread table entry
+ * @brief Thread table segment
+ *
+ * A set bit in @c used owns the matching entry of @c threads. Bits are
+ * claimed and released with atomic operations, so the table needs no lock.
  */
-struct tt_thread_table_entry_t {
-  tt_thread_t *thread;
-  bool in_use;
+struct tt_thread_table_segment_t {
+  uint64_t used;                                        /**< Slot bitmap*/
+  tt_thread_t *threads[TT_THREAD_TABLE_SEGMENT_SLOTS]; /**< Slot entries*/
 };
 
 /**
- * @brief Global thread table
+ * @brief Global thread table, segments are published once and never moved
  */
-extern tt_thread_table_entry_t g_thread_table[TT_MAX_THREADS];
-extern tt_mutex_t g_thread_table_mutex;
+extern tt_thread_table_segment_t
+    *g_thread_table[TT_THREAD_TABLE_MAX_SEGMENTS];
+
+/**
+ * @brief Allocate a zeroed thread object
+ *
+ * Objects come from a lock-free slab that keeps freed objects for the next
+ * thread, so creating threads in bursts does not go through malloc.
+ *
+ * @return Thread object, or NULL when out of memory
+ */
+tt_thread_t *tt_thread_alloc(void);
+
+/**
+ * @brief Give a thread object from tt_thread_alloc back
+ * @param thread Thread object, may be NULL
+ */
+void tt_thread_free(tt_thread_t *thread);
 
 /**
  * @brief Initialize the thread table
@@ -89,6 +131,19 @@ tt_error_t tt_thread_table_register(tt_thread_t *thread);
  */
 tt_error_t tt_thread_table_unregister(tt_thread_t *thread);
 
+/**
+ * @brief Copy the currently registered threads
+ *
+ * Lock free: registration and unregistration may proceed concurrently, so the
+ * result is a point-in-time view. The pointers stay valid only as long as the
+ * caller keeps the threads from being destroyed.
+ *
+ * @param threads Output array
+ * @param max_threads Capacity of @p threads
+ * @return Number of threads written
+ */
+size_t tt_thread_table_snapshot(tt_thread_t **threads, size_t max_threads);
+
 /**
  * @brief Find thread table by using handle
  * @param handle Platform specific thread handle
@@ -0,0 +1,82 @@
+/**
+ * @file tt_threadpool.h
+ * @author Mihai Gurei <mihai.gurei@protonmail.com>
+ * @date 2025-01-24
+ * @brief Fixed-size thread pool with a shared task queue
+ * @copyright Copyright (c) 2025 AnAlphaBeta. All rights reserved.
+ */
+
+#ifndef TT_THREADPOOL_H_
+#define TT_THREADPOOL_H_
+
+#include "tt_platform.h"
+#include "tt_types.h"
+
+/* Initial task queue capacity, the queue doubles when it fills up */
+#ifndef TT_THREADPOOL_QUEUE_SIZE
+#define TT_THREADPOOL_QUEUE_SIZE 64
+#endif
+
+/**
+ * @brief Thread pool handle
+ */
+typedef struct tt_threadpool_t tt_threadpool_t;
+
+/**
+ * @brief Task function prototype
+ */
+typedef void (*tt_threadpool_task_t)(void *arg);
+
+/**
+ * @brief Create a thread pool
+ *
+ * Workers are started immediately and park on a semaphore while the queue is
+ * empty.
+ *
+ * @param pool Pointer to store the pool handle
+ * @param num_threads Number of worker threads
+ * @param attr Worker thread attributes, or NULL for defaults
+ * @return TT_SUCCESS on success, TT_ERROR_NOT_IMPLEMENTED without
+ * TT_CAP_THREADS, error code otherwise
+ */
+tt_error_t tt_threadpool_create(tt_threadpool_t **pool, size_t num_threads,
+                                const tt_thread_attr_t *attr);
+
+/**
+ * @brief Queue a task for execution by one of the workers
+ * @param pool Thread pool
+ * @param func Task function
+ * @param arg Task argument
+ * @return TT_SUCCESS on success, error code otherwise
+ */
+tt_error_t tt_threadpool_submit(tt_threadpool_t *pool, tt_threadpool_task_t func,
+                                void *arg);
+
+/**
+ * @brief Block until every submitted task has finished
+ *
+ * Must not be called from a task running on the same pool.
+ *
+ * @param pool Thread pool
+ * @return TT_SUCCESS on success, error code otherwise
+ */
+tt_error_t tt_threadpool_wait_idle(tt_threadpool_t *pool);
+
+/**
+ * @brief Get the number of worker threads
+ * @param pool Thread pool
+ * @return Number of workers, 0 if pool is NULL
+ */
+size_t tt_threadpool_size(const tt_threadpool_t *pool);
+
+/**
+ * @brief Run the queued tasks, stop the workers and free the pool
+ *
+ * No task may be submitted once destruction has started.
+ *
+ * @param pool Thread pool
+ * @return TT_SUCCESS on success, error code otherwise
+ */
+tt_error_t tt_threadpool_destroy(tt_threadpool_t *pool);
+
+#endif // TT_THREADPOOL_H_
@@ -48,6 +48,8 @@ typedef enum {
   TT_ERROR_NOT_IMPLEMENTED, /**< Feature not implemented*/
   TT_ERROR_UNKNOWN,         /**< Unknown error occured*/
   // Add more error codes as needed
+
+  TT_ERROR_CODE_COUNT, /**< Number of error codes, keep last*/
 } tt_error_t;
 
 #endif // TT_TYPES_H_
@@ -21,6 +21,9 @@
 #define FLASHEND 0x7FFF // Default Arduino Uno flash end
 #endif
 
+// Provided by the Arduino core (wiring.c)
+extern unsigned long micros(void);
+
 tt_error_t tt_platform_arduino_init(tt_platform_info_t *info) {
   if (info == NULL) {
     return TT_ERROR_NULL_POINTER;
@@ -45,3 +48,17 @@ tt_error_t tt_platform_arduino_init(tt_platform_info_t *info) {
 }
 
 tt_error_t tt_platform_arduino_cleanup(void) { return TT_SUCCESS; }
+
+uint64_t tt_platform_time_monotonic_ns(void) {
+  // Extend the 32-bit micros() counter, which wraps every ~71 minutes
+  static uint32_t last_us = 0;
+  static uint64_t high_us = 0;
+
+  uint32_t now_us = (uint32_t)micros();
+  if (now_us < last_us) {
+    high_us += (1ULL << 32);
+  }
+  last_us = now_us;
+
+  return (high_us + now_us) * 1000ULL;
+}
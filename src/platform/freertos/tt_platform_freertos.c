@@ -7,6 +7,11 @@
  */
 
 #include "../internal/tt_platform_internal.h"
+#include "tt_mutex.h"
+#include "tt_thread_internal.h"
+#include <FreeRTOS.h>
+#include <semphr.h>
+#include <task.h>
 
 // FreeRTOS specific defines - these would typically come from FreeRTOSConfig.h
 #ifndef configCPU_CLOCK_HZ
@@ -52,3 +57,208 @@ tt_error_t tt_platform_freertos_init(tt_platform_info_t *info) {
 }
 
 tt_error_t tt_platform_freertos_cleanup(void) { return TT_SUCCESS; }
+
+uint64_t tt_platform_time_monotonic_ns(void) {
+  return (uint64_t)xTaskGetTickCount() * (1000000000ULL / configTICK_RATE_HZ);
+}
+
+#if defined(TT_CAP_THREADS)
+/**
+ * @brief Task parked in tt_platform_futex_wait
+ */
+typedef struct {
+  volatile uint32_t *addr; /**< Word the task waits on, NULL if slot free*/
+  TaskHandle_t task;       /**< Parked task*/
+  bool woken;              /**< Notification already sent*/
+} tt_freertos_waiter_t;
+
+/* FreeRTOS has no futex, so parked tasks are tracked here and woken with
+ * direct-to-task notifications. Slots are guarded by critical sections. */
+static tt_freertos_waiter_t freertos_waiters[TT_MAX_THREADS];
+
+tt_error_t tt_platform_futex_wait(volatile uint32_t *addr, uint32_t expected,
+                                  uint64_t deadline_ns) {
+  if (addr == NULL) {
+    return TT_ERROR_NULL_POINTER;
+  }
+
+  TickType_t ticks = portMAX_DELAY;
+  if (deadline_ns != TT_PLATFORM_WAIT_FOREVER) {
+    uint64_t now = tt_platform_time_monotonic_ns();
+    if (deadline_ns <= now) {
+      return TT_ERROR_TIMEOUT;
+    }
+    uint64_t ms = (deadline_ns - now + 999999ULL) / 1000000ULL;
+    // Keep pdMS_TO_TICKS from wrapping; a shorter wait reads as spurious
+    uint64_t max_ms = ((uint64_t)portMAX_DELAY - 1) / configTICK_RATE_HZ;
+    if (ms > max_ms) {
+      ms = max_ms;
+    }
+    ticks = pdMS_TO_TICKS(ms);
+    if (ticks == 0) {
+      ticks = 1;
+    }
+  }
+
+  size_t slot = TT_MAX_THREADS;
+  taskENTER_CRITICAL();
+  if (*addr != expected) {
+    taskEXIT_CRITICAL();
+    return TT_SUCCESS;
+  }
+  for (size_t i = 0; i < TT_MAX_THREADS; i++) {
+    if (freertos_waiters[i].addr == NULL) {
+      freertos_waiters[i].addr = addr;
+      freertos_waiters[i].task = xTaskGetCurrentTaskHandle();
+      freertos_waiters[i].woken = false;
+      slot = i;
+      break;
+    }
+  }
+  taskEXIT_CRITICAL();
+
+  if (slot == TT_MAX_THREADS) {
+    // No free slot: degrade to a yield, callers re-check in a loop
+    taskYIELD();
+    return TT_SUCCESS;
+  }
+
+  uint32_t notified = ulTaskNotifyTake(pdTRUE, ticks);
+
+  taskENTER_CRITICAL();
+  if (notified == 0 && freertos_waiters[slot].woken) {
+    // Woken between the timeout and here: the wake counted us, so take it
+    // and drop its notification before it cuts the next wait short
+    ulTaskNotifyTake(pdTRUE, 0);
+    notified = 1;
+  }
+  freertos_waiters[slot].addr = NULL;
+  freertos_waiters[slot].task = NULL;
+  taskEXIT_CRITICAL();
+
+  if (notified == 0 && deadline_ns != TT_PLATFORM_WAIT_FOREVER &&
+      tt_platform_time_monotonic_ns() < deadline_ns) {
+    return TT_SUCCESS; // Clamped wait ended early
+  }
+  return (notified == 0) ? TT_ERROR_TIMEOUT : TT_SUCCESS;
+}
+
+tt_error_t tt_platform_futex_wake(volatile uint32_t *addr, uint32_t count) {
+  if (addr == NULL) {
+    return TT_ERROR_NULL_POINTER;
+  }
+
+  taskENTER_CRITICAL();
+  for (size_t i = 0; i < TT_MAX_THREADS && count > 0; i++) {
+    if (freertos_waiters[i].addr == addr && !freertos_waiters[i].woken) {
+      freertos_waiters[i].woken = true;
+      xTaskNotifyGive(freertos_waiters[i].task);
+      count--;
+    }
+  }
+  taskEXIT_CRITICAL();
+
+  return TT_SUCCESS;
+}
+#endif /* TT_CAP_THREADS */
+
+#if defined(TT_CAP_MUTEX)
+tt_error_t tt_platform_mutex_init(tt_mutex_t *mutex,
+                                  const tt_mutex_attr_t *attr) {
+  if (mutex == NULL) {
+    return TT_ERROR_NULL_POINTER;
+  }
+
+  SemaphoreHandle_t handle;
+  if (attr != NULL && attr->protocol == TT_MUTEX_PROTOCOL_INHERIT) {
+    // FreeRTOS mutexes implement priority inheritance
+    handle = xSemaphoreCreateMutex();
+  } else {
+    // Binary semaphores never boost the holder
+    handle = xSemaphoreCreateBinary();
+    if (handle != NULL) {
+      xSemaphoreGive(handle);
+    }
+  }
+
+  if (handle == NULL) {
+    return TT_ERROR_MUTEX_INIT;
+  }
+
+  mutex->lock = (void *)handle;
+  mutex->initialized = true;
+  return TT_SUCCESS;
+}
+
+tt_error_t tt_platform_mutex_destroy(tt_mutex_t *mutex) {
+  if (mutex == NULL) {
+    return TT_ERROR_NULL_POINTER;
+  }
+
+  vSemaphoreDelete((SemaphoreHandle_t)mutex->lock);
+  mutex->initialized = false;
+  return TT_SUCCESS;
+}
+
+tt_error_t tt_platform_mutex_lock(tt_mutex_t *mutex) {
+  if (mutex == NULL) {
+    return TT_ERROR_NULL_POINTER;
+  }
+  if (!mutex->initialized) {
+    return TT_ERROR_INVALID_PARAM;
+  }
+
+  return (xSemaphoreTake((SemaphoreHandle_t)mutex->lock, portMAX_DELAY) ==
+          pdTRUE)
+             ? TT_SUCCESS
+             : TT_ERROR_MUTEX_LOCK;
+}
+
+tt_error_t tt_platform_mutex_unlock(tt_mutex_t *mutex) {
+  if (mutex == NULL) {
+    return TT_ERROR_NULL_POINTER;
+  }
+  if (!mutex->initialized) {
+    return TT_ERROR_INVALID_PARAM;
+  }
+
+  return (xSemaphoreGive((SemaphoreHandle_t)mutex->lock) == pdTRUE)
+             ? TT_SUCCESS
+             : TT_ERROR_MUTEX_UNLOCK;
+}
+
+tt_error_t tt_platform_mutex_trylock(tt_mutex_t *mutex) {
+  if (mutex == NULL) {
+    return TT_ERROR_NULL_POINTER;
+  }
+  if (!mutex->initialized) {
+    return TT_ERROR_INVALID_PARAM;
+  }
+
+  return (xSemaphoreTake((SemaphoreHandle_t)mutex->lock, 0) == pdTRUE)
+             ? TT_SUCCESS
+             : TT_ERROR_BUSY;
+}
+
+tt_error_t tt_platform_mutex_timedlock(tt_mutex_t *mutex, uint32_t timeout_ms) {
+  if (mutex == NULL) {
+    return TT_ERROR_NULL_POINTER;
+  }
+  if (!mutex->initialized) {
+    return TT_ERROR_INVALID_PARAM;
+  }
+
+  return (xSemaphoreTake((SemaphoreHandle_t)mutex->lock,
+                         pdMS_TO_TICKS(timeout_ms)) == pdTRUE)
+             ? TT_SUCCESS
+             : TT_ERROR_TIMEOUT;
+}
+
+bool tt_platform_mutex_is_locked(tt_mutex_t *mutex) {
+  if (mutex == NULL || !mutex->initialized) {
+    return false;
+  }
+
+  return uxSemaphoreGetCount((SemaphoreHandle_t)mutex->lock) == 0;
+}
+#endif /* TT_CAP_MUTEX */
@@ -5,17 +5,24 @@
  * @brief
  * @copyright Copyright (c) 2024 AnAlphaBeta. All rights reserved.
  */
-#define _POSIX_C_SOURCE 199309L
+#define _GNU_SOURCE
 
 #include "../internal/tt_platform_internal.h"
+#include "tt_error.h"
 #include "tt_mutex.h"
 #include "tt_platform.h"
 #include "tt_thread.h"
 #include "tt_thread_internal.h"
 #include "tt_types.h"
+#include <errno.h>
+#include <limits.h>
+#include <linux/futex.h>
 #include <pthread.h>
 #include <sched.h>
 #include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
 #include <sys/sysinfo.h>
 #include <time.h>
 #include <unistd.h>
@@ -67,8 +74,10 @@ tt_error_t tt_platform_linux_init(tt_platform_info_t *info) {
   // Thread capabilities
   info->thread.min_stack_size = _SC_THREAD_STACK_MIN;
   info->thread.max_stack_size = 8 * 1024 * 1024; // 8MB default
-  info->thread.min_priority = sched_get_priority_min(SCHED_OTHER);
-  info->thread.max_priority = sched_get_priority_max(SCHED_OTHER);
+  // Static priorities the levels map to, see linux_sched_params: LOW and
+  // NORMAL run at 0, REALTIME at one below the SCHED_FIFO maximum
+  info->thread.min_priority = 0;
+  info->thread.max_priority = sched_get_priority_max(SCHED_FIFO) - 1;
 
   // IRQ capabilities
   info->irq.irq_levels = 0;
@@ -79,7 +88,409 @@ tt_error_t tt_platform_linux_init(tt_platform_info_t *info) {
 
 tt_error_t tt_platform_linux_cleanup() { return TT_SUCCESS; }
 
+uint64_t tt_platform_time_monotonic_ns(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
 #if defined(TT_CAP_THREADS)
+/**
+ * @brief Thread object of the calling thread, published by the trampoline
+ *
+ * NULL for threads that were not started through tt_platform_thread_create
+ * (e.g. the main thread).
+ */
+static _Thread_local tt_thread_t *current_thread;
+
+/* Fill a cpu_set_t from a tt affinity mask, 0 meaning every CPU */
+static void linux_cpu_set(uint64_t affinity, cpu_set_t *set) {
+  CPU_ZERO(set);
+  for (int cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+    if (affinity == 0 || (cpu < 64 && (affinity & (UINT64_C(1) << cpu)))) {
+      CPU_SET(cpu, set);
+    }
+  }
+}
+
+/*
+ * Prefer allocations from the given NUMA nodes, falling back to the lowest
+ * one where the kernel cannot prefer several. Memory policy is per thread,
+ * so this runs on the new thread itself. Best effort: kernels without NUMA
+ * support reject the call and the thread keeps the default policy.
+ */
+static void linux_thread_bind_memory(uint64_t numa_mask) {
+#if defined(SYS_set_mempolicy)
+#ifndef MPOL_DEFAULT
+#define MPOL_DEFAULT 0
+#endif
+#ifndef MPOL_PREFERRED
+#define MPOL_PREFERRED 1
+#endif
+#ifndef MPOL_PREFERRED_MANY
+#define MPOL_PREFERRED_MANY 5
+#endif
+  enum { NODE_BITS = 8 * sizeof(unsigned long) };
+  unsigned long nodes[(64 + NODE_BITS - 1) / NODE_BITS] = {0};
+
+  for (int node = 0; node < 64; node++) {
+    if (numa_mask & (UINT64_C(1) << node)) {
+      nodes[node / NODE_BITS] |= 1UL << (node % NODE_BITS);
+    }
+  }
+  if (numa_mask == 0) {
+    // Back to the system default, for threads that are reused
+    (void)syscall(SYS_set_mempolicy, MPOL_DEFAULT, NULL, 0);
+    return;
+  }
+  // maxnode counts one past the last bit the kernel reads. Kernels before
+  // 5.15 lack PREFERRED_MANY and only honour the lowest node of the mask.
+  if (syscall(SYS_set_mempolicy, MPOL_PREFERRED_MANY, nodes, 64 + 1) != 0 &&
+      errno == EINVAL) {
+    (void)syscall(SYS_set_mempolicy, MPOL_PREFERRED, nodes, 64 + 1);
+  }
+#else
+  (void)numa_mask;
+#endif
+}
+
+/*
+ * Map a tt priority onto a Linux policy. SCHED_OTHER has a single static
+ * priority, so the levels differ by policy: LOW runs as SCHED_BATCH, HIGH as
+ * round-robin real-time in the middle of the range and REALTIME as FIFO one
+ * below the top, which stays reserved for kernel watchdog threads.
+ */
+static tt_error_t linux_sched_params(tt_thread_priority_t priority,
+                                     int *policy, struct sched_param *param) {
+  switch (priority) {
+  case TT_THREAD_PRIORITY_LOW:
+    *policy = SCHED_BATCH;
+    param->sched_priority = 0;
+    break;
+  case TT_THREAD_PRIORITY_NORMAL:
+    *policy = SCHED_OTHER;
+    param->sched_priority = 0;
+    break;
+  case TT_THREAD_PRIORITY_HIGH:
+    *policy = SCHED_RR;
+    param->sched_priority =
+        (sched_get_priority_min(SCHED_RR) + sched_get_priority_max(SCHED_RR)) /
+        2;
+    break;
+  case TT_THREAD_PRIORITY_REALTIME:
+    *policy = SCHED_FIFO;
+    param->sched_priority = sched_get_priority_max(SCHED_FIFO) - 1;
+    break;
+  default:
+    return TT_ERROR_INVALID_PARAM;
+  }
+  return TT_SUCCESS;
+}
+
+/* Name the calling thread, cut to the 15 characters the kernel keeps */
+static void linux_thread_set_name(const char *name) {
+  char comm[16];
+
+  if (name == NULL) {
+    return;
+  }
+  strncpy(comm, name, sizeof(comm) - 1);
+  comm[sizeof(comm) - 1] = '\0';
+  (void)pthread_setname_np(pthread_self(), comm);
+}
+
+/**
+ * @brief Run a tt thread's function on the calling OS thread
+ *
+ * Publishes the thread object in thread-local storage before handing control
+ * to the user function, so tt_platform_thread_self never needs the registry.
+ */
+static void *linux_thread_run(tt_thread_t *thread) {
+  linux_thread_set_name(thread->name);
+  current_thread = thread;
+  __atomic_store_n(&thread->state, TT_THREAD_STATE_RUNNING, __ATOMIC_RELEASE);
+  // Suspended before it got going: park before any user code runs
+  tt_platform_thread_checkpoint();
+  return thread->func(thread->arg);
+}
+
+static void *linux_thread_trampoline(void *arg) {
+  tt_thread_t *thread = (tt_thread_t *)arg;
+
+  if (thread->numa_mask != 0) {
+    linux_thread_bind_memory(thread->numa_mask);
+  }
+  if (thread->priority == TT_THREAD_PRIORITY_LOW) {
+    struct sched_param param = {.sched_priority = 0};
+    (void)pthread_setschedparam(pthread_self(), SCHED_BATCH, &param);
+  }
+  return linux_thread_run(thread);
+}
+
+/* tt_thread_t.done values for threads running on a carrier */
+#define THREAD_DONE 0x1u
+#define THREAD_DONE_WAITER 0x2u
+
+/* linux_carrier_t.command values */
+#define CARRIER_IDLE 0u
+#define CARRIER_RUN 1u
+#define CARRIER_EXIT 2u
+
+/**
+ * @brief OS thread kept alive to run one tt thread after another
+ *
+ * Used while the thread cache is enabled. Between jobs the carrier sits in
+ * the cache, parked on @c command, with its stack still mapped.
+ */
+typedef struct linux_carrier_t {
+  pthread_t handle;              /**< The OS thread*/
+  size_t stack_size;             /**< Usable stack size*/
+  uint64_t numa_mask;            /**< Memory policy currently applied*/
+  volatile uint32_t command;     /**< CARRIER_* value, wait word*/
+  tt_thread_t *thread;           /**< Job to run on CARRIER_RUN*/
+  struct linux_carrier_t *next;  /**< Next idle carrier in the cache*/
+} linux_carrier_t;
+
+/* Idle carriers; capacity 0 means the cache is disabled */
+static struct {
+  pthread_mutex_t lock;
+  linux_carrier_t *idle; /**< Most recently parked first*/
+  size_t idle_count;
+  size_t capacity;
+} carrier_cache = {.lock = PTHREAD_MUTEX_INITIALIZER};
+
+/* Carrier of the calling thread, NULL for plain threads */
+static _Thread_local linux_carrier_t *current_carrier;
+
+/* Publish the end of a carrier-run thread; the joiner may free it after */
+static void linux_thread_complete(tt_thread_t *thread, void *retval) {
+  thread->retval = retval;
+  if (__atomic_exchange_n(&thread->done, THREAD_DONE, __ATOMIC_ACQ_REL) ==
+      THREAD_DONE_WAITER) {
+    tt_platform_futex_wake(&thread->done, TT_PLATFORM_WAKE_ALL);
+  }
+}
+
+/* Put a carrier back in the cache, false when there is no room for it */
+static bool linux_carrier_park(linux_carrier_t *carrier) {
+  pthread_mutex_lock(&carrier_cache.lock);
+  bool cached = carrier_cache.idle_count < carrier_cache.capacity;
+  if (cached) {
+    carrier->next = carrier_cache.idle;
+    carrier_cache.idle = carrier;
+    carrier_cache.idle_count++;
+  }
+  pthread_mutex_unlock(&carrier_cache.lock);
+  return cached;
+}
+
+/* Take an idle carrier whose stack is at least stack_size bytes */
+static linux_carrier_t *linux_carrier_take(size_t stack_size) {
+  linux_carrier_t *carrier = NULL;
+
+  pthread_mutex_lock(&carrier_cache.lock);
+  for (linux_carrier_t **link = &carrier_cache.idle; *link != NULL;
+       link = &(*link)->next) {
+    if ((*link)->stack_size >= stack_size) {
+      carrier = *link;
+      *link = carrier->next;
+      carrier_cache.idle_count--;
+      break;
+    }
+  }
+  pthread_mutex_unlock(&carrier_cache.lock);
+  return carrier;
+}
+
+static void linux_carrier_post(linux_carrier_t *carrier, uint32_t command) {
+  __atomic_store_n(&carrier->command, command, __ATOMIC_RELEASE);
+  tt_platform_futex_wake(&carrier->command, 1);
+}
+
+/* Return a carrier that was taken but not used, or stop it */
+static void linux_carrier_release(linux_carrier_t *carrier) {
+  if (!linux_carrier_park(carrier)) {
+    linux_carrier_post(carrier, CARRIER_EXIT);
+  }
+}
+
+static void *linux_carrier_main(void *arg) {
+  linux_carrier_t *carrier = (linux_carrier_t *)arg;
+  uint32_t command;
+
+  current_carrier = carrier;
+  for (;;) {
+    while ((command = __atomic_load_n(&carrier->command, __ATOMIC_ACQUIRE)) ==
+           CARRIER_IDLE) {
+      tt_platform_futex_wait(&carrier->command, CARRIER_IDLE,
+                             TT_PLATFORM_WAIT_FOREVER);
+    }
+    if (command == CARRIER_EXIT) {
+      break;
+    }
+
+    tt_thread_t *thread = carrier->thread;
+    __atomic_store_n(&carrier->command, CARRIER_IDLE, __ATOMIC_RELAXED);
+    if (thread->numa_mask != carrier->numa_mask) {
+      linux_thread_bind_memory(thread->numa_mask);
+      carrier->numa_mask = thread->numa_mask;
+    }
+
+    void *retval = linux_thread_run(thread);
+
+    // Nothing of this job may leak into the next one
+    current_thread = NULL;
+    tt_error_clear();
+    tt_error_clear_recent();
+
+    // Park first, so a joiner that creates the next thread finds us cached
+    bool cached = linux_carrier_park(carrier);
+    linux_thread_complete(thread, retval);
+    if (!cached) {
+      break;
+    }
+  }
+
+  free(carrier);
+  return NULL;
+}
+
+/*
+ * Reapply the attributes a new job expects to an idle carrier. Runs on the
+ * creating thread: NORMAL priority and affinity 0 copy the creator's own
+ * settings, as a fresh thread would inherit them.
+ */
+static tt_error_t linux_carrier_configure(linux_carrier_t *carrier,
+                                          const tt_thread_attr_t *attr) {
+  int policy;
+  struct sched_param param;
+  cpu_set_t set;
+  int ret;
+
+  tt_thread_priority_t priority =
+      attr ? attr->priority : TT_THREAD_PRIORITY_NORMAL;
+  if (priority == TT_THREAD_PRIORITY_NORMAL) {
+    ret = pthread_getschedparam(pthread_self(), &policy, &param);
+    if (ret != 0) {
+      return TT_ERROR_THREAD_PRIORITY;
+    }
+  } else {
+    tt_error_t result = linux_sched_params(priority, &policy, &param);
+    if (result != TT_SUCCESS) {
+      return result;
+    }
+  }
+  ret = pthread_setschedparam(carrier->handle, policy, &param);
+  if (ret != 0) {
+    return (ret == EINVAL) ? TT_ERROR_INVALID_PARAM : TT_ERROR_THREAD_PRIORITY;
+  }
+
+  if (attr != NULL && attr->affinity != 0) {
+    linux_cpu_set(attr->affinity, &set);
+  } else if (pthread_getaffinity_np(pthread_self(), sizeof(set), &set) != 0) {
+    return TT_ERROR_PLATFORM_SPECIFIC;
+  }
+  ret = pthread_setaffinity_np(carrier->handle, sizeof(set), &set);
+  if (ret != 0) {
+    return (ret == EINVAL) ? TT_ERROR_INVALID_PARAM
+                           : TT_ERROR_PLATFORM_SPECIFIC;
+  }
+  return TT_SUCCESS;
+}
+
+/* Hand a thread to a cached carrier, or start a new carrier for it */
+static tt_error_t linux_carrier_start(tt_thread_t *thread,
+                                      const tt_thread_attr_t *attr,
+                                      pthread_attr_t *pthread_attr) {
+  size_t stack_size = 0;
+  pthread_attr_getstacksize(pthread_attr, &stack_size);
+
+  thread->cached = true;
+  thread->done = 0;
+
+  linux_carrier_t *carrier = linux_carrier_take(stack_size);
+  if (carrier != NULL) {
+    tt_error_t result = linux_carrier_configure(carrier, attr);
+    if (result != TT_SUCCESS) {
+      linux_carrier_release(carrier);
+      return result;
+    }
+    thread->handle = carrier->handle;
+    carrier->thread = thread;
+    linux_carrier_post(carrier, CARRIER_RUN);
+    return TT_SUCCESS;
+  }
+
+  carrier = calloc(1, sizeof(*carrier));
+  if (carrier == NULL) {
+    return TT_ERROR_MEMORY;
+  }
+  carrier->stack_size = stack_size;
+  carrier->thread = thread;
+  carrier->command = CARRIER_RUN;
+
+  // Nobody joins a carrier, it frees itself when it leaves the cache
+  pthread_attr_setdetachstate(pthread_attr, PTHREAD_CREATE_DETACHED);
+  int ret = pthread_create(&carrier->handle, pthread_attr, linux_carrier_main,
+                           carrier);
+  if (ret != 0) {
+    free(carrier);
+    if (ret == EPERM) {
+      return TT_ERROR_THREAD_PRIORITY;
+    }
+    if (ret == EINVAL && attr != NULL && attr->affinity != 0) {
+      return TT_ERROR_INVALID_PARAM;
+    }
+    return TT_ERROR_THREAD_CREATE;
+  }
+  thread->handle = carrier->handle;
+  return TT_SUCCESS;
+}
+
+tt_error_t tt_platform_thread_cache_init(size_t capacity) {
+  linux_carrier_t *excess = NULL;
+
+  if (capacity == 0) {
+    return TT_ERROR_INVALID_PARAM;
+  }
+
+  pthread_mutex_lock(&carrier_cache.lock);
+  __atomic_store_n(&carrier_cache.capacity, capacity, __ATOMIC_RELAXED);
+  // Shrinking: stop the carriers that no longer fit
+  while (carrier_cache.idle_count > capacity) {
+    linux_carrier_t *carrier = carrier_cache.idle;
+    carrier_cache.idle = carrier->next;
+    carrier_cache.idle_count--;
+    carrier->next = excess;
+    excess = carrier;
+  }
+  pthread_mutex_unlock(&carrier_cache.lock);
+
+  while (excess != NULL) {
+    linux_carrier_t *next = excess->next;
+    linux_carrier_post(excess, CARRIER_EXIT);
+    excess = next;
+  }
+  return TT_SUCCESS;
+}
+
+tt_error_t tt_platform_thread_cache_cleanup(void) {
+  pthread_mutex_lock(&carrier_cache.lock);
+  linux_carrier_t *idle = carrier_cache.idle;
+  carrier_cache.idle = NULL;
+  carrier_cache.idle_count = 0;
+  __atomic_store_n(&carrier_cache.capacity, 0, __ATOMIC_RELAXED);
+  pthread_mutex_unlock(&carrier_cache.lock);
+
+  // Busy carriers find no room when their job ends and exit by themselves
+  while (idle != NULL) {
+    linux_carrier_t *next = idle->next;
+    linux_carrier_post(idle, CARRIER_EXIT);
+    idle = next;
+  }
+  return TT_SUCCESS;
+}
+
 tt_error_t tt_platform_thread_create(tt_thread_t *thread,
                                      const tt_thread_attr_t *attr,
                                      tt_thread_func_t func, void *arg) {
@@ -101,13 +512,62 @@ tt_error_t tt_platform_thread_create(tt_thread_t *thread,
         return TT_ERROR_THREAD_CREATE;
       }
     }
+
+    // NORMAL keeps inheriting the creator's policy
+    if (attr->priority != TT_THREAD_PRIORITY_NORMAL) {
+      int policy;
+      struct sched_param param;
+      if (linux_sched_params(attr->priority, &policy, &param) != TT_SUCCESS) {
+        pthread_attr_destroy(&pthread_attr);
+        return TT_ERROR_INVALID_PARAM;
+      }
+      // Attributes only take the POSIX policies, a LOW thread switches to
+      // SCHED_BATCH itself when it starts
+      if (policy != SCHED_BATCH &&
+          (pthread_attr_setinheritsched(&pthread_attr,
+                                        PTHREAD_EXPLICIT_SCHED) != 0 ||
+           pthread_attr_setschedpolicy(&pthread_attr, policy) != 0 ||
+           pthread_attr_setschedparam(&pthread_attr, &param) != 0)) {
+        pthread_attr_destroy(&pthread_attr);
+        return TT_ERROR_THREAD_PRIORITY;
+      }
+    }
+
+    if (attr->affinity != 0) {
+      cpu_set_t set;
+      linux_cpu_set(attr->affinity, &set);
+      ret = pthread_attr_setaffinity_np(&pthread_attr, sizeof(set), &set);
+      if (ret != 0) {
+        pthread_attr_destroy(&pthread_attr);
+        return TT_ERROR_THREAD_CREATE;
+      }
+    }
   }
 
+  thread->func = func;
+  thread->arg = arg;
   thread->state = TT_THREAD_STATE_CREATED;
+  thread->suspend_request = 0;
+  thread->cached = false;
+
+  if (__atomic_load_n(&carrier_cache.capacity, __ATOMIC_RELAXED) > 0) {
+    tt_error_t result = linux_carrier_start(thread, attr, &pthread_attr);
+    pthread_attr_destroy(&pthread_attr);
+    return result;
+  }
 
-  ret = pthread_create(&thread->handle, &pthread_attr, func, arg);
+  ret = pthread_create(&thread->handle, &pthread_attr, linux_thread_trampoline,
+                       thread);
   pthread_attr_destroy(&pthread_attr);
 
+  if (ret == EPERM) {
+    // Real-time policy requested without the privilege for it
+    return TT_ERROR_THREAD_PRIORITY;
+  }
+  if (ret == EINVAL && attr != NULL && attr->affinity != 0) {
+    // The mask names no CPU this system can run on
+    return TT_ERROR_INVALID_PARAM;
+  }
   return (ret == 0) ? TT_SUCCESS : TT_ERROR_THREAD_CREATE;
 }
 
@@ -116,6 +576,23 @@ tt_error_t tt_platform_thread_join(tt_thread_t *thread, void **retval) {
     return TT_ERROR_NULL_POINTER;
   }
 
+  if (thread->cached) {
+    // The OS thread lives on in the cache; wait for the job instead
+    uint32_t done = 0;
+    __atomic_compare_exchange_n(&thread->done, &done, THREAD_DONE_WAITER,
+                                false, __ATOMIC_ACQUIRE, __ATOMIC_ACQUIRE);
+    while (__atomic_load_n(&thread->done, __ATOMIC_ACQUIRE) != THREAD_DONE) {
+      tt_platform_futex_wait(&thread->done, THREAD_DONE_WAITER,
+                             TT_PLATFORM_WAIT_FOREVER);
+    }
+    if (retval != NULL) {
+      *retval = thread->retval;
+    }
+    thread->state = TT_THREAD_STATE_TERMINATED;
+    thread->is_active = false;
+    return TT_SUCCESS;
+  }
+
   int result = pthread_join(thread->handle, retval);
   if (result == 0) {
     thread->state = TT_THREAD_STATE_TERMINATED;
@@ -134,44 +611,54 @@ tt_error_t tt_platform_thread_set_priority(tt_thread_t *thread,
   if (thread == NULL) {
     return TT_ERROR_NULL_POINTER;
   }
+
+  int policy;
   struct sched_param param;
-  int policy = SCHED_OTHER; // Use the default scheduler
-  int min_prio = sched_get_priority_min(policy);
-  int max_prio = sched_get_priority_max(policy);
+  tt_error_t result = linux_sched_params(priority, &policy, &param);
+  if (result != TT_SUCCESS) {
+    return result;
+  }
 
-  // Map our priority levels to the system's priority range
-  int system_priority;
-  switch (priority) {
-  case TT_THREAD_PRIORITY_LOW:
-    system_priority = min_prio;
-    break;
-  case TT_THREAD_PRIORITY_NORMAL:
-    system_priority = min_prio + (max_prio - min_prio) / 3;
-    break;
-  case TT_THREAD_PRIORITY_HIGH:
-    system_priority = min_prio + 2 * (max_prio - min_prio) / 3;
-    break;
-  case TT_THREAD_PRIORITY_REALTIME:
-    system_priority = max_prio;
-    break;
-  default:
-    return TT_ERROR_INVALID_PARAM;
+  int ret = pthread_setschedparam(thread->handle, policy, &param);
+  if (ret != 0) {
+    // EPERM without CAP_SYS_NICE or an RLIMIT_RTPRIO allowance
+    return (ret == EINVAL) ? TT_ERROR_INVALID_PARAM : TT_ERROR_THREAD_PRIORITY;
   }
 
-  param.sched_priority = system_priority;
-  pthread_t *pthread_handle = (pthread_t *)thread->handle;
-  pthread_setschedparam(*pthread_handle, policy, &param);
   thread->priority = priority;
   return TT_SUCCESS;
 }
 
+tt_error_t tt_platform_thread_set_affinity(tt_thread_t *thread,
+                                           uint64_t affinity) {
+  if (thread == NULL) {
+    return TT_ERROR_NULL_POINTER;
+  }
+
+  cpu_set_t set;
+  linux_cpu_set(affinity, &set);
+  int ret = pthread_setaffinity_np(thread->handle, sizeof(set), &set);
+  if (ret == EINVAL) {
+    return TT_ERROR_INVALID_PARAM;
+  }
+  return (ret == 0) ? TT_SUCCESS : TT_ERROR_PLATFORM_SPECIFIC;
+}
+
+/*
+ * Linux cannot stop another thread without signals, which would interrupt it
+ * anywhere, locks held included. Suspension is therefore a request the
+ * thread honours at its own safe points, parked on the request word.
+ */
 tt_error_t tt_platform_thread_suspend(tt_thread_t *thread) {
   if (thread == NULL) {
     return TT_ERROR_NULL_POINTER;
   }
-  // Linux doesn't have direct thread suspension
-  // TODO: See what to do about this
-  return TT_ERROR_NOT_IMPLEMENTED;
+
+  __atomic_store_n(&thread->suspend_request, 1, __ATOMIC_RELEASE);
+  if (thread == current_thread) {
+    return tt_platform_thread_checkpoint();
+  }
+  return TT_SUCCESS;
 }
 
 tt_error_t tt_platform_thread_resume(tt_thread_t *thread) {
@@ -179,22 +666,40 @@ tt_error_t tt_platform_thread_resume(tt_thread_t *thread) {
     return TT_ERROR_NULL_POINTER;
   }
 
-  // Linux doesn't have direct thread suspension
-  // TODO: See what to do about this
-  return TT_ERROR_NOT_IMPLEMENTED;
+  if (__atomic_exchange_n(&thread->suspend_request, 0, __ATOMIC_ACQ_REL)) {
+    return tt_platform_futex_wake(&thread->suspend_request,
+                                  TT_PLATFORM_WAKE_ALL);
+  }
+  return TT_SUCCESS;
+}
+
+tt_error_t tt_platform_thread_checkpoint(void) {
+  tt_thread_t *thread = current_thread;
+
+  if (thread == NULL ||
+      __atomic_load_n(&thread->suspend_request, __ATOMIC_ACQUIRE) == 0) {
+    return TT_SUCCESS;
+  }
+
+  __atomic_store_n(&thread->state, TT_THREAD_STATE_SUSPENDED, __ATOMIC_RELEASE);
+  while (__atomic_load_n(&thread->suspend_request, __ATOMIC_ACQUIRE) != 0) {
+    tt_platform_futex_wait(&thread->suspend_request, 1,
+                           TT_PLATFORM_WAIT_FOREVER);
+  }
+  __atomic_store_n(&thread->state, TT_THREAD_STATE_RUNNING, __ATOMIC_RELEASE);
+  return TT_SUCCESS;
 }
 
 tt_error_t tt_platform_thread_sleep(uint32_t ms) {
+  tt_platform_thread_checkpoint();
+
   struct timespec ts;
   ts.tv_sec = ms / 1000;
   ts.tv_nsec = (ms % 1000) * 1000000;
   return (nanosleep(&ts, NULL) == 0) ? TT_SUCCESS : TT_ERROR_THREAD_SLEEP;
 }
 
-tt_thread_t *tt_platform_thread_self(void) {
-  pthread_t handle = pthread_self();
-  return tt_thread_table_find_by_handle(handle);
-}
+tt_thread_t *tt_platform_thread_self(void) { return current_thread; }
 
 tt_error_t tt_platform_thread_destroy(tt_thread_t *thread) {
   if (thread == NULL) {
@@ -221,33 +726,135 @@ tt_error_t tt_platform_thread_destroy(tt_thread_t *thread) {
     thread->is_active = false; // Mark thread as detached
   }
 
-  free(thread);
+  tt_thread_free(thread);
   return TT_SUCCESS;
 }
 
 // TODO: See if to implement it in tt_mutex.h
 tt_error_t tt_platform_thread_exit(void *retval) {
+  linux_carrier_t *carrier = current_carrier;
+  tt_thread_t *thread = current_thread;
+
+  if (carrier != NULL && thread != NULL) {
+    // The carrier loop unwinds with this thread, so it cannot be reused
+    current_carrier = NULL;
+    current_thread = NULL;
+    linux_thread_complete(thread, retval);
+    free(carrier);
+  }
   pthread_exit(retval);
   return TT_SUCCESS;
 }
 
+tt_error_t tt_platform_stack_alloc(size_t *size, void **stack) {
+  if (size == NULL || stack == NULL) {
+    return TT_ERROR_NULL_POINTER;
+  }
+
+  size_t page = (size_t)sysconf(_SC_PAGESIZE);
+  size_t usable = (*size + page - 1) & ~(page - 1);
+  if (usable == 0) {
+    return TT_ERROR_INVALID_PARAM;
+  }
+
+  // Pages are only backed once touched, untouched stack costs nothing
+  uint8_t *base = mmap(NULL, usable + page, PROT_READ | PROT_WRITE,
+                       MAP_PRIVATE | MAP_ANONYMOUS | MAP_STACK, -1, 0);
+  if (base == MAP_FAILED) {
+    return TT_ERROR_MEMORY;
+  }
+  if (mprotect(base, page, PROT_NONE) != 0) {
+    munmap(base, usable + page);
+    return TT_ERROR_PLATFORM_SPECIFIC;
+  }
+
+  *size = usable;
+  *stack = base + page;
+  return TT_SUCCESS;
+}
+
+tt_error_t tt_platform_stack_free(void *stack, size_t size) {
+  if (stack == NULL) {
+    return TT_ERROR_NULL_POINTER;
+  }
+
+  size_t page = (size_t)sysconf(_SC_PAGESIZE);
+  return (munmap((uint8_t *)stack - page, size + page) == 0)
+             ? TT_SUCCESS
+             : TT_ERROR_PLATFORM_SPECIFIC;
+}
+
+tt_error_t tt_platform_futex_wait(volatile uint32_t *addr, uint32_t expected,
+                                  uint64_t deadline_ns) {
+  if (addr == NULL) {
+    return TT_ERROR_NULL_POINTER;
+  }
+
+  // FUTEX_WAIT_BITSET takes an absolute CLOCK_MONOTONIC deadline, so
+  // spurious wake-ups do not stretch the total wait
+  struct timespec ts;
+  struct timespec *timeout = NULL;
+  if (deadline_ns != TT_PLATFORM_WAIT_FOREVER) {
+    ts.tv_sec = (time_t)(deadline_ns / 1000000000ULL);
+    ts.tv_nsec = (long)(deadline_ns % 1000000000ULL);
+    timeout = &ts;
+  }
+
+  long ret = syscall(SYS_futex, addr, FUTEX_WAIT_BITSET_PRIVATE, expected,
+                     timeout, NULL, FUTEX_BITSET_MATCH_ANY);
+  if (ret == -1 && errno == ETIMEDOUT) {
+    return TT_ERROR_TIMEOUT;
+  }
+
+  // Woken, value already changed (EAGAIN) or interrupted (EINTR)
+  return TT_SUCCESS;
+}
+
+tt_error_t tt_platform_futex_wake(volatile uint32_t *addr, uint32_t count) {
+  if (addr == NULL) {
+    return TT_ERROR_NULL_POINTER;
+  }
+
+  int n = (count > INT_MAX) ? INT_MAX : (int)count;
+  if (syscall(SYS_futex, addr, FUTEX_WAKE_PRIVATE, n, NULL, NULL, 0) == -1) {
+    return TT_ERROR_PLATFORM_SPECIFIC;
+  }
+  return TT_SUCCESS;
+}
+
 #endif /* TT_CAP_THREADS */
 
 #ifdef TT_CAP_MUTEX
-/* tt_error_t tt_platform_mutex_init(tt_mutex_t *mutex, */
-/*                                   const tt_mutex_attr_t *attr) { */
-tt_error_t tt_platform_mutex_init(tt_mutex_t *mutex) {
+tt_error_t tt_platform_mutex_init(tt_mutex_t *mutex,
+                                  const tt_mutex_attr_t *attr) {
   if (mutex == NULL) {
     return TT_ERROR_NULL_POINTER;
   }
 
+  pthread_mutexattr_t pthread_attr;
+  if (pthread_mutexattr_init(&pthread_attr) != 0) {
+    return TT_ERROR_MUTEX_INIT;
+  }
+
+  if (attr != NULL && attr->protocol == TT_MUTEX_PROTOCOL_INHERIT) {
+    // Backed by PI futexes: the owner runs at the priority of its highest
+    // priority waiter until it unlocks
+    if (pthread_mutexattr_setprotocol(&pthread_attr, PTHREAD_PRIO_INHERIT) !=
+        0) {
+      pthread_mutexattr_destroy(&pthread_attr);
+      return TT_ERROR_MUTEX_INIT;
+    }
+  }
+
   tt_linux_mutex_t *linux_mutex =
       (tt_linux_mutex_t *)malloc(sizeof(tt_linux_mutex_t));
   if (linux_mutex == NULL) {
+    pthread_mutexattr_destroy(&pthread_attr);
     return TT_ERROR_MEMORY;
   }
 
-  int res = pthread_mutex_init(&linux_mutex->pthread_mutex, NULL);
+  int res = pthread_mutex_init(&linux_mutex->pthread_mutex, &pthread_attr);
+  pthread_mutexattr_destroy(&pthread_attr);
   if (res != 0) {
     free(linux_mutex);
     return TT_ERROR_MUTEX_INIT;
@@ -317,6 +924,45 @@ tt_error_t tt_platform_mutex_trylock(tt_mutex_t *mutex) {
              ? TT_SUCCESS
              : TT_ERROR_BUSY;
 }
+
+static struct timespec linux_deadline(clockid_t clock, uint32_t timeout_ms) {
+  struct timespec ts;
+  clock_gettime(clock, &ts);
+  ts.tv_sec += timeout_ms / 1000;
+  ts.tv_nsec += (long)(timeout_ms % 1000) * 1000000L;
+  if (ts.tv_nsec >= 1000000000L) {
+    ts.tv_sec++;
+    ts.tv_nsec -= 1000000000L;
+  }
+  return ts;
+}
+
+tt_error_t tt_platform_mutex_timedlock(tt_mutex_t *mutex, uint32_t timeout_ms) {
+  if (mutex == NULL) {
+    return TT_ERROR_NULL_POINTER;
+  }
+  if (!mutex->initialized) {
+    return TT_ERROR_INVALID_PARAM;
+  }
+
+  tt_linux_mutex_t *linux_mutex = (tt_linux_mutex_t *)mutex->lock;
+
+  // Monotonic deadline, immune to wall clock jumps
+  struct timespec deadline = linux_deadline(CLOCK_MONOTONIC, timeout_ms);
+  int res = pthread_mutex_clocklock(&linux_mutex->pthread_mutex,
+                                    CLOCK_MONOTONIC, &deadline);
+  if (res == EINVAL) {
+    // Kernels without FUTEX_LOCK_PI2 only time PI mutexes on CLOCK_REALTIME
+    deadline = linux_deadline(CLOCK_REALTIME, timeout_ms);
+    res = pthread_mutex_timedlock(&linux_mutex->pthread_mutex, &deadline);
+  }
+
+  if (res == 0) {
+    return TT_SUCCESS;
+  }
+  return (res == ETIMEDOUT) ? TT_ERROR_TIMEOUT : TT_ERROR_MUTEX_LOCK;
+}
+
 bool tt_platform_mutex_is_locked(tt_mutex_t *mutex) {
   if (mutex == NULL || !mutex->initialized) {
     return false;
@@ -8,49 +8,45 @@
 
 #include "tt_platform.h"
 #include "internal/tt_platform_internal.h"
+#include "tt_once.h"
 #include "tt_types.h"
 #include <string.h>
 
 static tt_platform_info_t platform_info;
-static bool platform_initalized = false;
+static tt_once_t platform_once = TT_ONCE_INIT;
 
-tt_error_t tt_platfor_init() {
-  if (platform_initalized) {
-    return TT_ERROR_ALREADY_INITIALIZED;
-  }
-
-  tt_error_t err;
-
-#if defined(TT_PLATFORM_LINUX)
-  err = tt_platform_linux_init(&platform_info);
-#elif defined(TT_PLATFORM_ARDUINO)
-  err = tt_platform_arduino_init(&platform_info);
-#elif defined(TT_PLATFORM_FREERTOS)
-  err = tt_platform_freertos_init(&platform_info);
+static tt_error_t platform_init_once(void) {
+#if defined(TT_TARGET_LINUX)
+  return tt_platform_linux_init(&platform_info);
+#elif defined(TT_TARGET_ARDUINO)
+  return tt_platform_arduino_init(&platform_info);
+#elif defined(TT_TARGET_FREERTOS)
+  return tt_platform_freertos_init(&platform_info);
 #else
-  err = TT_ERROR_PLATFORM_NOT_SUPPORTED;
+  return TT_ERROR_PLATFORM_NOT_SUPPORTED;
 #endif
+}
 
-  if (err != TT_SUCCESS) {
-    return err;
+tt_error_t tt_platform_init(void) {
+  if (tt_once_is_done(&platform_once)) {
+    return TT_ERROR_ALREADY_INITIALIZED;
   }
 
-  platform_initalized = true;
-  return TT_SUCCESS;
+  return tt_call_once(&platform_once, platform_init_once);
 }
 
 tt_error_t tt_platform_cleanup(void) {
-  if (!platform_initalized) {
+  if (!tt_once_is_done(&platform_once)) {
     return TT_ERROR_NOT_INITIALIZED;
   }
 
   tt_error_t err;
 
-#if defined(TT_PLATFORM_LINUX)
+#if defined(TT_TARGET_LINUX)
   err = tt_platform_linux_cleanup();
-#elif defined(TT_PLATFORM_ARDUINO)
+#elif defined(TT_TARGET_ARDUINO)
   err = tt_platform_arduino_cleanup();
-#elif defined(TT_PLATFORM_FREERTOS)
+#elif defined(TT_TARGET_FREERTOS)
   err = tt_platform_freertos_cleanup();
 #else
   err = TT_ERROR_PLATFORM_NOT_SUPPORTED;
@@ -61,12 +57,12 @@ tt_error_t tt_platform_cleanup(void) {
   }
 
   memset(&platform_info, 0, sizeof(tt_platform_info_t));
-  platform_initalized = false;
+  tt_once_reset(&platform_once);
   return TT_SUCCESS;
 }
 
 tt_error_t tt_platform_get_info(tt_platform_info_t *info) {
-  if (!platform_initalized) {
+  if (!tt_once_is_done(&platform_once)) {
     return TT_ERROR_NOT_INITIALIZED;
   }
 
@@ -0,0 +1,252 @@
+/**
+ * @file tt_barrier.c
+ * @author Mihai Gurei <mihai.gurei@protonmail.com>
+ * @date 2025-01-16
+ * @brief
+ * @copyright Copyright (c) 2025 AnAlphaBeta. All rights reserved.
+ */
+
+#include "tt_barrier.h"
+#include "tt_atomic.h"
+#include "tt_platform.h"
+#include "tt_types.h"
+#include <stddef.h>
+
+/*
+ * Wait while *word == value. Spin first, since phases of persistent workers
+ * usually end within microseconds of each other, then park. The waiters
+ * increment pairs with the SEQ_CST store and load in word_release: either
+ * the releaser sees us, or the futex sees the changed word and returns.
+ */
+static tt_error_t word_wait(volatile uint32_t *word, uint32_t value,
+                            volatile uint32_t *waiters, uint64_t deadline_ns) {
+  for (uint32_t i = 0; i < TT_BARRIER_SPIN_COUNT; i++) {
+    if (__atomic_load_n(word, __ATOMIC_ACQUIRE) != value) {
+      return TT_SUCCESS;
+    }
+    tt_atomic_cpu_relax();
+  }
+
+  while (__atomic_load_n(word, __ATOMIC_ACQUIRE) == value) {
+    tt_error_t result;
+
+#if defined(TT_CAP_THREADS)
+    // Safe point for tt_thread_suspend before parking
+    tt_platform_thread_checkpoint();
+#endif
+    __atomic_fetch_add(waiters, 1, __ATOMIC_SEQ_CST);
+#if defined(TT_CAP_THREADS)
+    result = tt_platform_futex_wait(word, value, deadline_ns);
+#else
+    result = (deadline_ns != TT_PLATFORM_WAIT_FOREVER &&
+              tt_platform_time_monotonic_ns() >= deadline_ns)
+                 ? TT_ERROR_TIMEOUT
+                 : TT_SUCCESS;
+#endif
+    __atomic_fetch_sub(waiters, 1, __ATOMIC_RELAXED);
+
+    if (result == TT_ERROR_TIMEOUT) {
+      return (__atomic_load_n(word, __ATOMIC_ACQUIRE) != value)
+                 ? TT_SUCCESS
+                 : TT_ERROR_TIMEOUT;
+    }
+  }
+
+  return TT_SUCCESS;
+}
+
+/* Publish a new value of *word and wake everybody parked on the old one */
+static tt_error_t word_release(volatile uint32_t *word, uint32_t value,
+                               volatile uint32_t *waiters) {
+  __atomic_store_n(word, value, __ATOMIC_SEQ_CST);
+#if defined(TT_CAP_THREADS)
+  if (__atomic_load_n(waiters, __ATOMIC_SEQ_CST) > 0) {
+    return tt_platform_futex_wake(word, TT_PLATFORM_WAKE_ALL);
+  }
+#else
+  (void)waiters;
+#endif
+  return TT_SUCCESS;
+}
+
+tt_error_t tt_barrier_init(tt_barrier_t *barrier, uint32_t count) {
+  if (barrier == NULL) {
+    return TT_ERROR_NULL_POINTER;
+  }
+
+  if (count == 0) {
+    return TT_ERROR_INVALID_PARAM;
+  }
+
+  barrier->arrived = 0;
+  barrier->generation = 0;
+  barrier->waiters = 0;
+  barrier->count = count;
+  barrier->initialized = true;
+  return TT_SUCCESS;
+}
+
+tt_error_t tt_barrier_destroy(tt_barrier_t *barrier) {
+  if (barrier == NULL) {
+    return TT_ERROR_NULL_POINTER;
+  }
+
+  if (!barrier->initialized) {
+    return TT_ERROR_NOT_INITIALIZED;
+  }
+
+  if (__atomic_load_n(&barrier->arrived, __ATOMIC_ACQUIRE) > 0 ||
+      __atomic_load_n(&barrier->waiters, __ATOMIC_ACQUIRE) > 0) {
+    return TT_ERROR_BUSY;
+  }
+
+  barrier->initialized = false;
+  return TT_SUCCESS;
+}
+
+tt_error_t tt_barrier_wait(tt_barrier_t *barrier, bool *is_last) {
+  if (barrier == NULL) {
+    return TT_ERROR_NULL_POINTER;
+  }
+
+  if (!barrier->initialized) {
+    return TT_ERROR_NOT_INITIALIZED;
+  }
+
+  // Read the generation before arriving, it cannot move until we have
+  uint32_t generation = __atomic_load_n(&barrier->generation, __ATOMIC_ACQUIRE);
+  uint32_t arrived = __atomic_add_fetch(&barrier->arrived, 1, __ATOMIC_ACQ_REL);
+
+  if (is_last != NULL) {
+    *is_last = (arrived == barrier->count);
+  }
+
+  if (arrived == barrier->count) {
+    // Nobody arrives for the next round until the generation moves
+    __atomic_store_n(&barrier->arrived, 0, __ATOMIC_RELAXED);
+    return word_release(&barrier->generation, generation + 1,
+                        &barrier->waiters);
+  }
+
+  return word_wait(&barrier->generation, generation, &barrier->waiters,
+                   TT_PLATFORM_WAIT_FOREVER);
+}
+
+tt_error_t tt_latch_init(tt_latch_t *latch, uint32_t count) {
+  if (latch == NULL) {
+    return TT_ERROR_NULL_POINTER;
+  }
+
+  latch->count = count;
+  latch->waiters = 0;
+  latch->initialized = true;
+  return TT_SUCCESS;
+}
+
+tt_error_t tt_latch_destroy(tt_latch_t *latch) {
+  if (latch == NULL) {
+    return TT_ERROR_NULL_POINTER;
+  }
+
+  if (!latch->initialized) {
+    return TT_ERROR_NOT_INITIALIZED;
+  }
+
+  if (__atomic_load_n(&latch->waiters, __ATOMIC_ACQUIRE) > 0) {
+    return TT_ERROR_BUSY;
+  }
+
+  latch->initialized = false;
+  return TT_SUCCESS;
+}
+
+tt_error_t tt_latch_count_down(tt_latch_t *latch, uint32_t n) {
+  if (latch == NULL) {
+    return TT_ERROR_NULL_POINTER;
+  }
+
+  if (!latch->initialized) {
+    return TT_ERROR_NOT_INITIALIZED;
+  }
+
+  uint32_t count = __atomic_load_n(&latch->count, __ATOMIC_RELAXED);
+  do {
+    if (n > count) {
+      return TT_ERROR_INVALID_PARAM;
+    }
+  } while (!__atomic_compare_exchange_n(&latch->count, &count, count - n, true,
+                                        __ATOMIC_ACQ_REL, __ATOMIC_RELAXED));
+
+  if (count == n && n > 0) {
+    return word_release(&latch->count, 0, &latch->waiters);
+  }
+
+  return TT_SUCCESS;
+}
+
+static tt_error_t latch_wait_until(tt_latch_t *latch, uint64_t deadline_ns) {
+  uint32_t count;
+
+  while ((count = __atomic_load_n(&latch->count, __ATOMIC_ACQUIRE)) > 0) {
+    tt_error_t result =
+        word_wait(&latch->count, count, &latch->waiters, deadline_ns);
+    if (result != TT_SUCCESS) {
+      return result;
+    }
+  }
+
+  return TT_SUCCESS;
+}
+
+tt_error_t tt_latch_wait(tt_latch_t *latch) {
+  if (latch == NULL) {
+    return TT_ERROR_NULL_POINTER;
+  }
+
+  if (!latch->initialized) {
+    return TT_ERROR_NOT_INITIALIZED;
+  }
+
+  return latch_wait_until(latch, TT_PLATFORM_WAIT_FOREVER);
+}
+
+tt_error_t tt_latch_timedwait(tt_latch_t *latch, uint32_t timeout_ms) {
+  if (latch == NULL) {
+    return TT_ERROR_NULL_POINTER;
+  }
+
+  if (!latch->initialized) {
+    return TT_ERROR_NOT_INITIALIZED;
+  }
+
+  if (__atomic_load_n(&latch->count, __ATOMIC_ACQUIRE) == 0) {
+    return TT_SUCCESS;
+  }
+
+  uint64_t deadline_ns =
+      tt_platform_time_monotonic_ns() + (uint64_t)timeout_ms * 1000000ULL;
+  return latch_wait_until(latch, deadline_ns);
+}
+
+tt_error_t tt_latch_try_wait(tt_latch_t *latch) {
+  if (latch == NULL) {
+    return TT_ERROR_NULL_POINTER;
+  }
+
+  if (!latch->initialized) {
+    return TT_ERROR_NOT_INITIALIZED;
+  }
+
+  return (__atomic_load_n(&latch->count, __ATOMIC_ACQUIRE) == 0)
+             ? TT_SUCCESS
+             : TT_ERROR_BUSY;
+}
+
+tt_error_t tt_latch_arrive_and_wait(tt_latch_t *latch) {
+  tt_error_t result = tt_latch_count_down(latch, 1);
+  if (result != TT_SUCCESS) {
+    return result;
+  }
+
+  return latch_wait_until(latch, TT_PLATFORM_WAIT_FOREVER);
+}
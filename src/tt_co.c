@@ -0,0 +1,105 @@
+/**
+ * @file tt_co.c
+ * @author Mihai Gurei <mihai.gurei@protonmail.com>
+ * @date 2025-02-12
+ * @brief
+ * @copyright Copyright (c) 2025 AnAlphaBeta. All rights reserved.
+ */
+
+#include "tt_co.h"
+
+tt_error_t tt_co_sched_init(tt_co_sched_t *sched) {
+  if (sched == NULL) {
+    return TT_ERROR_NULL_POINTER;
+  }
+
+  sched->head = NULL;
+  sched->tail = NULL;
+  sched->count = 0;
+  return TT_SUCCESS;
+}
+
+tt_error_t tt_co_spawn(tt_co_sched_t *sched, tt_co_task_t *task,
+                       tt_co_func_t func, void *arg) {
+  if (sched == NULL || task == NULL || func == NULL) {
+    return TT_ERROR_NULL_POINTER;
+  }
+
+  TT_CO_INIT(&task->co);
+  task->func = func;
+  task->arg = arg;
+  task->next = NULL;
+  if (sched->tail != NULL) {
+    sched->tail->next = task;
+  } else {
+    sched->head = task;
+  }
+  sched->tail = task;
+  sched->count++;
+  return TT_SUCCESS;
+}
+
+tt_error_t tt_co_sched_step(tt_co_sched_t *sched, bool *progress) {
+  if (sched == NULL) {
+    return TT_ERROR_NULL_POINTER;
+  }
+
+  // Spawns append behind last, they wait for the next pass
+  tt_co_task_t *last = sched->tail;
+  tt_co_task_t *prev = NULL;
+  tt_co_task_t *task = sched->head;
+  bool moved = false;
+
+  while (task != NULL) {
+    tt_co_task_t *next = task->next;
+    bool stop = (task == last);
+    tt_co_state_t state = task->func(&task->co, task->arg);
+
+    if (state != TT_CO_WAITING) {
+      moved = true;
+    }
+    if (state == TT_CO_ENDED || state == TT_CO_EXITED) {
+      // Re-read the link: a spawn from the last task sets it
+      next = task->next;
+      if (prev != NULL) {
+        prev->next = next;
+      } else {
+        sched->head = next;
+      }
+      if (sched->tail == task) {
+        sched->tail = prev;
+      }
+      sched->count--;
+    } else {
+      prev = task;
+    }
+
+    if (stop) {
+      break;
+    }
+    task = next;
+  }
+
+  if (progress != NULL) {
+    *progress = moved;
+  }
+  return TT_SUCCESS;
+}
+
+tt_error_t tt_co_sched_run(tt_co_sched_t *sched) {
+  if (sched == NULL) {
+    return TT_ERROR_NULL_POINTER;
+  }
+
+  while (sched->count > 0) {
+    tt_error_t result = tt_co_sched_step(sched, NULL);
+    if (result != TT_SUCCESS) {
+      return result;
+    }
+  }
+  return TT_SUCCESS;
+}
+
+size_t tt_co_sched_count(const tt_co_sched_t *sched) {
+  return sched ? sched->count : 0;
+}
@@ -6,96 +6,493 @@
  */
 
 #include "tt_error.h"
+#include "tt_sem.h"
 #include "tt_types.h"
 #include <stddef.h>
+#include <stdio.h>
+#include <string.h>
 
-static tt_error_context_t error_ctx = {
-    .last_error = TT_SUCCESS, .callback = NULL, .initialized = false};
+#if defined(TT_TARGET_FREERTOS)
+#include "FreeRTOS.h"
+#include "task.h"
+#endif
 
-tt_error_t tt_error_init(void) {
-  if (error_ctx.initialized) {
+/**
+ * @brief Error state private to each thread
+ */
+typedef struct {
+  tt_error_t last_error; /**< Last error reported by this thread*/
+  uint32_t ring_head;    /**< Total records written*/
+  tt_error_record_t ring[TT_ERROR_RING_SIZE]; /**< Recent raised errors*/
+} tt_error_thread_state_t;
+
+#if (TT_ERROR_RING_SIZE & (TT_ERROR_RING_SIZE - 1)) != 0
+#error "TT_ERROR_RING_SIZE must be a power of two"
+#endif
+
+#if (TT_ERROR_QUEUE_SIZE & (TT_ERROR_QUEUE_SIZE - 1)) != 0
+#error "TT_ERROR_QUEUE_SIZE must be a power of two"
+#endif
+
+static tt_error_context_t error_ctx = {.callbacks = {NULL},
+                                       .once = TT_ONCE_INIT};
+
+#if defined(TT_TARGET_FREERTOS)
+/* Shared by tasks whose state could not be allocated */
+static tt_error_thread_state_t error_fallback_state;
+
+static tt_error_thread_state_t *error_thread_state(void) {
+  tt_error_thread_state_t *state =
+      pvTaskGetThreadLocalStoragePointer(NULL, TT_ERROR_TLS_INDEX);
+  if (state == NULL) {
+    // First error of this task, freed by the TLS deletion callback if the
+    // port enables configTHREAD_LOCAL_STORAGE_DELETE_CALLBACKS
+    state = pvPortMalloc(sizeof(*state));
+    if (state == NULL) {
+      return &error_fallback_state;
+    }
+    memset(state, 0, sizeof(*state));
+    vTaskSetThreadLocalStoragePointer(NULL, TT_ERROR_TLS_INDEX, state);
+  }
+  return state;
+}
+#else
+#if defined(TT_CAP_THREADS)
+static _Thread_local tt_error_thread_state_t error_state;
+#else
+static tt_error_thread_state_t error_state;
+#endif
+
+static inline tt_error_thread_state_t *error_thread_state(void) {
+  return &error_state;
+}
+#endif /* TT_TARGET_FREERTOS */
+
+#if !defined(TT_ERROR_NO_STATS)
+/**
+ * @brief Per-code counters, one cache line each so that reporters of
+ * different codes do not contend
+ */
+typedef struct {
+  volatile uint64_t count;
+  volatile uint64_t first_seen_ns;
+  volatile uint64_t last_seen_ns;
+} __attribute__((aligned(64))) tt_error_counter_t;
+
+static tt_error_counter_t error_counters[TT_ERROR_CODE_COUNT];
+
+/* Retries before a snapshot entry is taken as is under a report storm */
+#define TT_ERROR_STATS_RETRIES 8
+
+static void error_stats_record(tt_error_t error, uint64_t now_ns) {
+  if ((unsigned)error >= TT_ERROR_CODE_COUNT) {
+    error = TT_ERROR_UNKNOWN;
+  }
+
+  tt_error_counter_t *counter = &error_counters[error];
+  // Set once: a plain load keeps later reports off the locked CAS
+  uint64_t unseen = 0;
+  if (__atomic_load_n(&counter->first_seen_ns, __ATOMIC_RELAXED) == 0) {
+    __atomic_compare_exchange_n(&counter->first_seen_ns, &unseen, now_ns,
+                                false, __ATOMIC_RELAXED, __ATOMIC_RELAXED);
+  }
+  __atomic_store_n(&counter->last_seen_ns, now_ns, __ATOMIC_RELAXED);
+  // Release: a reader that sees this count also sees the timestamps above
+  __atomic_fetch_add(&counter->count, 1, __ATOMIC_RELEASE);
+}
+
+size_t tt_error_stats_snapshot(tt_error_stats_t *stats, size_t max) {
+  if (stats == NULL) {
+    return 0;
+  }
+
+  size_t count = (max < TT_ERROR_CODE_COUNT) ? max : TT_ERROR_CODE_COUNT;
+  for (size_t i = 0; i < count; i++) {
+    tt_error_counter_t *counter = &error_counters[i];
+    tt_error_stats_t *out = &stats[i];
+
+    // Re-read until no report landed while copying the entry
+    uint64_t before = __atomic_load_n(&counter->count, __ATOMIC_ACQUIRE);
+    for (int retry = 0; retry < TT_ERROR_STATS_RETRIES; retry++) {
+      out->first_seen_ns =
+          __atomic_load_n(&counter->first_seen_ns, __ATOMIC_RELAXED);
+      out->last_seen_ns =
+          __atomic_load_n(&counter->last_seen_ns, __ATOMIC_RELAXED);
+      __atomic_thread_fence(__ATOMIC_ACQUIRE);
+      uint64_t after = __atomic_load_n(&counter->count, __ATOMIC_RELAXED);
+      if (after == before) {
+        break;
+      }
+      before = after;
+    }
+    out->code = (tt_error_t)i;
+    out->count = before;
+  }
+
+  return count;
+}
+
+void tt_error_stats_reset(void) {
+  for (size_t i = 0; i < TT_ERROR_CODE_COUNT; i++) {
+    __atomic_store_n(&error_counters[i].count, 0, __ATOMIC_RELAXED);
+    __atomic_store_n(&error_counters[i].first_seen_ns, 0, __ATOMIC_RELAXED);
+    __atomic_store_n(&error_counters[i].last_seen_ns, 0, __ATOMIC_RELAXED);
+  }
+}
+#endif /* TT_ERROR_NO_STATS */
+
+/**
+ * @brief Delivery limiter of one error code
+ *
+ * The token bucket is kept as the theoretical arrival time of the next
+ * conforming report (GCRA), so that admitting a report is a single CAS.
+ */
+typedef struct {
+  volatile uint64_t interval_ns;       /**< Token refill period, 0 if off*/
+  volatile uint64_t tolerance_ns;      /**< (burst - 1) * interval_ns*/
+  volatile uint64_t tat_ns;            /**< Theoretical arrival time*/
+  volatile uint64_t window_ns;         /**< Dedup window, 0 if off*/
+  volatile uint64_t last_delivered_ns; /**< Time of the last delivery*/
+  volatile uint32_t suppressed;        /**< Suppressed since last delivery*/
+} __attribute__((aligned(64))) tt_error_limiter_t;
+
+static tt_error_limiter_t error_limiters[TT_ERROR_CODE_COUNT];
+
+static inline size_t error_code_index(tt_error_t error) {
+  return ((unsigned)error < TT_ERROR_CODE_COUNT) ? (size_t)error
+                                                 : (size_t)TT_ERROR_UNKNOWN;
+}
+
+/* Decide whether a report reaches the callbacks, lock-free */
+static bool error_limiter_admit(tt_error_t error, uint64_t now_ns,
+                                uint32_t *repeats) {
+  tt_error_limiter_t *limiter = &error_limiters[error_code_index(error)];
+
+  uint64_t window_ns = __atomic_load_n(&limiter->window_ns, __ATOMIC_RELAXED);
+  uint64_t last = 0;
+  if (window_ns != 0) {
+    last = __atomic_load_n(&limiter->last_delivered_ns, __ATOMIC_RELAXED);
+    // Losing the CAS means another thread delivered this code just now
+    if ((last != 0 && now_ns - last < window_ns) ||
+        !__atomic_compare_exchange_n(&limiter->last_delivered_ns, &last,
+                                     now_ns, false, __ATOMIC_RELAXED,
+                                     __ATOMIC_RELAXED)) {
+      goto suppress;
+    }
+  }
+
+  uint64_t interval_ns =
+      __atomic_load_n(&limiter->interval_ns, __ATOMIC_RELAXED);
+  if (interval_ns != 0) {
+    uint64_t tolerance_ns =
+        __atomic_load_n(&limiter->tolerance_ns, __ATOMIC_RELAXED);
+    uint64_t tat = __atomic_load_n(&limiter->tat_ns, __ATOMIC_RELAXED);
+    uint64_t next;
+    do {
+      uint64_t base = (tat > now_ns) ? tat : now_ns;
+      if (base - now_ns > tolerance_ns) {
+        goto unstamp; // Bucket empty
+      }
+      next = base + interval_ns;
+    } while (!__atomic_compare_exchange_n(&limiter->tat_ns, &tat, next, true,
+                                          __ATOMIC_RELAXED,
+                                          __ATOMIC_RELAXED));
+  }
+
+  // Only pay for the exchange when something was suppressed
+  *repeats = 0;
+  if (__atomic_load_n(&limiter->suppressed, __ATOMIC_RELAXED) != 0) {
+    *repeats = __atomic_exchange_n(&limiter->suppressed, 0, __ATOMIC_RELAXED);
+  }
+  return true;
+
+unstamp:
+  // Nothing was delivered, so the dedup window must not restart. A failed
+  // CAS means another report already stamped the code over ours.
+  if (window_ns != 0) {
+    __atomic_compare_exchange_n(&limiter->last_delivered_ns, &now_ns, last,
+                                false, __ATOMIC_RELAXED, __ATOMIC_RELAXED);
+  }
+suppress:
+  __atomic_fetch_add(&limiter->suppressed, 1, __ATOMIC_RELAXED);
+  return false;
+}
+
+static tt_error_t error_limiter_codes(tt_error_t code, size_t *first,
+                                      size_t *last) {
+  if (code == TT_ERROR_ALL_CODES) {
+    *first = 0;
+    *last = TT_ERROR_CODE_COUNT;
     return TT_SUCCESS;
   }
+  if ((unsigned)code >= TT_ERROR_CODE_COUNT) {
+    return TT_ERROR_INVALID_PARAM;
+  }
+  *first = (size_t)code;
+  *last = (size_t)code + 1;
+  return TT_SUCCESS;
+}
 
-  tt_error_t result = tt_mutex_init(&error_ctx.mutex);
-  if (result != TT_SUCCESS) {
-    return result;
+tt_error_t tt_error_set_rate_limit(tt_error_t code, uint32_t per_second,
+                                   uint32_t burst) {
+  size_t first, last;
+  if (error_limiter_codes(code, &first, &last) != TT_SUCCESS) {
+    return TT_ERROR_INVALID_PARAM;
   }
 
-  error_ctx.last_error = TT_SUCCESS;
-  error_ctx.callback = NULL;
-  error_ctx.initialized = true;
+  uint64_t interval_ns = (per_second != 0) ? 1000000000ULL / per_second : 0;
+  uint64_t tolerance_ns = (burst > 1) ? (uint64_t)(burst - 1) * interval_ns : 0;
+  for (size_t i = first; i < last; i++) {
+    __atomic_store_n(&error_limiters[i].interval_ns, 0, __ATOMIC_RELAXED);
+    __atomic_store_n(&error_limiters[i].tolerance_ns, tolerance_ns,
+                     __ATOMIC_RELAXED);
+    __atomic_store_n(&error_limiters[i].tat_ns, 0, __ATOMIC_RELAXED);
+    __atomic_store_n(&error_limiters[i].interval_ns, interval_ns,
+                     __ATOMIC_RELAXED);
+  }
+  return TT_SUCCESS;
+}
+
+tt_error_t tt_error_set_dedup_window(tt_error_t code, uint32_t window_ms) {
+  size_t first, last;
+  if (error_limiter_codes(code, &first, &last) != TT_SUCCESS) {
+    return TT_ERROR_INVALID_PARAM;
+  }
 
+  for (size_t i = first; i < last; i++) {
+    __atomic_store_n(&error_limiters[i].last_delivered_ns, 0,
+                     __ATOMIC_RELAXED);
+    __atomic_store_n(&error_limiters[i].window_ns,
+                     (uint64_t)window_ms * 1000000ULL, __ATOMIC_RELAXED);
+  }
   return TT_SUCCESS;
 }
 
-tt_error_t tt_error_deinit(void) {
-  if (!error_ctx.initialized) {
-    return TT_ERROR_NOT_INITIALIZED;
+static void error_deliver(const tt_error_event_t *event) {
+  for (size_t i = 0; i < TT_ERROR_MAX_CALLBACKS; i++) {
+    tt_error_callback_t callback =
+        __atomic_load_n(&error_ctx.callbacks[i], __ATOMIC_ACQUIRE);
+    if (callback != NULL) {
+      callback(event->code);
+    }
   }
 
-  tt_error_t result = tt_mutex_lock(&error_ctx.mutex);
-  if (result != TT_SUCCESS) {
-    return result;
+  for (size_t i = 0; i < TT_ERROR_MAX_CALLBACKS; i++) {
+    tt_error_event_callback_t callback =
+        __atomic_load_n(&error_ctx.event_callbacks[i], __ATOMIC_ACQUIRE);
+    if (callback != NULL) {
+      callback(event);
+    }
   }
+}
 
-  error_ctx.callback = NULL;
-  error_ctx.initialized = false;
+#if defined(TT_CAP_THREADS)
+/**
+ * @brief Queue slot, seq tells whose turn it is
+ */
+typedef struct {
+  volatile uint32_t seq;  /**< pos when free for pos, pos + 1 once filled*/
+  tt_error_event_t event; /**< Queued error*/
+} tt_error_queue_slot_t;
 
-  result = tt_mutex_unlock(&error_ctx.mutex);
+/*
+ * Bounded multi-producer single-consumer queue. Producers claim a position
+ * with a CAS on head and publish the slot through its sequence number, so
+ * reporting threads never block each other or the dispatcher.
+ */
+static struct {
+  tt_error_queue_slot_t slots[TT_ERROR_QUEUE_SIZE];
+  volatile uint32_t head; /**< Next position to fill*/
+  uint32_t tail;          /**< Next position to drain, dispatcher only*/
+  volatile uint32_t dropped;
+  volatile uint32_t producers; /**< Reporters between check and push*/
+  tt_sem_t items;
+  tt_thread_t *thread;
+  volatile bool running;
+  volatile bool stopping;
+} error_dispatch;
+
+static void error_queue_reset(void) {
+  for (uint32_t i = 0; i < TT_ERROR_QUEUE_SIZE; i++) {
+    error_dispatch.slots[i].seq = i;
+  }
+  error_dispatch.head = 0;
+  error_dispatch.tail = 0;
+  error_dispatch.dropped = 0;
+  error_dispatch.producers = 0;
+}
+
+static bool error_queue_push(const tt_error_event_t *event) {
+  uint32_t pos = __atomic_load_n(&error_dispatch.head, __ATOMIC_RELAXED);
+  tt_error_queue_slot_t *slot;
+
+  for (;;) {
+    slot = &error_dispatch.slots[pos & (TT_ERROR_QUEUE_SIZE - 1)];
+    uint32_t seq = __atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE);
+    int32_t diff = (int32_t)(seq - pos);
+    if (diff == 0) {
+      if (__atomic_compare_exchange_n(&error_dispatch.head, &pos, pos + 1,
+                                      true, __ATOMIC_RELAXED,
+                                      __ATOMIC_RELAXED)) {
+        break;
+      }
+    } else if (diff < 0) {
+      // Slot still holds an entry from the previous lap: full
+      return false;
+    } else {
+      pos = __atomic_load_n(&error_dispatch.head, __ATOMIC_RELAXED);
+    }
+  }
+
+  slot->event = *event;
+  __atomic_store_n(&slot->seq, pos + 1, __ATOMIC_RELEASE);
+  return true;
+}
+
+static bool error_queue_pop(tt_error_event_t *event) {
+  uint32_t pos = error_dispatch.tail;
+  tt_error_queue_slot_t *slot =
+      &error_dispatch.slots[pos & (TT_ERROR_QUEUE_SIZE - 1)];
+
+  if (__atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE) != pos + 1) {
+    return false;
+  }
+
+  *event = slot->event;
+  __atomic_store_n(&slot->seq, pos + TT_ERROR_QUEUE_SIZE, __ATOMIC_RELEASE);
+  error_dispatch.tail = pos + 1;
+  return true;
+}
+
+static void *error_dispatch_thread(void *arg) {
+  (void)arg;
+  tt_error_event_t event;
+
+  for (;;) {
+    tt_sem_wait(&error_dispatch.items);
+    // Drain everything: a post can arrive before an earlier claimed slot is
+    // published, the post of that slot then picks up both
+    while (error_queue_pop(&event)) {
+      error_deliver(&event);
+    }
+    if (__atomic_load_n(&error_dispatch.stopping, __ATOMIC_ACQUIRE) &&
+        error_dispatch.tail ==
+            __atomic_load_n(&error_dispatch.head, __ATOMIC_ACQUIRE)) {
+      break;
+    }
+  }
+
+  return NULL;
+}
+#endif /* TT_CAP_THREADS */
+
+static tt_error_t error_init_once(void) {
+  tt_error_t result = tt_mutex_init_named(&error_ctx.mutex, "tt_error");
   if (result != TT_SUCCESS) {
     return result;
   }
 
+  for (size_t i = 0; i < TT_ERROR_MAX_CALLBACKS; i++) {
+    __atomic_store_n(&error_ctx.callbacks[i], NULL, __ATOMIC_RELAXED);
+    __atomic_store_n(&error_ctx.event_callbacks[i], NULL, __ATOMIC_RELAXED);
+  }
+  memset(error_limiters, 0, sizeof(error_limiters));
+  error_thread_state()->last_error = TT_SUCCESS;
+
   return TT_SUCCESS;
 }
 
-tt_error_t tt_error_get_last(void) {
-  if (!error_ctx.initialized) {
+tt_error_t tt_error_init(void) {
+  return tt_call_once(&error_ctx.once, error_init_once);
+}
+
+tt_error_t tt_error_deinit(void) {
+  if (!tt_once_is_done(&error_ctx.once)) {
     return TT_ERROR_NOT_INITIALIZED;
   }
 
-  tt_error_t error;
+#if defined(TT_CAP_THREADS)
+  if (__atomic_load_n(&error_dispatch.running, __ATOMIC_ACQUIRE)) {
+    tt_error_dispatch_stop();
+  }
+#endif
+
   tt_error_t result = tt_mutex_lock(&error_ctx.mutex);
   if (result != TT_SUCCESS) {
     return result;
   }
 
-  error = error_ctx.last_error;
+  for (size_t i = 0; i < TT_ERROR_MAX_CALLBACKS; i++) {
+    __atomic_store_n(&error_ctx.callbacks[i], NULL, __ATOMIC_RELEASE);
+    __atomic_store_n(&error_ctx.event_callbacks[i], NULL, __ATOMIC_RELEASE);
+  }
+  tt_once_reset(&error_ctx.once);
 
   result = tt_mutex_unlock(&error_ctx.mutex);
   if (result != TT_SUCCESS) {
     return result;
   }
 
-  return error;
+  // The next tt_error_init creates a fresh one
+  return tt_mutex_destroy(&error_ctx.mutex);
 }
 
-tt_error_t tt_error_set_last(tt_error_t error) {
-  if (!error_ctx.initialized) {
+tt_error_t tt_error_get_last(void) {
+  if (!tt_once_is_done(&error_ctx.once)) {
     return TT_ERROR_NOT_INITIALIZED;
   }
 
-  tt_error_t result = tt_mutex_lock(&error_ctx.mutex);
-  if (result != TT_SUCCESS) {
-    return result;
+  return error_thread_state()->last_error;
+}
+
+/* now_ns is the time of the report when the caller already has it, or 0 */
+static tt_error_t error_set_last_at(tt_error_t error, uint64_t now_ns) {
+  if (!tt_once_is_done(&error_ctx.once)) {
+    return TT_ERROR_NOT_INITIALIZED;
   }
 
-  error_ctx.last_error = error;
-  void (*callback)(tt_error_t) = error_ctx.callback;
+  error_thread_state()->last_error = error;
+  if (error == TT_SUCCESS) {
+    return TT_SUCCESS;
+  }
 
-  result = tt_mutex_unlock(&error_ctx.mutex);
-  if (result != TT_SUCCESS) {
-    return result;
+  if (now_ns == 0) {
+    now_ns = tt_platform_time_monotonic_ns();
+  }
+#if !defined(TT_ERROR_NO_STATS)
+  error_stats_record(error, now_ns);
+#endif
+
+  tt_error_event_t event = {.code = error, .timestamp_ns = now_ns};
+  if (!error_limiter_admit(error, now_ns, &event.repeats)) {
+    return TT_SUCCESS;
   }
 
-  if (callback != NULL && error != TT_SUCCESS) {
-    callback(error);
+#if defined(TT_CAP_THREADS)
+  if (__atomic_load_n(&error_dispatch.running, __ATOMIC_RELAXED)) {
+    // Pairs with tt_error_dispatch_stop: it waits for us once running drops
+    __atomic_fetch_add(&error_dispatch.producers, 1, __ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&error_dispatch.running, __ATOMIC_SEQ_CST)) {
+      if (error_queue_push(&event)) {
+        tt_sem_post(&error_dispatch.items);
+      } else {
+        __atomic_fetch_add(&error_dispatch.dropped, 1, __ATOMIC_RELAXED);
+      }
+      __atomic_fetch_sub(&error_dispatch.producers, 1, __ATOMIC_RELEASE);
+      return TT_SUCCESS;
+    }
+    __atomic_fetch_sub(&error_dispatch.producers, 1, __ATOMIC_RELEASE);
   }
+#endif
 
+  error_deliver(&event);
   return TT_SUCCESS;
 }
 
+tt_error_t tt_error_set_last(tt_error_t error) {
+  return error_set_last_at(error, 0);
+}
+
 const char *tt_error_to_string(tt_error_t error) {
   switch (error) {
   case TT_SUCCESS:
@@ -159,7 +556,7 @@ bool tt_error_is_success(void) { return tt_error_get_last() == TT_SUCCESS; }
 tt_error_t tt_error_clear(void) { return tt_error_set_last(TT_SUCCESS); }
 
 tt_error_t tt_error_register_callback(void (*callback)(tt_error_t)) {
-  if (!error_ctx.initialized) {
+  if (!tt_once_is_done(&error_ctx.once)) {
     return TT_ERROR_NOT_INITIALIZED;
   }
 
@@ -168,7 +565,13 @@ tt_error_t tt_error_register_callback(void (*callback)(tt_error_t)) {
     return result;
   }
 
-  error_ctx.callback = callback;
+  __atomic_store_n(&error_ctx.callbacks[0], callback, __ATOMIC_RELEASE);
+  for (size_t i = 1; i < TT_ERROR_MAX_CALLBACKS; i++) {
+    __atomic_store_n(&error_ctx.callbacks[i], NULL, __ATOMIC_RELEASE);
+  }
+  for (size_t i = 0; i < TT_ERROR_MAX_CALLBACKS; i++) {
+    __atomic_store_n(&error_ctx.event_callbacks[i], NULL, __ATOMIC_RELEASE);
+  }
 
   result = tt_mutex_unlock(&error_ctx.mutex);
   if (result != TT_SUCCESS) {
@@ -177,3 +580,253 @@ tt_error_t tt_error_register_callback(void (*callback)(tt_error_t)) {
 
   return TT_SUCCESS;
 }
+
+tt_error_t tt_error_add_callback(tt_error_callback_t callback) {
+  if (callback == NULL) {
+    return TT_ERROR_NULL_POINTER;
+  }
+
+  if (!tt_once_is_done(&error_ctx.once)) {
+    return TT_ERROR_NOT_INITIALIZED;
+  }
+
+  tt_error_t result = tt_mutex_lock(&error_ctx.mutex);
+  if (result != TT_SUCCESS) {
+    return result;
+  }
+
+  result = TT_ERROR_BUFFER_FULL;
+  for (size_t i = 0; i < TT_ERROR_MAX_CALLBACKS; i++) {
+    if (error_ctx.callbacks[i] == NULL) {
+      __atomic_store_n(&error_ctx.callbacks[i], callback, __ATOMIC_RELEASE);
+      result = TT_SUCCESS;
+      break;
+    }
+  }
+
+  tt_mutex_unlock(&error_ctx.mutex);
+  return result;
+}
+
+tt_error_t tt_error_remove_callback(tt_error_callback_t callback) {
+  if (callback == NULL) {
+    return TT_ERROR_NULL_POINTER;
+  }
+
+  if (!tt_once_is_done(&error_ctx.once)) {
+    return TT_ERROR_NOT_INITIALIZED;
+  }
+
+  tt_error_t result = tt_mutex_lock(&error_ctx.mutex);
+  if (result != TT_SUCCESS) {
+    return result;
+  }
+
+  result = TT_ERROR_NOT_FOUND;
+  for (size_t i = 0; i < TT_ERROR_MAX_CALLBACKS; i++) {
+    if (error_ctx.callbacks[i] == callback) {
+      __atomic_store_n(&error_ctx.callbacks[i], NULL, __ATOMIC_RELEASE);
+      result = TT_SUCCESS;
+      break;
+    }
+  }
+
+  tt_mutex_unlock(&error_ctx.mutex);
+  return result;
+}
+
+tt_error_t tt_error_add_event_callback(tt_error_event_callback_t callback) {
+  if (callback == NULL) {
+    return TT_ERROR_NULL_POINTER;
+  }
+
+  if (!tt_once_is_done(&error_ctx.once)) {
+    return TT_ERROR_NOT_INITIALIZED;
+  }
+
+  tt_error_t result = tt_mutex_lock(&error_ctx.mutex);
+  if (result != TT_SUCCESS) {
+    return result;
+  }
+
+  result = TT_ERROR_BUFFER_FULL;
+  for (size_t i = 0; i < TT_ERROR_MAX_CALLBACKS; i++) {
+    if (error_ctx.event_callbacks[i] == NULL) {
+      __atomic_store_n(&error_ctx.event_callbacks[i], callback,
+                       __ATOMIC_RELEASE);
+      result = TT_SUCCESS;
+      break;
+    }
+  }
+
+  tt_mutex_unlock(&error_ctx.mutex);
+  return result;
+}
+
+tt_error_t tt_error_remove_event_callback(
+    tt_error_event_callback_t callback) {
+  if (callback == NULL) {
+    return TT_ERROR_NULL_POINTER;
+  }
+
+  if (!tt_once_is_done(&error_ctx.once)) {
+    return TT_ERROR_NOT_INITIALIZED;
+  }
+
+  tt_error_t result = tt_mutex_lock(&error_ctx.mutex);
+  if (result != TT_SUCCESS) {
+    return result;
+  }
+
+  result = TT_ERROR_NOT_FOUND;
+  for (size_t i = 0; i < TT_ERROR_MAX_CALLBACKS; i++) {
+    if (error_ctx.event_callbacks[i] == callback) {
+      __atomic_store_n(&error_ctx.event_callbacks[i], NULL, __ATOMIC_RELEASE);
+      result = TT_SUCCESS;
+      break;
+    }
+  }
+
+  tt_mutex_unlock(&error_ctx.mutex);
+  return result;
+}
+
+#if defined(TT_CAP_THREADS)
+tt_error_t tt_error_dispatch_start(void) {
+  if (!tt_once_is_done(&error_ctx.once)) {
+    return TT_ERROR_NOT_INITIALIZED;
+  }
+
+  tt_error_t result = tt_mutex_lock(&error_ctx.mutex);
+  if (result != TT_SUCCESS) {
+    return result;
+  }
+
+  // A stop still joining the old dispatcher owns the queue and semaphore
+  if (error_dispatch.running || error_dispatch.stopping) {
+    tt_mutex_unlock(&error_ctx.mutex);
+    return TT_ERROR_ALREADY_INITIALIZED;
+  }
+
+  error_queue_reset();
+  error_dispatch.stopping = false;
+  result = tt_sem_init(&error_dispatch.items, 0);
+  if (result == TT_SUCCESS) {
+    result = tt_thread_init();
+  }
+  if (result == TT_SUCCESS) {
+    result = tt_thread_create(&error_dispatch.thread, NULL,
+                              error_dispatch_thread, NULL);
+  }
+  if (result == TT_SUCCESS) {
+    __atomic_store_n(&error_dispatch.running, true, __ATOMIC_RELEASE);
+  }
+
+  tt_mutex_unlock(&error_ctx.mutex);
+  return result;
+}
+
+tt_error_t tt_error_dispatch_stop(void) {
+  if (!tt_once_is_done(&error_ctx.once)) {
+    return TT_ERROR_NOT_INITIALIZED;
+  }
+
+  tt_error_t result = tt_mutex_lock(&error_ctx.mutex);
+  if (result != TT_SUCCESS) {
+    return result;
+  }
+
+  if (!error_dispatch.running) {
+    tt_mutex_unlock(&error_ctx.mutex);
+    return TT_ERROR_NOT_INITIALIZED;
+  }
+
+  // New errors go back to synchronous delivery. Let reporters already past
+  // the check finish their push, then have the dispatcher drain the queue.
+  __atomic_store_n(&error_dispatch.running, false, __ATOMIC_SEQ_CST);
+  while (__atomic_load_n(&error_dispatch.producers, __ATOMIC_ACQUIRE) > 0) {
+    tt_thread_sleep(0);
+  }
+  __atomic_store_n(&error_dispatch.stopping, true, __ATOMIC_RELEASE);
+  tt_sem_post(&error_dispatch.items);
+  tt_thread_t *thread = error_dispatch.thread;
+  error_dispatch.thread = NULL;
+  tt_mutex_unlock(&error_ctx.mutex);
+
+  // Joined unlocked: the callbacks being drained may add or remove callbacks
+  result = tt_thread_join(thread, NULL);
+  tt_thread_destroy(thread);
+  tt_sem_destroy(&error_dispatch.items);
+
+  tt_mutex_lock(&error_ctx.mutex);
+  __atomic_store_n(&error_dispatch.stopping, false, __ATOMIC_RELEASE);
+  tt_mutex_unlock(&error_ctx.mutex);
+  return result;
+}
+
+uint32_t tt_error_dispatch_dropped(void) {
+  return __atomic_load_n(&error_dispatch.dropped, __ATOMIC_RELAXED);
+}
+#else
+tt_error_t tt_error_dispatch_start(void) { return TT_ERROR_NOT_IMPLEMENTED; }
+
+tt_error_t tt_error_dispatch_stop(void) { return TT_ERROR_NOT_INITIALIZED; }
+
+uint32_t tt_error_dispatch_dropped(void) { return 0; }
+#endif /* TT_CAP_THREADS */
+
+tt_error_t tt_error_raise_at(tt_error_t code, const char *file, int line,
+                             const char *func) {
+  if (code == TT_SUCCESS) {
+    return code;
+  }
+
+  // Only the owning thread writes its ring, plain stores are enough
+  tt_error_thread_state_t *state = error_thread_state();
+  tt_error_record_t *record =
+      &state->ring[state->ring_head & (TT_ERROR_RING_SIZE - 1)];
+  record->code = code;
+  record->file = file;
+  record->func = func;
+  record->line = (uint32_t)line;
+  record->timestamp_ns = tt_platform_time_monotonic_ns();
+  state->ring_head++;
+
+  error_set_last_at(code, record->timestamp_ns);
+  return code;
+}
+
+size_t tt_error_recent(tt_error_record_t *records, size_t max) {
+  if (records == NULL) {
+    return 0;
+  }
+
+  tt_error_thread_state_t *state = error_thread_state();
+  uint32_t available = (state->ring_head < TT_ERROR_RING_SIZE)
+                           ? state->ring_head
+                           : TT_ERROR_RING_SIZE;
+  size_t count = (max < available) ? max : available;
+
+  for (size_t i = 0; i < count; i++) {
+    uint32_t index = (state->ring_head - 1 - (uint32_t)i);
+    records[i] = state->ring[index & (TT_ERROR_RING_SIZE - 1)];
+  }
+  return count;
+}
+
+void tt_error_dump_recent(void) {
+  tt_error_record_t records[TT_ERROR_RING_SIZE];
+  size_t count = tt_error_recent(records, TT_ERROR_RING_SIZE);
+
+  printf("Recent errors (%zu):\n", count);
+  for (size_t i = 0; i < count; i++) {
+    const tt_error_record_t *r = &records[i];
+    printf("  #%zu [%llu.%06llus] %s (%d) at %s:%u in %s()\n", i,
+           (unsigned long long)(r->timestamp_ns / 1000000000ULL),
+           (unsigned long long)(r->timestamp_ns % 1000000000ULL / 1000),
+           tt_error_to_string(r->code), (int)r->code, r->file,
+           (unsigned)r->line, r->func);
+  }
+}
+
+void tt_error_clear_recent(void) { error_thread_state()->ring_head = 0; }
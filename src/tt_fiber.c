@@ -0,0 +1,944 @@
+/**
+ * @file tt_fiber.c
+ * @author Mihai Gurei <mihai.gurei@protonmail.com>
+ * @date 2025-02-10
+ * @brief
+ * @copyright Copyright (c) 2025 AnAlphaBeta. All rights reserved.
+ */
+
+#define _GNU_SOURCE /* ucontext for the portable context switch */
+
+#include "tt_fiber.h"
+#include "tt_mutex.h"
+#include "tt_once.h"
+#include "tt_thread.h"
+#include "tt_types.h"
+#include <stdlib.h>
+
+#if defined(TT_CAP_THREADS)
+
+#if !defined(TT_FIBER_UCONTEXT) && defined(__ELF__) &&                        \
+    (defined(__x86_64__) || defined(__aarch64__))
+#define FIBER_ASM_SWITCH
+#else
+#include <ucontext.h>
+#endif
+
+/* tt_fiber_t.wait_state values */
+#define FIBER_RUNNING 0u
+#define FIBER_SLEEPING 1u
+#define FIBER_WAITING 2u
+#define FIBER_WOKEN 3u
+#define FIBER_TIMED_OUT 4u
+
+/* Set in tt_fiber_scheduler_t.live while tt_fiber_scheduler_destroy waits */
+#define FIBER_LIVE_WAITER 0x80000000u
+
+/**
+ * @brief Saved execution context
+ */
+typedef struct {
+#if defined(FIBER_ASM_SWITCH)
+  void *sp; /**< Callee-saved registers are pushed below this*/
+#else
+  ucontext_t uc;
+#endif
+} fiber_context_t;
+
+typedef struct fiber_worker_t fiber_worker_t;
+
+/**
+ * @brief Fiber, stored at the top of its own stack mapping
+ */
+struct tt_fiber_t {
+  fiber_context_t context;
+  tt_fiber_func_t func;
+  void *arg;
+  fiber_worker_t *worker;       /**< Worker the fiber runs on*/
+  struct tt_fiber_t *next;      /**< Ready list, inbox or pool link*/
+  struct tt_fiber_t *wait_prev; /**< Wait bucket links*/
+  struct tt_fiber_t *wait_next;
+  volatile uint32_t *wait_addr; /**< Word waited on in tt_fiber_wait*/
+  uint32_t wait_state;          /**< FIBER_* value*/
+  size_t timer_index;           /**< Slot in the worker's timers, or none*/
+  volatile uint32_t done;       /**< Set once finished, join wait word*/
+  volatile uint32_t refs;       /**< Running fiber plus join handle*/
+  bool finished;                /**< Function returned*/
+  void *stack;                  /**< Lowest usable stack address*/
+  size_t stack_size;
+};
+
+/* tt_fiber_t.timer_index of a fiber without a timer */
+#define FIBER_NO_TIMER SIZE_MAX
+
+/**
+ * @brief Sleep or wait deadline, in the heap only while its fiber is blocked
+ */
+typedef struct {
+  uint64_t deadline_ns;
+  tt_fiber_t *fiber;
+} fiber_timer_t;
+
+/**
+ * @brief Worker thread and the fibers it runs
+ *
+ * Everything but the inbox and the wait words is only touched by the worker
+ * itself and the fibers running on it.
+ */
+struct fiber_worker_t {
+  fiber_context_t context; /**< Scheduler loop*/
+  tt_fiber_scheduler_t *scheduler;
+  tt_thread_t *thread;
+  tt_fiber_t *current;     /**< Fiber running right now*/
+  tt_fiber_t *ready_head;  /**< Ready fibers, FIFO*/
+  tt_fiber_t *ready_tail;
+  fiber_timer_t *timers;   /**< Min-heap on deadline_ns*/
+  size_t timer_count;      /**< Also read by tt_fiber_scheduler_timers*/
+  size_t timer_capacity;
+  _Alignas(64) tt_fiber_t *volatile inbox; /**< Made ready by others, LIFO*/
+  volatile uint32_t signal;                /**< Idle wait word*/
+  volatile uint32_t sleeping;              /**< Parked on signal*/
+};
+
+struct tt_fiber_scheduler_t {
+  fiber_worker_t *workers;
+  size_t num_workers;
+  size_t stack_size;
+  volatile uint32_t next_worker; /**< Round robin spawn counter*/
+  volatile uint32_t live;        /**< Unfinished fibers plus waiter flag*/
+  volatile bool stop;
+  tt_mutex_t pool_lock;          /**< Guards pool*/
+  tt_fiber_t *pool;              /**< Finished fibers and their stacks*/
+};
+
+/**
+ * @brief Fibers blocked in tt_fiber_wait on words hashing here
+ */
+typedef struct {
+  _Alignas(64) tt_mutex_t lock;
+  tt_fiber_t *head;
+} fiber_bucket_t;
+
+static fiber_bucket_t fiber_buckets[TT_FIBER_WAIT_BUCKETS];
+static tt_once_t fiber_once = TT_ONCE_INIT;
+
+/* Plain threads blocked in tt_fiber_wait, tt_fiber_wake skips the syscall
+ * while there are none */
+static volatile uint32_t fiber_os_waiters;
+
+/* Worker running on the calling thread, NULL outside any fiber scheduler */
+static _Thread_local fiber_worker_t *current_worker;
+
+#if defined(FIBER_ASM_SWITCH)
+/*
+ * void tt_fiber_context_switch(void **save_sp, void *load_sp)
+ *
+ * Pushes the callee-saved registers, stores the stack pointer in *save_sp,
+ * switches to load_sp and pops the registers saved there. Everything else is
+ * caller-saved by the ABI, so the compiler has spilled it already. The
+ * floating point control state is not switched: fibers share their worker's.
+ */
+#if defined(__x86_64__)
+__asm__(".text\n"
+        ".p2align 4\n"
+        ".globl tt_fiber_context_switch\n"
+        ".hidden tt_fiber_context_switch\n"
+        ".type tt_fiber_context_switch, @function\n"
+        "tt_fiber_context_switch:\n"
+        "  pushq %rbp\n"
+        "  pushq %rbx\n"
+        "  pushq %r12\n"
+        "  pushq %r13\n"
+        "  pushq %r14\n"
+        "  pushq %r15\n"
+        "  movq %rsp, (%rdi)\n"
+        "  movq %rsi, %rsp\n"
+        "  popq %r15\n"
+        "  popq %r14\n"
+        "  popq %r13\n"
+        "  popq %r12\n"
+        "  popq %rbx\n"
+        "  popq %rbp\n"
+        "  ret\n"
+        ".size tt_fiber_context_switch, .-tt_fiber_context_switch\n");
+
+/* Saved registers, then the return address */
+#define FIBER_FRAME_WORDS 7
+#define FIBER_FRAME_RETURN 6
+
+#elif defined(__aarch64__)
+__asm__(".text\n"
+        ".p2align 4\n"
+        ".globl tt_fiber_context_switch\n"
+        ".hidden tt_fiber_context_switch\n"
+        ".type tt_fiber_context_switch, %function\n"
+        "tt_fiber_context_switch:\n"
+        "  sub sp, sp, #160\n"
+        "  stp x19, x20, [sp, #0]\n"
+        "  stp x21, x22, [sp, #16]\n"
+        "  stp x23, x24, [sp, #32]\n"
+        "  stp x25, x26, [sp, #48]\n"
+        "  stp x27, x28, [sp, #64]\n"
+        "  stp x29, x30, [sp, #80]\n"
+        "  stp d8, d9, [sp, #96]\n"
+        "  stp d10, d11, [sp, #112]\n"
+        "  stp d12, d13, [sp, #128]\n"
+        "  stp d14, d15, [sp, #144]\n"
+        "  mov x9, sp\n"
+        "  str x9, [x0]\n"
+        "  mov sp, x1\n"
+        "  ldp x19, x20, [sp, #0]\n"
+        "  ldp x21, x22, [sp, #16]\n"
+        "  ldp x23, x24, [sp, #32]\n"
+        "  ldp x25, x26, [sp, #48]\n"
+        "  ldp x27, x28, [sp, #64]\n"
+        "  ldp x29, x30, [sp, #80]\n"
+        "  ldp d8, d9, [sp, #96]\n"
+        "  ldp d10, d11, [sp, #112]\n"
+        "  ldp d12, d13, [sp, #128]\n"
+        "  ldp d14, d15, [sp, #144]\n"
+        "  add sp, sp, #160\n"
+        "  ret\n"
+        ".size tt_fiber_context_switch, .-tt_fiber_context_switch\n");
+
+/* 20 saved registers, x30 is the return address */
+#define FIBER_FRAME_WORDS 20
+#define FIBER_FRAME_RETURN 11
+#endif
+
+void tt_fiber_context_switch(void **save_sp, void *load_sp);
+#endif /* FIBER_ASM_SWITCH */
+
+static void fiber_entry(void);
+
+/* Prepare a context that starts in fiber_entry on the given stack */
+static void fiber_context_init(fiber_context_t *context, void *stack,
+                               uintptr_t top) {
+#if defined(FIBER_ASM_SWITCH)
+  (void)stack;
+  uintptr_t *frame = (uintptr_t *)(top & ~(uintptr_t)15);
+
+#if defined(__x86_64__)
+  // fiber_entry must see the stack as if it had been called: one fake
+  // return address above the one the switch returns through
+  *--frame = 0;
+#endif
+  frame -= FIBER_FRAME_WORDS;
+  for (int i = 0; i < FIBER_FRAME_WORDS; i++) {
+    frame[i] = 0;
+  }
+  frame[FIBER_FRAME_RETURN] = (uintptr_t)fiber_entry;
+  context->sp = frame;
+#else
+  getcontext(&context->uc);
+  context->uc.uc_stack.ss_sp = stack;
+  context->uc.uc_stack.ss_size = (size_t)(top - (uintptr_t)stack);
+  context->uc.uc_link = NULL;
+  makecontext(&context->uc, fiber_entry, 0);
+#endif
+}
+
+static inline void fiber_context_switch(fiber_context_t *from,
+                                        fiber_context_t *to) {
+#if defined(FIBER_ASM_SWITCH)
+  tt_fiber_context_switch(&from->sp, to->sp);
+#else
+  swapcontext(&from->uc, &to->uc);
+#endif
+}
+
+static tt_error_t fiber_init_once(void) {
+  for (size_t i = 0; i < TT_FIBER_WAIT_BUCKETS; i++) {
+    tt_error_t result =
+        tt_mutex_init_named(&fiber_buckets[i].lock, "tt_fiber_wait");
+    if (result != TT_SUCCESS) {
+      while (i-- > 0) {
+        tt_mutex_destroy(&fiber_buckets[i].lock);
+      }
+      return result;
+    }
+    fiber_buckets[i].head = NULL;
+  }
+  return TT_SUCCESS;
+}
+
+static fiber_bucket_t *fiber_bucket(volatile uint32_t *addr) {
+  uint64_t hash = (uint64_t)((uintptr_t)addr >> 2) * 0x9E3779B97F4A7C15ULL;
+  return &fiber_buckets[(hash >> 32) % TT_FIBER_WAIT_BUCKETS];
+}
+
+static void fiber_bucket_unlink(fiber_bucket_t *bucket, tt_fiber_t *fiber) {
+  if (fiber->wait_prev != NULL) {
+    fiber->wait_prev->wait_next = fiber->wait_next;
+  } else {
+    bucket->head = fiber->wait_next;
+  }
+  if (fiber->wait_next != NULL) {
+    fiber->wait_next->wait_prev = fiber->wait_prev;
+  }
+  fiber->wait_prev = NULL;
+  fiber->wait_next = NULL;
+}
+
+/* Queue a fiber on its worker; from another thread through the inbox */
+static void fiber_ready(tt_fiber_t *fiber) {
+  fiber_worker_t *worker = fiber->worker;
+
+  fiber->next = NULL;
+  if (worker == current_worker) {
+    if (worker->ready_tail != NULL) {
+      worker->ready_tail->next = fiber;
+    } else {
+      worker->ready_head = fiber;
+    }
+    worker->ready_tail = fiber;
+    return;
+  }
+
+  tt_fiber_t *head = __atomic_load_n(&worker->inbox, __ATOMIC_RELAXED);
+  do {
+    fiber->next = head;
+  } while (!__atomic_compare_exchange_n(&worker->inbox, &head, fiber, true,
+                                        __ATOMIC_SEQ_CST, __ATOMIC_RELAXED));
+
+  // Paired with the SEQ_CST sleeping store in fiber_worker_idle: either we
+  // see the worker parked, or it sees the fiber in its inbox
+  if (__atomic_load_n(&worker->sleeping, __ATOMIC_SEQ_CST)) {
+    __atomic_fetch_add(&worker->signal, 1, __ATOMIC_RELEASE);
+    tt_platform_futex_wake(&worker->signal, 1);
+  }
+}
+
+/* Switch from a fiber back to its worker's scheduler loop */
+static inline void fiber_suspend(tt_fiber_t *fiber) {
+  fiber_context_switch(&fiber->context, &fiber->worker->context);
+}
+
+static void fiber_timer_place(fiber_worker_t *worker, size_t i,
+                              fiber_timer_t timer) {
+  worker->timers[i] = timer;
+  timer.fiber->timer_index = i;
+}
+
+static void fiber_timer_sift_up(fiber_worker_t *worker, size_t i) {
+  fiber_timer_t timer = worker->timers[i];
+
+  while (i > 0) {
+    size_t parent = (i - 1) / 2;
+    if (worker->timers[parent].deadline_ns <= timer.deadline_ns) {
+      break;
+    }
+    fiber_timer_place(worker, i, worker->timers[parent]);
+    i = parent;
+  }
+  fiber_timer_place(worker, i, timer);
+}
+
+static void fiber_timer_sift_down(fiber_worker_t *worker, size_t i) {
+  fiber_timer_t timer = worker->timers[i];
+  size_t count = worker->timer_count;
+
+  for (;;) {
+    size_t child = 2 * i + 1;
+    if (child >= count) {
+      break;
+    }
+    if (child + 1 < count &&
+        worker->timers[child + 1].deadline_ns <
+            worker->timers[child].deadline_ns) {
+      child++;
+    }
+    if (timer.deadline_ns <= worker->timers[child].deadline_ns) {
+      break;
+    }
+    fiber_timer_place(worker, i, worker->timers[child]);
+    i = child;
+  }
+  fiber_timer_place(worker, i, timer);
+}
+
+static bool fiber_timer_push(fiber_worker_t *worker, uint64_t deadline_ns,
+                             tt_fiber_t *fiber) {
+  if (worker->timer_count == worker->timer_capacity) {
+    size_t capacity = worker->timer_capacity ? worker->timer_capacity * 2 : 64;
+    fiber_timer_t *timers =
+        realloc(worker->timers, capacity * sizeof(*timers));
+    if (timers == NULL) {
+      return false;
+    }
+    worker->timers = timers;
+    worker->timer_capacity = capacity;
+  }
+
+  size_t i = worker->timer_count;
+  __atomic_store_n(&worker->timer_count, i + 1, __ATOMIC_RELAXED);
+  worker->timers[i] = (fiber_timer_t){deadline_ns, fiber};
+  fiber_timer_sift_up(worker, i);
+  return true;
+}
+
+/* Take a fiber's timer out of the heap, if it still has one */
+static void fiber_timer_remove(fiber_worker_t *worker, tt_fiber_t *fiber) {
+  size_t i = fiber->timer_index;
+  if (i == FIBER_NO_TIMER) {
+    return;
+  }
+
+  fiber->timer_index = FIBER_NO_TIMER;
+  size_t last = worker->timer_count - 1;
+  __atomic_store_n(&worker->timer_count, last, __ATOMIC_RELAXED);
+  if (i == last) {
+    return;
+  }
+  fiber_timer_place(worker, i, worker->timers[last]);
+  fiber_timer_sift_down(worker, i);
+  fiber_timer_sift_up(worker, worker->timers[i].fiber->timer_index);
+}
+
+/* Back to running; the timer goes unless it already fired */
+static void fiber_block_end(tt_fiber_t *fiber) {
+  fiber_timer_remove(fiber->worker, fiber);
+  fiber->wait_state = FIBER_RUNNING;
+}
+
+/* Ready the fibers whose sleep or wait timed out */
+static void fiber_worker_expire(fiber_worker_t *worker) {
+  if (worker->timer_count == 0) {
+    return;
+  }
+
+  uint64_t now = tt_platform_time_monotonic_ns();
+  while (worker->timer_count > 0 && worker->timers[0].deadline_ns <= now) {
+    // The fiber is still blocked: a resumed fiber removes its own timer
+    tt_fiber_t *fiber = worker->timers[0].fiber;
+    fiber_timer_remove(worker, fiber);
+
+    if (fiber->wait_state == FIBER_SLEEPING) {
+      fiber_ready(fiber);
+      continue;
+    }
+
+    // Woken by tt_fiber_wake meanwhile and only waiting for its turn
+    fiber_bucket_t *bucket = fiber_bucket(fiber->wait_addr);
+    tt_mutex_lock(&bucket->lock);
+    bool expired = fiber->wait_state == FIBER_WAITING;
+    if (expired) {
+      fiber_bucket_unlink(bucket, fiber);
+      fiber->wait_state = FIBER_TIMED_OUT;
+    }
+    tt_mutex_unlock(&bucket->lock);
+    if (expired) {
+      fiber_ready(fiber);
+    }
+  }
+}
+
+/* Move fibers made ready by other threads to the ready list, oldest first */
+static void fiber_worker_drain(fiber_worker_t *worker) {
+  if (__atomic_load_n(&worker->inbox, __ATOMIC_RELAXED) == NULL) {
+    return;
+  }
+
+  tt_fiber_t *list = __atomic_exchange_n(&worker->inbox, NULL, __ATOMIC_ACQUIRE);
+  tt_fiber_t *ordered = NULL;
+  while (list != NULL) {
+    tt_fiber_t *next = list->next;
+    list->next = ordered;
+    ordered = list;
+    list = next;
+  }
+  while (ordered != NULL) {
+    tt_fiber_t *next = ordered->next;
+    fiber_ready(ordered);
+    ordered = next;
+  }
+}
+
+static void fiber_worker_idle(fiber_worker_t *worker) {
+  uint32_t seq = __atomic_load_n(&worker->signal, __ATOMIC_ACQUIRE);
+
+  __atomic_store_n(&worker->sleeping, 1, __ATOMIC_SEQ_CST);
+  if (__atomic_load_n(&worker->inbox, __ATOMIC_SEQ_CST) == NULL &&
+      !__atomic_load_n(&worker->scheduler->stop, __ATOMIC_ACQUIRE)) {
+    uint64_t deadline_ns = (worker->timer_count > 0)
+                               ? worker->timers[0].deadline_ns
+                               : TT_PLATFORM_WAIT_FOREVER;
+    tt_platform_futex_wait(&worker->signal, seq, deadline_ns);
+  }
+  __atomic_store_n(&worker->sleeping, 0, __ATOMIC_RELAXED);
+}
+
+static void fiber_release(tt_fiber_t *fiber) {
+  if (__atomic_sub_fetch(&fiber->refs, 1, __ATOMIC_ACQ_REL) != 0) {
+    return;
+  }
+
+  tt_fiber_scheduler_t *scheduler = fiber->worker->scheduler;
+  tt_mutex_lock(&scheduler->pool_lock);
+  fiber->next = scheduler->pool;
+  scheduler->pool = fiber;
+  tt_mutex_unlock(&scheduler->pool_lock);
+}
+
+/* Runs on the worker's own stack once the fiber is off its stack for good */
+static void fiber_retire(tt_fiber_t *fiber) {
+  tt_fiber_scheduler_t *scheduler = fiber->worker->scheduler;
+
+  __atomic_store_n(&fiber->done, 1, __ATOMIC_RELEASE);
+  tt_fiber_wake(&fiber->done, TT_PLATFORM_WAKE_ALL);
+  fiber_release(fiber);
+
+  uint32_t old = __atomic_fetch_sub(&scheduler->live, 1, __ATOMIC_ACQ_REL);
+  if (old == (FIBER_LIVE_WAITER | 1)) {
+    tt_platform_futex_wake(&scheduler->live, TT_PLATFORM_WAKE_ALL);
+  }
+}
+
+static void fiber_entry(void) {
+  tt_fiber_t *fiber = current_worker->current;
+
+  fiber->func(fiber->arg);
+  fiber->finished = true;
+  fiber_suspend(fiber);
+  __builtin_unreachable();
+}
+
+static void *fiber_worker_main(void *arg) {
+  fiber_worker_t *worker = (fiber_worker_t *)arg;
+
+  current_worker = worker;
+  for (;;) {
+    fiber_worker_expire(worker);
+    fiber_worker_drain(worker);
+
+    tt_fiber_t *fiber = worker->ready_head;
+    if (fiber != NULL) {
+      worker->ready_head = fiber->next;
+      if (worker->ready_head == NULL) {
+        worker->ready_tail = NULL;
+      }
+
+      worker->current = fiber;
+      fiber_context_switch(&worker->context, &fiber->context);
+      worker->current = NULL;
+      if (fiber->finished) {
+        fiber_retire(fiber);
+      }
+      continue;
+    }
+
+    if (__atomic_load_n(&worker->scheduler->stop, __ATOMIC_ACQUIRE)) {
+      break;
+    }
+    fiber_worker_idle(worker);
+  }
+
+  current_worker = NULL;
+  return NULL;
+}
+
+/* Take a pooled fiber or map a new stack with the fiber on top of it */
+static tt_fiber_t *fiber_alloc(tt_fiber_scheduler_t *scheduler) {
+  tt_mutex_lock(&scheduler->pool_lock);
+  tt_fiber_t *fiber = scheduler->pool;
+  if (fiber != NULL) {
+    scheduler->pool = fiber->next;
+  }
+  tt_mutex_unlock(&scheduler->pool_lock);
+  if (fiber != NULL) {
+    return fiber;
+  }
+
+  void *stack;
+  size_t size = scheduler->stack_size + sizeof(tt_fiber_t) + 64;
+  if (tt_platform_stack_alloc(&size, &stack) != TT_SUCCESS) {
+    return NULL;
+  }
+
+  uintptr_t top = (uintptr_t)stack + size - sizeof(tt_fiber_t);
+  fiber = (tt_fiber_t *)(top & ~(uintptr_t)63);
+  fiber->stack = stack;
+  fiber->stack_size = size;
+  return fiber;
+}
+
+static void scheduler_free(tt_fiber_scheduler_t *scheduler) {
+  tt_fiber_t *fiber = scheduler->pool;
+  while (fiber != NULL) {
+    tt_fiber_t *next = fiber->next;
+    // The fiber lives in the mapping it frees
+    tt_platform_stack_free(fiber->stack, fiber->stack_size);
+    fiber = next;
+  }
+  for (size_t i = 0; i < scheduler->num_workers; i++) {
+    free(scheduler->workers[i].timers);
+  }
+  tt_mutex_destroy(&scheduler->pool_lock);
+  free(scheduler->workers);
+  free(scheduler);
+}
+
+/* Stop and join the first started workers */
+static tt_error_t scheduler_stop(tt_fiber_scheduler_t *scheduler,
+                                 size_t started) {
+  tt_error_t result = TT_SUCCESS;
+
+  __atomic_store_n(&scheduler->stop, true, __ATOMIC_SEQ_CST);
+  for (size_t i = 0; i < started; i++) {
+    fiber_worker_t *worker = &scheduler->workers[i];
+    __atomic_fetch_add(&worker->signal, 1, __ATOMIC_RELEASE);
+    tt_platform_futex_wake(&worker->signal, 1);
+  }
+
+  for (size_t i = 0; i < started; i++) {
+    tt_error_t join_result = tt_thread_join(scheduler->workers[i].thread, NULL);
+    if (join_result == TT_SUCCESS) {
+      tt_thread_destroy(scheduler->workers[i].thread);
+    } else if (result == TT_SUCCESS) {
+      result = join_result;
+    }
+  }
+  return result;
+}
+
+tt_error_t tt_fiber_scheduler_create(tt_fiber_scheduler_t **scheduler,
+                                     size_t num_workers, size_t stack_size) {
+  if (scheduler == NULL) {
+    return TT_ERROR_NULL_POINTER;
+  }
+
+  if (num_workers == 0) {
+    return TT_ERROR_INVALID_PARAM;
+  }
+
+  tt_error_t result = tt_thread_init();
+  if (result != TT_SUCCESS) {
+    return result;
+  }
+  result = tt_call_once(&fiber_once, fiber_init_once);
+  if (result != TT_SUCCESS) {
+    return result;
+  }
+
+  tt_fiber_scheduler_t *new_scheduler = calloc(1, sizeof(*new_scheduler));
+  if (new_scheduler == NULL) {
+    return TT_ERROR_MEMORY;
+  }
+  new_scheduler->stack_size = (stack_size > 0) ? stack_size
+                                               : TT_FIBER_STACK_SIZE;
+
+  new_scheduler->workers =
+      aligned_alloc(_Alignof(fiber_worker_t),
+                    num_workers * sizeof(*new_scheduler->workers));
+  if (new_scheduler->workers == NULL) {
+    free(new_scheduler);
+    return TT_ERROR_MEMORY;
+  }
+
+  result = tt_mutex_init_named(&new_scheduler->pool_lock, "tt_fiber_pool");
+  if (result != TT_SUCCESS) {
+    free(new_scheduler->workers);
+    free(new_scheduler);
+    return result;
+  }
+
+  for (size_t i = 0; i < num_workers; i++) {
+    fiber_worker_t *worker = &new_scheduler->workers[i];
+    *worker = (fiber_worker_t){.scheduler = new_scheduler};
+    new_scheduler->num_workers++;
+  }
+
+  for (size_t i = 0; i < num_workers; i++) {
+    result = tt_thread_create(&new_scheduler->workers[i].thread, NULL,
+                              fiber_worker_main, &new_scheduler->workers[i]);
+    if (result != TT_SUCCESS) {
+      scheduler_stop(new_scheduler, i);
+      scheduler_free(new_scheduler);
+      return result;
+    }
+  }
+
+  *scheduler = new_scheduler;
+  return TT_SUCCESS;
+}
+
+tt_error_t tt_fiber_scheduler_destroy(tt_fiber_scheduler_t *scheduler) {
+  if (scheduler == NULL) {
+    return TT_ERROR_NULL_POINTER;
+  }
+
+  uint32_t live;
+  while (((live = __atomic_load_n(&scheduler->live, __ATOMIC_ACQUIRE)) &
+          ~FIBER_LIVE_WAITER) != 0) {
+    if (!(live & FIBER_LIVE_WAITER) &&
+        !__atomic_compare_exchange_n(&scheduler->live, &live,
+                                     live | FIBER_LIVE_WAITER, false,
+                                     __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+      continue;
+    }
+    tt_platform_futex_wait(&scheduler->live, live | FIBER_LIVE_WAITER,
+                           TT_PLATFORM_WAIT_FOREVER);
+  }
+
+  tt_error_t result = scheduler_stop(scheduler, scheduler->num_workers);
+  scheduler_free(scheduler);
+  return result;
+}
+
+tt_error_t tt_fiber_spawn(tt_fiber_scheduler_t *scheduler,
+                          tt_fiber_func_t func, void *arg,
+                          tt_fiber_t **fiber) {
+  if (scheduler == NULL || func == NULL) {
+    return TT_ERROR_NULL_POINTER;
+  }
+
+  tt_fiber_t *new_fiber = fiber_alloc(scheduler);
+  if (new_fiber == NULL) {
+    return TT_ERROR_MEMORY;
+  }
+
+  uint32_t index =
+      __atomic_fetch_add(&scheduler->next_worker, 1, __ATOMIC_RELAXED);
+  new_fiber->func = func;
+  new_fiber->arg = arg;
+  new_fiber->worker = &scheduler->workers[index % scheduler->num_workers];
+  new_fiber->wait_prev = NULL;
+  new_fiber->wait_next = NULL;
+  new_fiber->wait_addr = NULL;
+  new_fiber->wait_state = FIBER_RUNNING;
+  new_fiber->timer_index = FIBER_NO_TIMER;
+  new_fiber->done = 0;
+  new_fiber->refs = (fiber != NULL) ? 2 : 1;
+  new_fiber->finished = false;
+  fiber_context_init(&new_fiber->context, new_fiber->stack,
+                     (uintptr_t)new_fiber);
+
+  __atomic_fetch_add(&scheduler->live, 1, __ATOMIC_RELAXED);
+  if (fiber != NULL) {
+    *fiber = new_fiber;
+  }
+  fiber_ready(new_fiber);
+  return TT_SUCCESS;
+}
+
+tt_error_t tt_fiber_join(tt_fiber_t *fiber) {
+  if (fiber == NULL) {
+    return TT_ERROR_NULL_POINTER;
+  }
+
+  while (__atomic_load_n(&fiber->done, __ATOMIC_ACQUIRE) == 0) {
+    tt_fiber_wait(&fiber->done, 0, TT_FIBER_WAIT_FOREVER);
+  }
+  fiber_release(fiber);
+  return TT_SUCCESS;
+}
+
+tt_error_t tt_fiber_yield(void) {
+  fiber_worker_t *worker = current_worker;
+  if (worker == NULL || worker->current == NULL) {
+    return TT_ERROR_NOT_INITIALIZED;
+  }
+
+  // Nobody else to run: keep going without a round trip
+  if (worker->ready_head == NULL &&
+      __atomic_load_n(&worker->inbox, __ATOMIC_RELAXED) == NULL &&
+      worker->timer_count == 0) {
+    return TT_SUCCESS;
+  }
+
+  tt_fiber_t *fiber = worker->current;
+  fiber_ready(fiber);
+  fiber_suspend(fiber);
+  return TT_SUCCESS;
+}
+
+tt_error_t tt_fiber_sleep(uint32_t ms) {
+  tt_fiber_t *fiber = tt_fiber_self();
+  if (fiber == NULL) {
+    return tt_platform_thread_sleep(ms);
+  }
+
+  uint64_t deadline_ns =
+      tt_platform_time_monotonic_ns() + (uint64_t)ms * 1000000ULL;
+  if (!fiber_timer_push(fiber->worker, deadline_ns, fiber)) {
+    return TT_ERROR_MEMORY;
+  }
+
+  fiber->wait_state = FIBER_SLEEPING;
+  fiber_suspend(fiber);
+  fiber_block_end(fiber);
+  return TT_SUCCESS;
+}
+
+tt_error_t tt_fiber_wait(volatile uint32_t *addr, uint32_t expected,
+                         uint32_t timeout_ms) {
+  if (addr == NULL) {
+    return TT_ERROR_NULL_POINTER;
+  }
+
+  uint64_t deadline_ns = TT_PLATFORM_WAIT_FOREVER;
+  if (timeout_ms != TT_FIBER_WAIT_FOREVER) {
+    deadline_ns =
+        tt_platform_time_monotonic_ns() + (uint64_t)timeout_ms * 1000000ULL;
+  }
+
+  tt_fiber_t *fiber = tt_fiber_self();
+  if (fiber == NULL) {
+    // Announce ourselves so tt_fiber_wake issues the futex wake
+    __atomic_fetch_add(&fiber_os_waiters, 1, __ATOMIC_SEQ_CST);
+    tt_error_t result = tt_platform_futex_wait(addr, expected, deadline_ns);
+    __atomic_fetch_sub(&fiber_os_waiters, 1, __ATOMIC_RELAXED);
+    return result;
+  }
+
+  // Checked under the bucket lock, which tt_fiber_wake also takes, and before
+  // arming the timer so a changed value costs no heap entry
+  fiber_bucket_t *bucket = fiber_bucket(addr);
+  tt_mutex_lock(&bucket->lock);
+  if (__atomic_load_n(addr, __ATOMIC_ACQUIRE) != expected) {
+    tt_mutex_unlock(&bucket->lock);
+    return TT_SUCCESS;
+  }
+  if (deadline_ns != TT_PLATFORM_WAIT_FOREVER &&
+      !fiber_timer_push(fiber->worker, deadline_ns, fiber)) {
+    tt_mutex_unlock(&bucket->lock);
+    return TT_ERROR_MEMORY;
+  }
+  fiber->wait_addr = addr;
+  fiber->wait_state = FIBER_WAITING;
+  fiber->wait_prev = NULL;
+  fiber->wait_next = bucket->head;
+  if (bucket->head != NULL) {
+    bucket->head->wait_prev = fiber;
+  }
+  bucket->head = fiber;
+  tt_mutex_unlock(&bucket->lock);
+
+  fiber_suspend(fiber);
+
+  bool timed_out = fiber->wait_state == FIBER_TIMED_OUT;
+  fiber_block_end(fiber);
+  return timed_out ? TT_ERROR_TIMEOUT : TT_SUCCESS;
+}
+
+tt_error_t tt_fiber_wake(volatile uint32_t *addr, uint32_t count) {
+  if (addr == NULL) {
+    return TT_ERROR_NULL_POINTER;
+  }
+
+  uint32_t woken = 0;
+  if (tt_once_is_done(&fiber_once)) {
+    fiber_bucket_t *bucket = fiber_bucket(addr);
+    tt_fiber_t *ready = NULL;
+
+    tt_mutex_lock(&bucket->lock);
+    tt_fiber_t *fiber = bucket->head;
+    // Oldest waiters sit at the tail; wake those first
+    while (fiber != NULL && fiber->wait_next != NULL) {
+      fiber = fiber->wait_next;
+    }
+    while (fiber != NULL && woken < count) {
+      tt_fiber_t *prev = fiber->wait_prev;
+      if (fiber->wait_addr == addr) {
+        fiber_bucket_unlink(bucket, fiber);
+        fiber->wait_state = FIBER_WOKEN;
+        fiber->next = ready;
+        ready = fiber;
+        woken++;
+      }
+      fiber = prev;
+    }
+    tt_mutex_unlock(&bucket->lock);
+
+    // Collected newest first, ready them oldest first
+    tt_fiber_t *ordered = NULL;
+    while (ready != NULL) {
+      tt_fiber_t *next = ready->next;
+      ready->next = ordered;
+      ordered = ready;
+      ready = next;
+    }
+    while (ordered != NULL) {
+      tt_fiber_t *next = ordered->next;
+      fiber_ready(ordered);
+      ordered = next;
+    }
+  }
+
+  if (woken < count &&
+      __atomic_load_n(&fiber_os_waiters, __ATOMIC_SEQ_CST) > 0) {
+    return tt_platform_futex_wake(
+        addr, (count == TT_PLATFORM_WAKE_ALL) ? count : count - woken);
+  }
+  return TT_SUCCESS;
+}
+
+tt_fiber_t *tt_fiber_self(void) {
+  fiber_worker_t *worker = current_worker;
+  return (worker != NULL) ? worker->current : NULL;
+}
+
+size_t tt_fiber_scheduler_timers(const tt_fiber_scheduler_t *scheduler) {
+  if (scheduler == NULL) {
+    return 0;
+  }
+
+  size_t count = 0;
+  for (size_t i = 0; i < scheduler->num_workers; i++) {
+    count += __atomic_load_n(&scheduler->workers[i].timer_count,
+                             __ATOMIC_RELAXED);
+  }
+  return count;
+}
+
+#else
+tt_error_t tt_fiber_scheduler_create(tt_fiber_scheduler_t **scheduler,
+                                     size_t num_workers
+                                     __attribute__((unused)),
+                                     size_t stack_size
+                                     __attribute__((unused))) {
+  return (scheduler == NULL) ? TT_ERROR_NULL_POINTER
+                             : TT_ERROR_NOT_IMPLEMENTED;
+}
+
+tt_error_t tt_fiber_scheduler_destroy(tt_fiber_scheduler_t *scheduler
+                                      __attribute__((unused))) {
+  return TT_ERROR_NOT_IMPLEMENTED;
+}
+
+tt_error_t tt_fiber_spawn(tt_fiber_scheduler_t *scheduler
+                          __attribute__((unused)),
+                          tt_fiber_func_t func __attribute__((unused)),
+                          void *arg __attribute__((unused)),
+                          tt_fiber_t **fiber __attribute__((unused))) {
+  return TT_ERROR_NOT_IMPLEMENTED;
+}
+
+tt_error_t tt_fiber_join(tt_fiber_t *fiber __attribute__((unused))) {
+  return TT_ERROR_NOT_IMPLEMENTED;
+}
+
+tt_error_t tt_fiber_yield(void) { return TT_ERROR_NOT_IMPLEMENTED; }
+
+tt_error_t tt_fiber_sleep(uint32_t ms __attribute__((unused))) {
+  return TT_ERROR_NOT_IMPLEMENTED;
+}
+
+tt_error_t tt_fiber_wait(volatile uint32_t *addr __attribute__((unused)),
+                         uint32_t expected __attribute__((unused)),
+                         uint32_t timeout_ms __attribute__((unused))) {
+  return TT_ERROR_NOT_IMPLEMENTED;
+}
+
+tt_error_t tt_fiber_wake(volatile uint32_t *addr __attribute__((unused)),
+                         uint32_t count __attribute__((unused))) {
+  return TT_ERROR_NOT_IMPLEMENTED;
+}
+
+tt_fiber_t *tt_fiber_self(void) { return NULL; }
+
+size_t tt_fiber_scheduler_timers(const tt_fiber_scheduler_t *scheduler
+                                 __attribute__((unused))) {
+  return 0;
+}
+#endif /* TT_CAP_THREADS */
@@ -0,0 +1,293 @@
+/**
+ * @file tt_future.c
+ * @author Mihai Gurei <mihai.gurei@protonmail.com>
+ * @date 2025-01-30
+ * @brief
+ * @copyright Copyright (c) 2025 AnAlphaBeta. All rights reserved.
+ */
+
+#include "tt_future.h"
+#include "tt_platform.h"
+#include "tt_types.h"
+#include <stdlib.h>
+
+#if defined(TT_CAP_THREADS)
+/* tt_future_t.state bits */
+#define FUTURE_READY 0x1u
+#define FUTURE_WAITER 0x2u
+
+/**
+ * @brief Registered continuation
+ */
+typedef struct tt_future_cont_t {
+  tt_future_then_func_t func;
+  void *arg;
+  tt_future_t *next;             /**< Completed with the result of func*/
+  struct tt_future_cont_t *link; /**< Next registered continuation*/
+} tt_future_cont_t;
+
+struct tt_future_t {
+  volatile uint32_t state;   /**< FUTURE_* bits, wait word*/
+  volatile uint32_t refs;    /**< Reference count*/
+  void *value;               /**< Valid once FUTURE_READY is set*/
+  tt_future_cont_t *volatile conts; /**< Continuations, newest first*/
+  tt_future_func_t func;     /**< tt_future_async function*/
+  void *arg;                 /**< tt_future_async argument*/
+};
+
+/* Marks a continuation list that no longer accepts entries */
+static tt_future_cont_t future_closed;
+
+static tt_future_t *future_alloc(uint32_t refs) {
+  tt_future_t *future = calloc(1, sizeof(*future));
+  if (future != NULL) {
+    future->refs = refs;
+  }
+  return future;
+}
+
+static void future_cont_run(tt_future_cont_t *cont, void *value) {
+  tt_future_set(cont->next, cont->func(value, cont->arg));
+  tt_future_release(cont->next);
+  free(cont);
+}
+
+static void future_async_task(void *arg) {
+  tt_future_t *future = (tt_future_t *)arg;
+
+  tt_future_set(future, future->func(future->arg));
+  tt_future_release(future);
+}
+
+static tt_error_t future_wait_until(tt_future_t *future, void **value,
+                                    uint64_t deadline_ns) {
+  uint32_t state;
+
+  while (!((state = __atomic_load_n(&future->state, __ATOMIC_ACQUIRE)) &
+           FUTURE_READY)) {
+    if (!(state & FUTURE_WAITER) &&
+        !__atomic_compare_exchange_n(&future->state, &state,
+                                     state | FUTURE_WAITER, false,
+                                     __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+      continue;
+    }
+    if (tt_platform_futex_wait(&future->state, state | FUTURE_WAITER,
+                               deadline_ns) == TT_ERROR_TIMEOUT) {
+      if (!tt_future_is_ready(future)) {
+        return TT_ERROR_TIMEOUT;
+      }
+    }
+  }
+
+  if (value != NULL) {
+    *value = future->value;
+  }
+  return TT_SUCCESS;
+}
+
+tt_error_t tt_future_create(tt_future_t **future) {
+  if (future == NULL) {
+    return TT_ERROR_NULL_POINTER;
+  }
+
+  *future = future_alloc(1);
+  return (*future != NULL) ? TT_SUCCESS : TT_ERROR_MEMORY;
+}
+
+tt_error_t tt_future_async(tt_threadpool_t *pool, tt_future_func_t func,
+                           void *arg, tt_future_t **future) {
+  if (pool == NULL || func == NULL || future == NULL) {
+    return TT_ERROR_NULL_POINTER;
+  }
+
+  // One reference for the caller, one for the task
+  tt_future_t *new_future = future_alloc(2);
+  if (new_future == NULL) {
+    return TT_ERROR_MEMORY;
+  }
+  new_future->func = func;
+  new_future->arg = arg;
+
+  tt_error_t result = tt_threadpool_submit(pool, future_async_task, new_future);
+  if (result != TT_SUCCESS) {
+    free(new_future);
+    return result;
+  }
+
+  *future = new_future;
+  return TT_SUCCESS;
+}
+
+tt_error_t tt_future_set(tt_future_t *future, void *value) {
+  if (future == NULL) {
+    return TT_ERROR_NULL_POINTER;
+  }
+
+  // Claim completion before publishing, a second set must not touch value
+  tt_future_cont_t *conts = __atomic_load_n(&future->conts, __ATOMIC_ACQUIRE);
+  do {
+    if (conts == &future_closed) {
+      return TT_ERROR_ALREADY_INITIALIZED;
+    }
+  } while (!__atomic_compare_exchange_n(&future->conts, &conts, &future_closed,
+                                        true, __ATOMIC_ACQ_REL,
+                                        __ATOMIC_ACQUIRE));
+
+  future->value = value;
+  uint32_t state =
+      __atomic_fetch_or(&future->state, FUTURE_READY, __ATOMIC_ACQ_REL);
+  if (state & FUTURE_WAITER) {
+    tt_platform_futex_wake(&future->state, TT_PLATFORM_WAKE_ALL);
+  }
+
+  // Reverse the list so continuations run in registration order
+  tt_future_cont_t *ordered = NULL;
+  while (conts != NULL) {
+    tt_future_cont_t *link = conts->link;
+    conts->link = ordered;
+    ordered = conts;
+    conts = link;
+  }
+  while (ordered != NULL) {
+    tt_future_cont_t *link = ordered->link;
+    future_cont_run(ordered, value);
+    ordered = link;
+  }
+  return TT_SUCCESS;
+}
+
+bool tt_future_is_ready(const tt_future_t *future) {
+  return future != NULL &&
+         (__atomic_load_n(&future->state, __ATOMIC_ACQUIRE) & FUTURE_READY);
+}
+
+tt_error_t tt_future_get(tt_future_t *future, void **value) {
+  if (future == NULL) {
+    return TT_ERROR_NULL_POINTER;
+  }
+
+  return future_wait_until(future, value, TT_PLATFORM_WAIT_FOREVER);
+}
+
+tt_error_t tt_future_timedget(tt_future_t *future, void **value,
+                              uint32_t timeout_ms) {
+  if (future == NULL) {
+    return TT_ERROR_NULL_POINTER;
+  }
+
+  return future_wait_until(future, value,
+                           tt_platform_time_monotonic_ns() +
+                               (uint64_t)timeout_ms * 1000000ULL);
+}
+
+tt_error_t tt_future_then(tt_future_t *future, tt_future_then_func_t func,
+                          void *arg, tt_future_t **next) {
+  if (future == NULL || func == NULL || next == NULL) {
+    return TT_ERROR_NULL_POINTER;
+  }
+
+  tt_future_cont_t *cont = malloc(sizeof(*cont));
+  // One reference for the caller, one for the continuation
+  tt_future_t *next_future = future_alloc(2);
+  if (cont == NULL || next_future == NULL) {
+    free(cont);
+    free(next_future);
+    return TT_ERROR_MEMORY;
+  }
+  cont->func = func;
+  cont->arg = arg;
+  cont->next = next_future;
+  *next = next_future;
+
+  tt_future_cont_t *head = __atomic_load_n(&future->conts, __ATOMIC_ACQUIRE);
+  do {
+    if (head == &future_closed) {
+      // Already completed, tt_future_set will not see this one. The value
+      // may still be on its way, so wait for it
+      future_wait_until(future, NULL, TT_PLATFORM_WAIT_FOREVER);
+      future_cont_run(cont, future->value);
+      return TT_SUCCESS;
+    }
+    cont->link = head;
+  } while (!__atomic_compare_exchange_n(&future->conts, &head, cont, true,
+                                        __ATOMIC_RELEASE, __ATOMIC_ACQUIRE));
+  return TT_SUCCESS;
+}
+
+tt_error_t tt_future_retain(tt_future_t *future) {
+  if (future == NULL) {
+    return TT_ERROR_NULL_POINTER;
+  }
+
+  __atomic_fetch_add(&future->refs, 1, __ATOMIC_RELAXED);
+  return TT_SUCCESS;
+}
+
+tt_error_t tt_future_release(tt_future_t *future) {
+  if (future == NULL) {
+    return TT_ERROR_NULL_POINTER;
+  }
+
+  if (__atomic_sub_fetch(&future->refs, 1, __ATOMIC_ACQ_REL) != 0) {
+    return TT_SUCCESS;
+  }
+
+  // Never completed: drop the continuations and their futures with it
+  tt_future_cont_t *cont = future->conts;
+  while (cont != NULL && cont != &future_closed) {
+    tt_future_cont_t *link = cont->link;
+    tt_future_release(cont->next);
+    free(cont);
+    cont = link;
+  }
+  free(future);
+  return TT_SUCCESS;
+}
+
+#else
+tt_error_t tt_future_create(tt_future_t **future) {
+  return (future == NULL) ? TT_ERROR_NULL_POINTER : TT_ERROR_NOT_IMPLEMENTED;
+}
+
+tt_error_t tt_future_async(tt_threadpool_t *pool __attribute__((unused)),
+                           tt_future_func_t func __attribute__((unused)),
+                           void *arg __attribute__((unused)),
+                           tt_future_t **future __attribute__((unused))) {
+  return TT_ERROR_NOT_IMPLEMENTED;
+}
+
+tt_error_t tt_future_set(tt_future_t *future __attribute__((unused)),
+                         void *value __attribute__((unused))) {
+  return TT_ERROR_NOT_IMPLEMENTED;
+}
+
+bool tt_future_is_ready(const tt_future_t *future __attribute__((unused))) {
+  return false;
+}
+
+tt_error_t tt_future_get(tt_future_t *future __attribute__((unused)),
+                         void **value __attribute__((unused))) {
+  return TT_ERROR_NOT_IMPLEMENTED;
+}
+
+tt_error_t tt_future_timedget(tt_future_t *future __attribute__((unused)),
+                              void **value __attribute__((unused)),
+                              uint32_t timeout_ms __attribute__((unused))) {
+  return TT_ERROR_NOT_IMPLEMENTED;
+}
+
+tt_error_t tt_future_then(tt_future_t *future __attribute__((unused)),
+                          tt_future_then_func_t func __attribute__((unused)),
+                          void *arg __attribute__((unused)),
+                          tt_future_t **next __attribute__((unused))) {
+  return TT_ERROR_NOT_IMPLEMENTED;
+}
+
+tt_error_t tt_future_retain(tt_future_t *future __attribute__((unused))) {
+  return TT_ERROR_NOT_IMPLEMENTED;
+}
+
+tt_error_t tt_future_release(tt_future_t *future __attribute__((unused))) {
+  return TT_ERROR_NOT_IMPLEMENTED;
+}
+#endif /* TT_CAP_THREADS */
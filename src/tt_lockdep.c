@@ -0,0 +1,286 @@
+/**
+ * @file tt_lockdep.c
+ * @author Mihai Gurei <mihai.gurei@protonmail.com>
+ * @date 2025-01-14
+ * @brief
+ * @copyright Copyright (c) 2025 AnAlphaBeta. All rights reserved.
+ */
+
+#include "tt_lockdep.h"
+#include "tt_types.h"
+
+#if defined(TT_LOCKDEP)
+#include <stdio.h>
+#include <string.h>
+
+#if TT_LOCKDEP_MAX_CLASSES > 64
+#error "TT_LOCKDEP_MAX_CLASSES must not exceed 64"
+#endif
+
+#define LOCKDEP_BIT(id) (1ULL << (id))
+
+/**
+ * @brief Lock class, the unit dependencies are tracked for
+ */
+typedef struct {
+  const char *name; /**< Class name, NULL for anonymous classes*/
+  const void *key;  /**< Lock address for anonymous classes*/
+  bool in_use;      /**< Slot is in use*/
+} lockdep_class_t;
+
+/**
+ * @brief Where a dependency edge was first observed
+ */
+typedef struct {
+  const char *held_file; /**< Acquisition site of the held lock*/
+  int held_line;
+  const char *file; /**< Acquisition site of the new lock*/
+  int line;
+} lockdep_site_t;
+
+/**
+ * @brief Lock held by the current thread
+ */
+typedef struct {
+  const void *lock;
+  int class_id;
+  const char *file;
+  int line;
+} lockdep_held_t;
+
+static lockdep_class_t classes[TT_LOCKDEP_MAX_CLASSES];
+/* deps[a] has bit b set when class b was acquired while holding class a */
+static uint64_t deps[TT_LOCKDEP_MAX_CLASSES];
+static uint64_t reported[TT_LOCKDEP_MAX_CLASSES];
+static lockdep_site_t sites[TT_LOCKDEP_MAX_CLASSES][TT_LOCKDEP_MAX_CLASSES];
+static uint32_t violations = 0;
+static bool table_full_reported = false;
+static volatile bool graph_busy = false;
+
+static _Thread_local lockdep_held_t held[TT_LOCKDEP_MAX_DEPTH];
+static _Thread_local int held_depth = 0;
+
+/* The validator cannot use tt_mutex_t, it instruments it */
+static void graph_lock(void) {
+  while (__atomic_test_and_set(&graph_busy, __ATOMIC_ACQUIRE)) {
+  }
+}
+
+static void graph_unlock(void) { __atomic_clear(&graph_busy, __ATOMIC_RELEASE); }
+
+static void print_class(int id) {
+  if (classes[id].name != NULL) {
+    fprintf(stderr, "\"%s\"", classes[id].name);
+  } else {
+    fprintf(stderr, "mutex@%p", classes[id].key);
+  }
+}
+
+static void print_site(const char *file, int line) {
+  if (file != NULL) {
+    fprintf(stderr, "%s:%d", file, line);
+  } else {
+    fprintf(stderr, "unknown site");
+  }
+}
+
+/* Breadth-first search over the dependency graph, filling parent[] */
+static bool find_path(int from, int to, int parent[TT_LOCKDEP_MAX_CLASSES]) {
+  uint64_t visited = LOCKDEP_BIT(from);
+  int queue[TT_LOCKDEP_MAX_CLASSES];
+  int head = 0;
+  int tail = 0;
+
+  queue[tail++] = from;
+  while (head < tail) {
+    int node = queue[head++];
+    uint64_t next = deps[node] & ~visited;
+    while (next != 0) {
+      int child = __builtin_ctzll(next);
+      next &= next - 1;
+      visited |= LOCKDEP_BIT(child);
+      parent[child] = node;
+      if (child == to) {
+        return true;
+      }
+      queue[tail++] = child;
+    }
+  }
+
+  return false;
+}
+
+static void report_cycle(const lockdep_held_t *holding, int class_id,
+                         const char *file, int line,
+                         const int parent[TT_LOCKDEP_MAX_CLASSES]) {
+  fprintf(stderr, "tt_lockdep: possible circular locking dependency\n");
+  fprintf(stderr, "  acquiring ");
+  print_class(class_id);
+  fprintf(stderr, " at ");
+  print_site(file, line);
+  fprintf(stderr, "\n  while holding ");
+  print_class(holding->class_id);
+  fprintf(stderr, " acquired at ");
+  print_site(holding->file, holding->line);
+  fprintf(stderr, "\n  existing dependency chain:\n");
+
+  // Walk the path back from the held class, then print it forwards
+  int path[TT_LOCKDEP_MAX_CLASSES];
+  int length = 0;
+  for (int node = holding->class_id; node != class_id; node = parent[node]) {
+    path[length++] = node;
+  }
+
+  for (int i = length - 1; i >= 0; i--) {
+    int node = path[i];
+    int from = parent[node];
+    const lockdep_site_t *site = &sites[from][node];
+    fprintf(stderr, "    ");
+    print_class(from);
+    fprintf(stderr, " held at ");
+    print_site(site->held_file, site->held_line);
+    fprintf(stderr, " -> ");
+    print_class(node);
+    fprintf(stderr, " acquired at ");
+    print_site(site->file, site->line);
+    fprintf(stderr, "\n");
+  }
+}
+
+int tt_lockdep_register(const void *lock, const char *name) {
+  int class_id = -1;
+  int free_id = -1;
+
+  graph_lock();
+  for (int i = 0; i < TT_LOCKDEP_MAX_CLASSES; i++) {
+    if (!classes[i].in_use) {
+      if (free_id < 0) {
+        free_id = i;
+      }
+      continue;
+    }
+    if (name != NULL && classes[i].name != NULL &&
+        strcmp(classes[i].name, name) == 0) {
+      class_id = i;
+      break;
+    }
+  }
+
+  if (class_id < 0 && free_id >= 0) {
+    class_id = free_id;
+    classes[class_id].name = name;
+    classes[class_id].key = (name == NULL) ? lock : NULL;
+    classes[class_id].in_use = true;
+    deps[class_id] = 0;
+    reported[class_id] = 0;
+  }
+
+  // Locks past the table are never checked, say so once
+  if (class_id < 0 && !table_full_reported) {
+    table_full_reported = true;
+    fprintf(stderr,
+            "tt_lockdep: class table full (%d classes), %s not checked; "
+            "share classes with tt_mutex_init_named\n",
+            TT_LOCKDEP_MAX_CLASSES, (name != NULL) ? name : "unnamed mutexes");
+  }
+  graph_unlock();
+
+  return class_id;
+}
+
+void tt_lockdep_unregister(const void *lock, int class_id) {
+  if (class_id < 0 || class_id >= TT_LOCKDEP_MAX_CLASSES) {
+    return;
+  }
+
+  graph_lock();
+  if (classes[class_id].in_use && classes[class_id].name == NULL &&
+      classes[class_id].key == lock) {
+    // Anonymous classes die with their lock, the address may be reused
+    for (int i = 0; i < TT_LOCKDEP_MAX_CLASSES; i++) {
+      deps[i] &= ~LOCKDEP_BIT(class_id);
+      reported[i] &= ~LOCKDEP_BIT(class_id);
+    }
+    deps[class_id] = 0;
+    reported[class_id] = 0;
+    classes[class_id].in_use = false;
+  }
+  graph_unlock();
+}
+
+void tt_lockdep_acquire(const void *lock, int class_id, const char *file,
+                        int line, bool check) {
+  if (class_id < 0 || class_id >= TT_LOCKDEP_MAX_CLASSES) {
+    return;
+  }
+
+  if (check) {
+    int parent[TT_LOCKDEP_MAX_CLASSES];
+
+    graph_lock();
+    for (int i = 0; i < held_depth; i++) {
+      const lockdep_held_t *h = &held[i];
+
+      if (h->lock == lock) {
+        fprintf(stderr, "tt_lockdep: recursive locking of ");
+        print_class(class_id);
+        fprintf(stderr, " at ");
+        print_site(file, line);
+        fprintf(stderr, ", already acquired at ");
+        print_site(h->file, h->line);
+        fprintf(stderr, "\n");
+        violations++;
+        continue;
+      }
+
+      if (h->class_id == class_id ||
+          (deps[h->class_id] & LOCKDEP_BIT(class_id)) != 0) {
+        continue;
+      }
+
+      if (find_path(class_id, h->class_id, parent)) {
+        // Inverted order: the new edge would close a cycle
+        if ((reported[h->class_id] & LOCKDEP_BIT(class_id)) == 0) {
+          reported[h->class_id] |= LOCKDEP_BIT(class_id);
+          violations++;
+          report_cycle(h, class_id, file, line, parent);
+        }
+        continue;
+      }
+
+      deps[h->class_id] |= LOCKDEP_BIT(class_id);
+      sites[h->class_id][class_id] =
+          (lockdep_site_t){h->file, h->line, file, line};
+    }
+    graph_unlock();
+  }
+
+  if (held_depth < TT_LOCKDEP_MAX_DEPTH) {
+    held[held_depth++] = (lockdep_held_t){lock, class_id, file, line};
+  }
+}
+
+void tt_lockdep_release(const void *lock) {
+  // Locks are usually released in reverse order, search from the top
+  for (int i = held_depth - 1; i >= 0; i--) {
+    if (held[i].lock == lock) {
+      memmove(&held[i], &held[i + 1],
+              (size_t)(held_depth - i - 1) * sizeof(lockdep_held_t));
+      held_depth--;
+      return;
+    }
+  }
+}
+
+uint32_t tt_lockdep_violations(void) {
+  return __atomic_load_n(&violations, __ATOMIC_RELAXED);
+}
+
+void tt_lockdep_reset(void) {
+  graph_lock();
+  memset(deps, 0, sizeof(deps));
+  memset(reported, 0, sizeof(reported));
+  violations = 0;
+  graph_unlock();
+}
+#endif /* TT_LOCKDEP */
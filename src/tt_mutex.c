@@ -7,42 +7,293 @@
  */
 
 #include "tt_mutex.h"
+#include "tt_atomic.h"
+#include "tt_lockdep.h"
 #include "tt_platform.h"
 #include <stddef.h>
 
-// NOTE: Not the only platform to support this is linux, add more later
-#if defined(TT_TARGET_LINUX) && defined(TT_CAP_MUTEX)
-tt_error_t tt_mutex_init(tt_mutex_t *mutex) {
-  return tt_platform_mutex_init(mutex);
+#if defined(TT_MUTEX_STATS)
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static tt_mutex_stats_t mutex_stats[TT_MUTEX_STATS_MAX_LOCKS];
+static size_t mutex_stats_count = 0;
+static volatile bool mutex_stats_busy = false;
+
+/* Find or register the statistics slot for a name (init path only) */
+static tt_mutex_stats_t *mutex_stats_lookup(const char *name) {
+  tt_mutex_stats_t *stats = NULL;
+
+  if (name == NULL) {
+    name = "(unnamed)";
+  }
+
+  while (__atomic_test_and_set(&mutex_stats_busy, __ATOMIC_ACQUIRE)) {
+  }
+
+  size_t count = __atomic_load_n(&mutex_stats_count, __ATOMIC_RELAXED);
+  for (size_t i = 0; i < count; i++) {
+    if (strcmp(mutex_stats[i].name, name) == 0) {
+      stats = &mutex_stats[i];
+      break;
+    }
+  }
+
+  if (stats == NULL && count < TT_MUTEX_STATS_MAX_LOCKS) {
+    stats = &mutex_stats[count];
+    memset(stats, 0, sizeof(*stats));
+    stats->name = name;
+    // Publish the filled slot to lock-free readers
+    __atomic_store_n(&mutex_stats_count, count + 1, __ATOMIC_RELEASE);
+  }
+
+  __atomic_clear(&mutex_stats_busy, __ATOMIC_RELEASE);
+  return stats;
 }
-tt_error_t tt_mutex_destroy(tt_mutex_t *mutex) {
+
+static inline unsigned mutex_stats_bucket(uint64_t ns) {
+  if (ns == 0) {
+    return 0;
+  }
+  unsigned bucket = 63 - (unsigned)__builtin_clzll(ns);
+  return (bucket < TT_MUTEX_STATS_BUCKETS) ? bucket
+                                           : TT_MUTEX_STATS_BUCKETS - 1;
+}
+
+static void mutex_stats_acquired(tt_mutex_t *mutex, bool contended,
+                                 uint64_t wait_ns, uint64_t now_ns) {
+  tt_mutex_stats_t *stats = mutex->stats;
+  mutex->hold_start_ns = now_ns;
+  if (stats == NULL) {
+    return;
+  }
+
+  __atomic_fetch_add(&stats->acquisitions, 1, __ATOMIC_RELAXED);
+  if (!contended) {
+    return;
+  }
+
+  __atomic_fetch_add(&stats->contended, 1, __ATOMIC_RELAXED);
+  __atomic_fetch_add(&stats->wait_total_ns, wait_ns, __ATOMIC_RELAXED);
+  __atomic_fetch_add(&stats->wait_hist[mutex_stats_bucket(wait_ns)], 1,
+                     __ATOMIC_RELAXED);
+
+  uint64_t max = __atomic_load_n(&stats->wait_max_ns, __ATOMIC_RELAXED);
+  while (wait_ns > max &&
+         !__atomic_compare_exchange_n(&stats->wait_max_ns, &max, wait_ns, true,
+                                      __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+  }
+}
+
+/* Must be called while the mutex is still held */
+static void mutex_stats_releasing(tt_mutex_t *mutex) {
+  tt_mutex_stats_t *stats = mutex->stats;
+  if (stats == NULL) {
+    return;
+  }
+
+  uint64_t hold_ns = tt_platform_time_monotonic_ns() - mutex->hold_start_ns;
+  __atomic_fetch_add(&stats->hold_total_ns, hold_ns, __ATOMIC_RELAXED);
+  __atomic_fetch_add(&stats->hold_hist[mutex_stats_bucket(hold_ns)], 1,
+                     __ATOMIC_RELAXED);
+}
+
+static int mutex_stats_compare(const void *a, const void *b) {
+  const tt_mutex_stats_t *sa = (const tt_mutex_stats_t *)a;
+  const tt_mutex_stats_t *sb = (const tt_mutex_stats_t *)b;
+
+  if (sa->contended != sb->contended) {
+    return (sa->contended < sb->contended) ? 1 : -1;
+  }
+  if (sa->wait_total_ns != sb->wait_total_ns) {
+    return (sa->wait_total_ns < sb->wait_total_ns) ? 1 : -1;
+  }
+  return 0;
+}
+
+size_t tt_mutex_stats_snapshot(tt_mutex_stats_t *stats, size_t max) {
+  if (stats == NULL || max == 0) {
+    return 0;
+  }
+
+  size_t count = __atomic_load_n(&mutex_stats_count, __ATOMIC_ACQUIRE);
+  if (count == 0) {
+    return 0;
+  }
+
+  tt_mutex_stats_t *all =
+      (tt_mutex_stats_t *)malloc(count * sizeof(tt_mutex_stats_t));
+  if (all == NULL) {
+    return 0;
+  }
+
+  for (size_t i = 0; i < count; i++) {
+    const tt_mutex_stats_t *src = &mutex_stats[i];
+    tt_mutex_stats_t *dst = &all[i];
+
+    dst->name = src->name;
+    dst->acquisitions = __atomic_load_n(&src->acquisitions, __ATOMIC_RELAXED);
+    dst->contended = __atomic_load_n(&src->contended, __ATOMIC_RELAXED);
+    dst->wait_total_ns = __atomic_load_n(&src->wait_total_ns, __ATOMIC_RELAXED);
+    dst->wait_max_ns = __atomic_load_n(&src->wait_max_ns, __ATOMIC_RELAXED);
+    dst->hold_total_ns = __atomic_load_n(&src->hold_total_ns, __ATOMIC_RELAXED);
+    for (size_t b = 0; b < TT_MUTEX_STATS_BUCKETS; b++) {
+      dst->wait_hist[b] = __atomic_load_n(&src->wait_hist[b], __ATOMIC_RELAXED);
+      dst->hold_hist[b] = __atomic_load_n(&src->hold_hist[b], __ATOMIC_RELAXED);
+    }
+  }
+
+  qsort(all, count, sizeof(tt_mutex_stats_t), mutex_stats_compare);
+
+  size_t written = (count < max) ? count : max;
+  memcpy(stats, all, written * sizeof(tt_mutex_stats_t));
+  free(all);
+  return written;
+}
+
+static void mutex_stats_print_hist(const char *label, const uint32_t *hist) {
+  printf("    %s:", label);
+  for (size_t b = 0; b < TT_MUTEX_STATS_BUCKETS; b++) {
+    if (hist[b] != 0) {
+      printf(" <%lluns:%u", 2ULL << b, hist[b]);
+    }
+  }
+  printf("\n");
+}
+
+void tt_mutex_stats_dump(size_t top_n) {
+  tt_mutex_stats_t stats[TT_MUTEX_STATS_MAX_LOCKS];
+  size_t max = (top_n < TT_MUTEX_STATS_MAX_LOCKS) ? top_n
+                                                   : TT_MUTEX_STATS_MAX_LOCKS;
+  size_t count = tt_mutex_stats_snapshot(stats, max);
+
+  printf("Mutex contention (top %zu):\n", count);
+  for (size_t i = 0; i < count; i++) {
+    const tt_mutex_stats_t *s = &stats[i];
+    printf("  %-24s acq=%llu contended=%llu wait_total=%lluus "
+           "wait_max=%lluus hold_avg=%lluns\n",
+           s->name, (unsigned long long)s->acquisitions,
+           (unsigned long long)s->contended,
+           (unsigned long long)(s->wait_total_ns / 1000),
+           (unsigned long long)(s->wait_max_ns / 1000),
+           (unsigned long long)(s->acquisitions
+                                    ? s->hold_total_ns / s->acquisitions
+                                    : 0));
+    mutex_stats_print_hist("wait", s->wait_hist);
+    mutex_stats_print_hist("hold", s->hold_hist);
+  }
+}
+
+void tt_mutex_stats_reset(void) {
+  size_t count = __atomic_load_n(&mutex_stats_count, __ATOMIC_ACQUIRE);
+  // Field by field: lockers keep adding to them, and name stays valid
+  for (size_t i = 0; i < count; i++) {
+    tt_mutex_stats_t *stats = &mutex_stats[i];
+    __atomic_store_n(&stats->acquisitions, 0, __ATOMIC_RELAXED);
+    __atomic_store_n(&stats->contended, 0, __ATOMIC_RELAXED);
+    __atomic_store_n(&stats->wait_total_ns, 0, __ATOMIC_RELAXED);
+    __atomic_store_n(&stats->wait_max_ns, 0, __ATOMIC_RELAXED);
+    __atomic_store_n(&stats->hold_total_ns, 0, __ATOMIC_RELAXED);
+    for (size_t b = 0; b < TT_MUTEX_STATS_BUCKETS; b++) {
+      __atomic_store_n(&stats->wait_hist[b], 0, __ATOMIC_RELAXED);
+      __atomic_store_n(&stats->hold_hist[b], 0, __ATOMIC_RELAXED);
+    }
+  }
+}
+#endif /* TT_MUTEX_STATS */
+
+#if (defined(TT_TARGET_LINUX) || defined(TT_TARGET_FREERTOS)) &&                \
+    defined(TT_CAP_MUTEX)
+static inline tt_error_t mutex_init_impl(tt_mutex_t *mutex,
+                                         const tt_mutex_attr_t *attr) {
+  return tt_platform_mutex_init(mutex, attr);
+}
+static inline tt_error_t mutex_destroy_impl(tt_mutex_t *mutex) {
   return tt_platform_mutex_destroy(mutex);
 }
-tt_error_t tt_mutex_lock(tt_mutex_t *mutex) {
+static inline tt_error_t mutex_lock_impl(tt_mutex_t *mutex) {
   return tt_platform_mutex_lock(mutex);
 }
-tt_error_t tt_mutex_unlock(tt_mutex_t *mutex) {
+static inline tt_error_t mutex_unlock_impl(tt_mutex_t *mutex) {
   return tt_platform_mutex_unlock(mutex);
 }
-tt_error_t tt_mutex_trylock(tt_mutex_t *mutex) {
+static inline tt_error_t mutex_trylock_impl(tt_mutex_t *mutex) {
   return tt_platform_mutex_trylock(mutex);
 }
-bool tt_mutex_is_locked(tt_mutex_t *mutex) {
+static inline tt_error_t mutex_timedlock_impl(tt_mutex_t *mutex,
+                                              uint32_t timeout_ms) {
+  return tt_platform_mutex_timedlock(mutex, timeout_ms);
+}
+static inline bool mutex_is_locked_impl(tt_mutex_t *mutex) {
   return tt_platform_mutex_is_locked(mutex);
 }
 #else /* General non-platorm specific mutex implementation */
 
-tt_error_t tt_mutex_init(tt_mutex_t *mutex) {
+static tt_mutex_yield_hook_t mutex_yield_hook = NULL;
+
+void tt_mutex_set_yield_hook(tt_mutex_yield_hook_t hook) {
+  __atomic_store_n(&mutex_yield_hook, hook, __ATOMIC_RELEASE);
+}
+
+static inline bool mutex_try_acquire(tt_mutex_t *mutex) {
+  return __atomic_exchange_n(&mutex->lock, TT_MUTEX_LOCKED,
+                             __ATOMIC_ACQUIRE) == TT_MUTEX_UNLOCKED;
+}
+
+/*
+ * Test-and-test-and-set: waiters spin on a plain load, which stays in their
+ * own cache, and only issue the exchange once the lock looks free. Failed
+ * attempts back off exponentially, then hand the CPU to the yield hook.
+ */
+static bool mutex_spin_acquire(tt_mutex_t *mutex, uint64_t deadline_ns) {
+  uint32_t backoff = 1;
+
+  while (!mutex_try_acquire(mutex)) {
+    do {
+      if (deadline_ns != TT_PLATFORM_WAIT_FOREVER &&
+          tt_platform_time_monotonic_ns() >= deadline_ns) {
+        return false;
+      }
+
+      if (backoff < TT_MUTEX_SPIN_BACKOFF_MAX) {
+        for (uint32_t i = 0; i < backoff; i++) {
+          tt_atomic_cpu_relax();
+        }
+        backoff <<= 1;
+      } else {
+        tt_mutex_yield_hook_t hook =
+            __atomic_load_n(&mutex_yield_hook, __ATOMIC_ACQUIRE);
+        if (hook != NULL) {
+          hook();
+        } else {
+          tt_atomic_cpu_relax();
+        }
+      }
+    } while (__atomic_load_n(&mutex->lock, __ATOMIC_RELAXED) !=
+             TT_MUTEX_UNLOCKED);
+  }
+
+  return true;
+}
+
+static tt_error_t mutex_init_impl(tt_mutex_t *mutex,
+                                  const tt_mutex_attr_t *attr) {
   if (mutex == NULL) {
     return TT_ERROR_NULL_POINTER;
   }
 
+  /* No scheduler to boost the owner */
+  if (attr != NULL && attr->protocol != TT_MUTEX_PROTOCOL_NONE) {
+    return TT_ERROR_NOT_IMPLEMENTED;
+  }
+
   mutex->lock = TT_MUTEX_UNLOCKED;
   mutex->initialized = true;
   return TT_SUCCESS;
 }
 
-tt_error_t tt_mutex_destroy(tt_mutex_t *mutex) {
+static tt_error_t mutex_destroy_impl(tt_mutex_t *mutex) {
   if (mutex == NULL) {
     return TT_ERROR_NULL_POINTER;
   }
@@ -55,7 +306,7 @@ tt_error_t tt_mutex_destroy(tt_mutex_t *mutex) {
   return TT_SUCCESS;
 }
 
-tt_error_t tt_mutex_lock(tt_mutex_t *mutex) {
+static tt_error_t mutex_lock_impl(tt_mutex_t *mutex) {
   if (mutex == NULL) {
     return TT_ERROR_NULL_POINTER;
   }
@@ -64,15 +315,11 @@ tt_error_t tt_mutex_lock(tt_mutex_t *mutex) {
     return TT_ERROR_NOT_INITIALIZED;
   }
 
-  /* Basic spinlock implementation */
-  while (__atomic_test_and_set(&mutex->lock, __ATOMIC_SEQ_CST)) {
-    /* Wait until lock is available */
-  }
-
+  mutex_spin_acquire(mutex, TT_PLATFORM_WAIT_FOREVER);
   return TT_SUCCESS;
 }
 
-tt_error_t tt_mutex_unlock(tt_mutex_t *mutex) {
+static tt_error_t mutex_unlock_impl(tt_mutex_t *mutex) {
   if (mutex == NULL) {
     return TT_ERROR_NULL_POINTER;
   }
@@ -81,11 +328,11 @@ tt_error_t tt_mutex_unlock(tt_mutex_t *mutex) {
     return TT_ERROR_NOT_INITIALIZED;
   }
 
-  __atomic_clear(&mutex->lock, __ATOMIC_SEQ_CST);
+  __atomic_store_n(&mutex->lock, TT_MUTEX_UNLOCKED, __ATOMIC_RELEASE);
   return TT_SUCCESS;
 }
 
-tt_error_t tt_mutex_trylock(tt_mutex_t *mutex) {
+static tt_error_t mutex_trylock_impl(tt_mutex_t *mutex) {
   if (mutex == NULL) {
     return TT_ERROR_NULL_POINTER;
   }
@@ -94,23 +341,223 @@ tt_error_t tt_mutex_trylock(tt_mutex_t *mutex) {
     return TT_ERROR_NOT_INITIALIZED;
   }
 
-  if (__atomic_test_and_set(&mutex->lock, __ATOMIC_SEQ_CST)) {
+  // Skip the exchange, and the cache line steal, when the lock is held
+  if (__atomic_load_n(&mutex->lock, __ATOMIC_RELAXED) != TT_MUTEX_UNLOCKED ||
+      !mutex_try_acquire(mutex)) {
     return TT_ERROR_BUSY;
   }
 
   return TT_SUCCESS;
 }
 
-bool tt_mutex_is_locked(tt_mutex_t *mutex) {
+static tt_error_t mutex_timedlock_impl(tt_mutex_t *mutex,
+                                       uint32_t timeout_ms) {
+  if (mutex == NULL) {
+    return TT_ERROR_NULL_POINTER;
+  }
+
+  if (!mutex->initialized) {
+    return TT_ERROR_NOT_INITIALIZED;
+  }
+
+  uint64_t deadline_ns =
+      tt_platform_time_monotonic_ns() + (uint64_t)timeout_ms * 1000000ULL;
+  return mutex_spin_acquire(mutex, deadline_ns) ? TT_SUCCESS
+                                                : TT_ERROR_TIMEOUT;
+}
+
+static bool mutex_is_locked_impl(tt_mutex_t *mutex) {
   if (mutex == NULL || !mutex->initialized) {
     return false;
   }
 
-  if (__atomic_load_n(&mutex->lock, __ATOMIC_SEQ_CST)) {
-    return true;
+  // Only a hint, the state can change right after the load
+  return __atomic_load_n(&mutex->lock, __ATOMIC_RELAXED) != TT_MUTEX_UNLOCKED;
+}
+
+#endif /* (TT_TARGET_LINUX || TT_TARGET_FREERTOS) && TT_CAP_MUTEX */
+
+#if defined(TT_MUTEX_STATS)
+static tt_error_t mutex_lock_profiled(tt_mutex_t *mutex) {
+  tt_error_t result = mutex_trylock_impl(mutex);
+  if (result == TT_SUCCESS) {
+    mutex_stats_acquired(mutex, false, 0, tt_platform_time_monotonic_ns());
+    return TT_SUCCESS;
+  }
+  if (result != TT_ERROR_BUSY) {
+    return mutex_lock_impl(mutex);
+  }
+
+  uint64_t start_ns = tt_platform_time_monotonic_ns();
+  result = mutex_lock_impl(mutex);
+  if (result == TT_SUCCESS) {
+    uint64_t now_ns = tt_platform_time_monotonic_ns();
+    mutex_stats_acquired(mutex, true, now_ns - start_ns, now_ns);
+  }
+  return result;
+}
+
+static tt_error_t mutex_timedlock_profiled(tt_mutex_t *mutex,
+                                          uint32_t timeout_ms) {
+  tt_error_t result = mutex_trylock_impl(mutex);
+  if (result == TT_SUCCESS) {
+    mutex_stats_acquired(mutex, false, 0, tt_platform_time_monotonic_ns());
+    return TT_SUCCESS;
+  }
+  if (result != TT_ERROR_BUSY) {
+    return mutex_timedlock_impl(mutex, timeout_ms);
+  }
+
+  uint64_t start_ns = tt_platform_time_monotonic_ns();
+  result = mutex_timedlock_impl(mutex, timeout_ms);
+  if (result == TT_SUCCESS) {
+    uint64_t now_ns = tt_platform_time_monotonic_ns();
+    mutex_stats_acquired(mutex, true, now_ns - start_ns, now_ns);
+  }
+  return result;
+}
+#else
+static inline tt_error_t mutex_lock_profiled(tt_mutex_t *mutex) {
+  return mutex_lock_impl(mutex);
+}
+static inline tt_error_t mutex_timedlock_profiled(tt_mutex_t *mutex,
+                                                  uint32_t timeout_ms) {
+  return mutex_timedlock_impl(mutex, timeout_ms);
+}
+#endif /* TT_MUTEX_STATS */
+
+tt_error_t tt_mutex_init(tt_mutex_t *mutex) {
+  return tt_mutex_init_attr(mutex, NULL);
+}
+
+tt_error_t tt_mutex_init_named(tt_mutex_t *mutex, const char *name) {
+  tt_mutex_attr_t attr;
+  tt_mutex_attr_init(&attr);
+  attr.name = name;
+  return tt_mutex_init_attr(mutex, &attr);
+}
+
+tt_error_t tt_mutex_attr_init(tt_mutex_attr_t *attr) {
+  if (attr == NULL) {
+    return TT_ERROR_NULL_POINTER;
+  }
+
+  static const tt_mutex_attr_t default_attrs = {
+      .protocol = TT_MUTEX_PROTOCOL_NONE, .name = NULL};
+
+  *attr = default_attrs;
+  return TT_SUCCESS;
+}
+
+tt_error_t tt_mutex_init_attr(tt_mutex_t *mutex, const tt_mutex_attr_t *attr) {
+  if (attr != NULL && attr->protocol != TT_MUTEX_PROTOCOL_NONE &&
+      attr->protocol != TT_MUTEX_PROTOCOL_INHERIT) {
+    return TT_ERROR_INVALID_PARAM;
+  }
+
+  tt_error_t result = mutex_init_impl(mutex, attr);
+  if (result != TT_SUCCESS) {
+    return result;
+  }
+
+  const char *name = (attr != NULL) ? attr->name : NULL;
+#if defined(TT_MUTEX_STATS)
+  mutex->stats = mutex_stats_lookup(name);
+#endif
+#if defined(TT_LOCKDEP)
+  mutex->lockdep_class = tt_lockdep_register(mutex, name);
+#endif
+  (void)name;
+  return TT_SUCCESS;
+}
+
+tt_error_t tt_mutex_destroy(tt_mutex_t *mutex) {
+  tt_error_t result = mutex_destroy_impl(mutex);
+#if defined(TT_LOCKDEP)
+  if (result == TT_SUCCESS) {
+    tt_lockdep_unregister(mutex, mutex->lockdep_class);
+  }
+#endif
+  return result;
+}
+
+/* Parenthesized so the TT_LOCKDEP call-site macro does not expand here */
+tt_error_t(tt_mutex_lock)(tt_mutex_t *mutex) {
+#if defined(TT_LOCKDEP)
+  return tt_mutex_lock_at(mutex, NULL, 0);
+#else
+  return mutex_lock_profiled(mutex);
+#endif
+}
+
+#if defined(TT_LOCKDEP)
+tt_error_t tt_mutex_lock_at(tt_mutex_t *mutex, const char *file, int line) {
+  if (mutex == NULL || !mutex->initialized) {
+    return mutex_lock_impl(mutex);
   }
 
-  return false;
+  // Validate the order before blocking, so inversions are reported even
+  // when this acquisition would deadlock
+  tt_lockdep_acquire(mutex, mutex->lockdep_class, file, line, true);
+  tt_error_t result = mutex_lock_profiled(mutex);
+  if (result != TT_SUCCESS) {
+    tt_lockdep_release(mutex);
+  }
+  return result;
 }
+#endif /* TT_LOCKDEP */
 
-#endif /* TT_TARGET_LINUX && TT_CAP_MUTEX */
+tt_error_t tt_mutex_unlock(tt_mutex_t *mutex) {
+  if (mutex != NULL && mutex->initialized) {
+#if defined(TT_MUTEX_STATS)
+    mutex_stats_releasing(mutex);
+#endif
+#if defined(TT_LOCKDEP)
+    tt_lockdep_release(mutex);
+#endif
+  }
+  return mutex_unlock_impl(mutex);
+}
+
+tt_error_t tt_mutex_trylock(tt_mutex_t *mutex) {
+  tt_error_t result = mutex_trylock_impl(mutex);
+  if (result != TT_SUCCESS) {
+    return result;
+  }
+
+#if defined(TT_MUTEX_STATS)
+  mutex_stats_acquired(mutex, false, 0, tt_platform_time_monotonic_ns());
+#endif
+#if defined(TT_LOCKDEP)
+  tt_lockdep_acquire(mutex, mutex->lockdep_class, NULL, 0, false);
+#endif
+  return TT_SUCCESS;
+}
+
+tt_error_t(tt_mutex_timedlock)(tt_mutex_t *mutex, uint32_t timeout_ms) {
+#if defined(TT_LOCKDEP)
+  return tt_mutex_timedlock_at(mutex, timeout_ms, NULL, 0);
+#else
+  return mutex_timedlock_profiled(mutex, timeout_ms);
+#endif
+}
+
+#if defined(TT_LOCKDEP)
+tt_error_t tt_mutex_timedlock_at(tt_mutex_t *mutex, uint32_t timeout_ms,
+                                 const char *file, int line) {
+  if (mutex == NULL || !mutex->initialized) {
+    return mutex_timedlock_impl(mutex, timeout_ms);
+  }
+
+  tt_lockdep_acquire(mutex, mutex->lockdep_class, file, line, true);
+  tt_error_t result = mutex_timedlock_profiled(mutex, timeout_ms);
+  if (result != TT_SUCCESS) {
+    tt_lockdep_release(mutex);
+  }
+  return result;
+}
+#endif /* TT_LOCKDEP */
+
+bool tt_mutex_is_locked(tt_mutex_t *mutex) {
+  return mutex_is_locked_impl(mutex);
+}
@@ -0,0 +1,75 @@
+/**
+ * @file tt_once.c
+ * @author Mihai Gurei <mihai.gurei@protonmail.com>
+ * @date 2025-01-14
+ * @brief
+ * @copyright Copyright (c) 2025 AnAlphaBeta. All rights reserved.
+ */
+
+#include "tt_once.h"
+#include "tt_atomic.h"
+#include "tt_platform.h"
+#include "tt_types.h"
+#include <stddef.h>
+
+static void once_wait(tt_once_t *once) {
+#if defined(TT_CAP_THREADS)
+  tt_platform_futex_wait(&once->state, TT_ONCE_WAITING,
+                         TT_PLATFORM_WAIT_FOREVER);
+#else
+  (void)once;
+  tt_atomic_cpu_relax();
+#endif
+}
+
+tt_error_t tt_call_once_slow(tt_once_t *once, tt_once_func_t func) {
+  if (once == NULL || func == NULL) {
+    return TT_ERROR_NULL_POINTER;
+  }
+
+  uint32_t state = __atomic_load_n(&once->state, __ATOMIC_ACQUIRE);
+  for (;;) {
+    switch (state) {
+    case TT_ONCE_DONE:
+      return TT_SUCCESS;
+
+    case TT_ONCE_UNINIT:
+      if (__atomic_compare_exchange_n(&once->state, &state, TT_ONCE_RUNNING,
+                                      false, __ATOMIC_ACQUIRE,
+                                      __ATOMIC_ACQUIRE)) {
+        tt_error_t result = func();
+        // A failed run rearms the flag so a later caller can retry
+        uint32_t prev = __atomic_exchange_n(
+            &once->state,
+            (result == TT_SUCCESS) ? TT_ONCE_DONE : TT_ONCE_UNINIT,
+            __ATOMIC_ACQ_REL);
+#if defined(TT_CAP_THREADS)
+        if (prev == TT_ONCE_WAITING) {
+          tt_platform_futex_wake(&once->state, TT_PLATFORM_WAKE_ALL);
+        }
+#else
+        (void)prev;
+#endif
+        return result;
+      }
+      break;
+
+    case TT_ONCE_RUNNING:
+      // Tell the runner to wake us, then park
+      if (!__atomic_compare_exchange_n(&once->state, &state, TT_ONCE_WAITING,
+                                       false, __ATOMIC_ACQUIRE,
+                                       __ATOMIC_ACQUIRE)) {
+        break;
+      }
+      /* fall through */
+
+    case TT_ONCE_WAITING:
+      once_wait(once);
+      state = __atomic_load_n(&once->state, __ATOMIC_ACQUIRE);
+      break;
+
+    default:
+      return TT_ERROR_INVALID_PARAM;
+    }
+  }
+}
@@ -0,0 +1,220 @@
+/**
+ * @file tt_parallel.c
+ * @author Mihai Gurei <mihai.gurei@protonmail.com>
+ * @date 2025-02-03
+ * @brief
+ * @copyright Copyright (c) 2025 AnAlphaBeta. All rights reserved.
+ */
+
+#include "tt_parallel.h"
+#include "tt_once.h"
+#include "tt_platform.h"
+#include "tt_task.h"
+#include "tt_types.h"
+#include <string.h>
+
+/**
+ * @brief Shared description of one parallel call
+ */
+typedef struct {
+  size_t grain;
+  tt_parallel_for_func_t body;      /**< Set for tt_parallel_for*/
+  tt_parallel_reduce_func_t reduce; /**< Set for tt_parallel_reduce*/
+  tt_parallel_join_func_t join;
+  const void *identity;
+  size_t size;
+  void *ctx;
+} parallel_job_t;
+
+/**
+ * @brief Sub-range still to be processed
+ */
+typedef struct {
+  const parallel_job_t *job;
+  size_t begin;
+  size_t end;
+  void *acc;
+} parallel_range_t;
+
+static void parallel_leaf(const parallel_range_t *range) {
+  const parallel_job_t *job = range->job;
+
+  if (job->body != NULL) {
+    job->body(range->begin, range->end, job->ctx);
+  } else {
+    job->reduce(range->begin, range->end, range->acc, job->ctx);
+  }
+}
+
+#if defined(TT_CAP_THREADS)
+static tt_scheduler_t *parallel_scheduler;
+static size_t parallel_workers;
+static tt_once_t parallel_once = TT_ONCE_INIT;
+
+/* Split near the middle, on a TT_PARALLEL_SPLIT_ALIGN boundary if one fits */
+static size_t parallel_split(size_t begin, size_t end) {
+  size_t mid = begin + (end - begin) / 2;
+  size_t aligned = mid - mid % TT_PARALLEL_SPLIT_ALIGN;
+
+  if (aligned > begin) {
+    return aligned;
+  }
+  aligned += TT_PARALLEL_SPLIT_ALIGN;
+  return (aligned < end) ? aligned : mid;
+}
+
+static size_t parallel_grain(size_t count, size_t grain, size_t workers) {
+  if (grain == 0) {
+    grain = count / (workers * TT_PARALLEL_CHUNKS_PER_WORKER);
+    grain += TT_PARALLEL_SPLIT_ALIGN - 1;
+    grain -= grain % TT_PARALLEL_SPLIT_ALIGN;
+  }
+  return (grain > 0) ? grain : 1;
+}
+
+static tt_error_t parallel_init_once(void) {
+  tt_platform_info_t info;
+  size_t workers = 1;
+
+  tt_error_t result = tt_platform_init();
+  if (result != TT_SUCCESS && result != TT_ERROR_ALREADY_INITIALIZED) {
+    return result;
+  }
+  if (tt_platform_get_info(&info) == TT_SUCCESS &&
+      info.system.core_count > 0) {
+    workers = info.system.core_count;
+  }
+
+  result = tt_scheduler_create(&parallel_scheduler, workers, NULL);
+  if (result == TT_SUCCESS) {
+    parallel_workers = workers;
+  }
+  return result;
+}
+
+static void parallel_task(void *arg);
+
+/* Split until pieces fit the grain, spawning right halves as tasks */
+static void parallel_run(const parallel_range_t *range) {
+  const parallel_job_t *job = range->job;
+
+  if (range->end - range->begin <= job->grain) {
+    parallel_leaf(range);
+    return;
+  }
+
+  // Own cache line for the right half's partial result
+  _Alignas(64) unsigned char right_acc[TT_PARALLEL_REDUCE_MAX_SIZE];
+  size_t mid = parallel_split(range->begin, range->end);
+  parallel_range_t left = {job, range->begin, mid, range->acc};
+  parallel_range_t right = {job, mid, range->end, NULL};
+  tt_task_group_t group;
+
+  if (job->reduce != NULL) {
+    memcpy(right_acc, job->identity, job->size);
+    right.acc = right_acc;
+  }
+
+  tt_task_group_init(&group, parallel_scheduler);
+  if (tt_task_spawn(&group, parallel_task, &right) != TT_SUCCESS) {
+    // Out of memory: finish this half inline instead
+    parallel_run(&right);
+  }
+  parallel_run(&left);
+  tt_task_sync(&group);
+
+  if (job->reduce != NULL) {
+    job->join(range->acc, right_acc, job->ctx);
+  }
+}
+
+static void parallel_task(void *arg) { parallel_run((parallel_range_t *)arg); }
+
+static tt_error_t parallel_execute(parallel_job_t *job, size_t begin,
+                                   size_t end, size_t grain, void *acc) {
+  if (begin >= end) {
+    return TT_SUCCESS;
+  }
+
+  tt_error_t result = tt_call_once(&parallel_once, parallel_init_once);
+  if (result != TT_SUCCESS) {
+    return result;
+  }
+
+  parallel_range_t root = {job, begin, end, acc};
+  job->grain = parallel_grain(end - begin, grain, parallel_workers);
+
+  // Too small to be worth a hand-off
+  if (end - begin <= job->grain) {
+    parallel_leaf(&root);
+    return TT_SUCCESS;
+  }
+
+  tt_task_group_t group;
+  tt_task_group_init(&group, parallel_scheduler);
+  result = tt_task_spawn(&group, parallel_task, &root);
+  if (result != TT_SUCCESS) {
+    return result;
+  }
+  return tt_task_sync(&group);
+}
+
+tt_error_t tt_parallel_cleanup(void) {
+  if (!tt_once_is_done(&parallel_once)) {
+    return TT_ERROR_NOT_INITIALIZED;
+  }
+
+  tt_error_t result = tt_scheduler_destroy(parallel_scheduler);
+  parallel_scheduler = NULL;
+  parallel_workers = 0;
+  tt_once_reset(&parallel_once);
+  return result;
+}
+
+#else
+static tt_error_t parallel_execute(parallel_job_t *job, size_t begin,
+                                   size_t end,
+                                   size_t grain __attribute__((unused)),
+                                   void *acc) {
+  if (begin >= end) {
+    return TT_SUCCESS;
+  }
+
+  // No workers, one call over the whole range
+  parallel_range_t root = {job, begin, end, acc};
+  parallel_leaf(&root);
+  return TT_SUCCESS;
+}
+
+tt_error_t tt_parallel_cleanup(void) { return TT_SUCCESS; }
+#endif /* TT_CAP_THREADS */
+
+tt_error_t tt_parallel_for(size_t begin, size_t end, size_t grain,
+                           tt_parallel_for_func_t func, void *ctx) {
+  if (func == NULL) {
+    return TT_ERROR_NULL_POINTER;
+  }
+
+  parallel_job_t job = {.body = func, .ctx = ctx};
+  return parallel_execute(&job, begin, end, grain, NULL);
+}
+
+tt_error_t tt_parallel_reduce(size_t begin, size_t end, size_t grain,
+                              void *result, size_t size, const void *identity,
+                              tt_parallel_reduce_func_t reduce,
+                              tt_parallel_join_func_t join, void *ctx) {
+  if (result == NULL || identity == NULL || reduce == NULL || join == NULL) {
+    return TT_ERROR_NULL_POINTER;
+  }
+
+  if (size == 0 || size > TT_PARALLEL_REDUCE_MAX_SIZE) {
+    return TT_ERROR_INVALID_PARAM;
+  }
+
+  parallel_job_t job = {.reduce = reduce,
+                        .join = join,
+                        .identity = identity,
+                        .size = size,
+                        .ctx = ctx};
+  return parallel_execute(&job, begin, end, grain, result);
+}
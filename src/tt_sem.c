@@ -0,0 +1,153 @@
+/**
+ * @file tt_sem.c
+ * @author Mihai Gurei <mihai.gurei@protonmail.com>
+ * @date 2025-01-12
+ * @brief
+ * @copyright Copyright (c) 2025 AnAlphaBeta. All rights reserved.
+ */
+
+#include "tt_sem.h"
+#include "tt_platform.h"
+#include "tt_types.h"
+#include <stddef.h>
+
+static bool sem_try_acquire(tt_sem_t *sem) {
+  uint32_t count = __atomic_load_n(&sem->count, __ATOMIC_RELAXED);
+  while (count > 0) {
+    if (__atomic_compare_exchange_n(&sem->count, &count, count - 1, true,
+                                    __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+static tt_error_t sem_wait_until(tt_sem_t *sem, uint64_t deadline_ns) {
+  while (!sem_try_acquire(sem)) {
+    tt_error_t result;
+
+#if defined(TT_CAP_THREADS)
+    // Safe point for tt_thread_suspend, nothing is held here
+    tt_platform_thread_checkpoint();
+#endif
+
+    // Announce ourselves before sleeping. Paired with the SEQ_CST increment
+    // and waiters load in tt_sem_post: either the poster sees us, or the
+    // futex sees a non-zero count and does not sleep.
+    __atomic_fetch_add(&sem->waiters, 1, __ATOMIC_SEQ_CST);
+#if defined(TT_CAP_THREADS)
+    result = tt_platform_futex_wait(&sem->count, 0, deadline_ns);
+#else
+    // No blocking primitive: spin, units are posted from interrupt context
+    result = (deadline_ns != TT_PLATFORM_WAIT_FOREVER &&
+              tt_platform_time_monotonic_ns() >= deadline_ns)
+                 ? TT_ERROR_TIMEOUT
+                 : TT_SUCCESS;
+#endif
+    __atomic_fetch_sub(&sem->waiters, 1, __ATOMIC_RELAXED);
+
+    if (result == TT_ERROR_TIMEOUT) {
+      return sem_try_acquire(sem) ? TT_SUCCESS : TT_ERROR_TIMEOUT;
+    }
+  }
+
+  return TT_SUCCESS;
+}
+
+tt_error_t tt_sem_init(tt_sem_t *sem, uint32_t initial_count) {
+  if (sem == NULL) {
+    return TT_ERROR_NULL_POINTER;
+  }
+
+  sem->count = initial_count;
+  sem->waiters = 0;
+  sem->initialized = true;
+  return TT_SUCCESS;
+}
+
+tt_error_t tt_sem_destroy(tt_sem_t *sem) {
+  if (sem == NULL) {
+    return TT_ERROR_NULL_POINTER;
+  }
+
+  if (!sem->initialized) {
+    return TT_ERROR_NOT_INITIALIZED;
+  }
+
+  if (__atomic_load_n(&sem->waiters, __ATOMIC_ACQUIRE) > 0) {
+    return TT_ERROR_BUSY;
+  }
+
+  sem->initialized = false;
+  return TT_SUCCESS;
+}
+
+tt_error_t tt_sem_post(tt_sem_t *sem) {
+  if (sem == NULL) {
+    return TT_ERROR_NULL_POINTER;
+  }
+
+  if (!sem->initialized) {
+    return TT_ERROR_NOT_INITIALIZED;
+  }
+
+  __atomic_fetch_add(&sem->count, 1, __ATOMIC_SEQ_CST);
+#if defined(TT_CAP_THREADS)
+  if (__atomic_load_n(&sem->waiters, __ATOMIC_SEQ_CST) > 0) {
+    return tt_platform_futex_wake(&sem->count, 1);
+  }
+#endif
+
+  return TT_SUCCESS;
+}
+
+tt_error_t tt_sem_wait(tt_sem_t *sem) {
+  if (sem == NULL) {
+    return TT_ERROR_NULL_POINTER;
+  }
+
+  if (!sem->initialized) {
+    return TT_ERROR_NOT_INITIALIZED;
+  }
+
+  return sem_wait_until(sem, TT_PLATFORM_WAIT_FOREVER);
+}
+
+tt_error_t tt_sem_trywait(tt_sem_t *sem) {
+  if (sem == NULL) {
+    return TT_ERROR_NULL_POINTER;
+  }
+
+  if (!sem->initialized) {
+    return TT_ERROR_NOT_INITIALIZED;
+  }
+
+  return sem_try_acquire(sem) ? TT_SUCCESS : TT_ERROR_BUSY;
+}
+
+tt_error_t tt_sem_timedwait(tt_sem_t *sem, uint32_t timeout_ms) {
+  if (sem == NULL) {
+    return TT_ERROR_NULL_POINTER;
+  }
+
+  if (!sem->initialized) {
+    return TT_ERROR_NOT_INITIALIZED;
+  }
+
+  // Fast path: skip the clock read when a unit is available
+  if (sem_try_acquire(sem)) {
+    return TT_SUCCESS;
+  }
+
+  uint64_t deadline_ns =
+      tt_platform_time_monotonic_ns() + (uint64_t)timeout_ms * 1000000ULL;
+  return sem_wait_until(sem, deadline_ns);
+}
+
+uint32_t tt_sem_get_value(const tt_sem_t *sem) {
+  if (sem == NULL) {
+    return 0;
+  }
+
+  return __atomic_load_n(&sem->count, __ATOMIC_RELAXED);
+}
@@ -0,0 +1,541 @@
+/**
+ * @file tt_task.c
+ * @author Mihai Gurei <mihai.gurei@protonmail.com>
+ * @date 2025-01-27
+ * @brief
+ * @copyright Copyright (c) 2025 AnAlphaBeta. All rights reserved.
+ */
+
+#include "tt_task.h"
+#include "tt_atomic.h"
+#include "tt_mutex.h"
+#include "tt_thread.h"
+#include "tt_types.h"
+#include <stdlib.h>
+
+#if defined(TT_CAP_THREADS)
+/* Set in tt_task_group_t.pending while a thread is parked in tt_task_sync */
+#define TASK_GROUP_WAITER 0x80000000u
+#define TASK_GROUP_COUNT_MASK (~TASK_GROUP_WAITER)
+
+/**
+ * @brief Spawned task
+ */
+typedef struct tt_task_t {
+  tt_task_func_t func;
+  void *arg;
+  tt_task_group_t *group;
+  struct tt_task_t *next; /**< Injection queue link*/
+} tt_task_t;
+
+/**
+ * @brief Circular deque storage
+ *
+ * Arrays replaced by a resize stay alive on the prev chain until the deque is
+ * destroyed, since a thief may still be reading them.
+ */
+typedef struct tt_task_array_t {
+  int64_t mask;
+  struct tt_task_array_t *prev;
+  tt_task_t *slots[];
+} tt_task_array_t;
+
+/**
+ * @brief Chase-Lev work-stealing deque
+ *
+ * Only the owner touches bottom; thieves race on top with a CAS.
+ */
+typedef struct {
+  _Alignas(64) volatile int64_t top;
+  _Alignas(64) volatile int64_t bottom;
+  tt_task_array_t *volatile array;
+} tt_task_deque_t;
+
+/**
+ * @brief Scheduler worker
+ */
+typedef struct {
+  tt_task_deque_t deque;
+  tt_scheduler_t *scheduler;
+  tt_thread_t *thread;
+  uint32_t rng; /**< Victim selection state*/
+  size_t index;
+} tt_task_worker_t;
+
+struct tt_scheduler_t {
+  tt_task_worker_t *workers;
+  size_t num_workers;
+  tt_mutex_t inject_lock;       /**< Guards the injection queue*/
+  tt_task_t *inject_head;       /**< Tasks spawned by non-workers*/
+  tt_task_t *inject_tail;
+  volatile uint32_t inject_count;
+  volatile uint32_t wake_seq;   /**< Idle wait word, bumped to wake*/
+  volatile uint32_t sleepers;   /**< Workers parked on wake_seq*/
+  volatile bool stop;
+};
+
+/* Worker running on the calling thread, NULL outside any scheduler */
+static _Thread_local tt_task_worker_t *current_worker;
+
+static tt_task_array_t *task_array_create(int64_t size) {
+  tt_task_array_t *array =
+      malloc(sizeof(*array) + (size_t)size * sizeof(tt_task_t *));
+  if (array != NULL) {
+    array->mask = size - 1;
+    array->prev = NULL;
+  }
+  return array;
+}
+
+static bool deque_push(tt_task_deque_t *deque, tt_task_t *task) {
+  int64_t bottom = __atomic_load_n(&deque->bottom, __ATOMIC_RELAXED);
+  int64_t top = __atomic_load_n(&deque->top, __ATOMIC_ACQUIRE);
+  tt_task_array_t *array = __atomic_load_n(&deque->array, __ATOMIC_RELAXED);
+
+  if (bottom - top > array->mask) {
+    tt_task_array_t *grown = task_array_create(2 * (array->mask + 1));
+    if (grown == NULL) {
+      return false;
+    }
+    for (int64_t i = top; i < bottom; i++) {
+      grown->slots[i & grown->mask] = array->slots[i & array->mask];
+    }
+    grown->prev = array;
+    __atomic_store_n(&deque->array, grown, __ATOMIC_RELEASE);
+    array = grown;
+  }
+
+  __atomic_store_n(&array->slots[bottom & array->mask], task, __ATOMIC_RELAXED);
+  // Pairs with the acquire load of bottom in deque_steal
+  __atomic_store_n(&deque->bottom, bottom + 1, __ATOMIC_RELEASE);
+  return true;
+}
+
+static tt_task_t *deque_take(tt_task_deque_t *deque) {
+  int64_t bottom = __atomic_load_n(&deque->bottom, __ATOMIC_RELAXED) - 1;
+  tt_task_array_t *array = __atomic_load_n(&deque->array, __ATOMIC_RELAXED);
+  __atomic_store_n(&deque->bottom, bottom, __ATOMIC_RELAXED);
+  __atomic_thread_fence(__ATOMIC_SEQ_CST);
+  int64_t top = __atomic_load_n(&deque->top, __ATOMIC_RELAXED);
+
+  if (top > bottom) {
+    // Empty
+    __atomic_store_n(&deque->bottom, bottom + 1, __ATOMIC_RELAXED);
+    return NULL;
+  }
+
+  tt_task_t *task =
+      __atomic_load_n(&array->slots[bottom & array->mask], __ATOMIC_RELAXED);
+  if (top == bottom) {
+    // Last task, race any thief for it
+    if (!__atomic_compare_exchange_n(&deque->top, &top, top + 1, false,
+                                     __ATOMIC_SEQ_CST, __ATOMIC_RELAXED)) {
+      task = NULL;
+    }
+    __atomic_store_n(&deque->bottom, bottom + 1, __ATOMIC_RELAXED);
+  }
+  return task;
+}
+
+static tt_task_t *deque_steal(tt_task_deque_t *deque) {
+  int64_t top = __atomic_load_n(&deque->top, __ATOMIC_ACQUIRE);
+  __atomic_thread_fence(__ATOMIC_SEQ_CST);
+  int64_t bottom = __atomic_load_n(&deque->bottom, __ATOMIC_ACQUIRE);
+
+  if (top >= bottom) {
+    return NULL;
+  }
+
+  tt_task_array_t *array = __atomic_load_n(&deque->array, __ATOMIC_ACQUIRE);
+  tt_task_t *task =
+      __atomic_load_n(&array->slots[top & array->mask], __ATOMIC_RELAXED);
+  if (!__atomic_compare_exchange_n(&deque->top, &top, top + 1, false,
+                                   __ATOMIC_SEQ_CST, __ATOMIC_RELAXED)) {
+    // Lost to the owner or another thief
+    return NULL;
+  }
+  return task;
+}
+
+static bool deque_is_empty(tt_task_deque_t *deque) {
+  int64_t top = __atomic_load_n(&deque->top, __ATOMIC_SEQ_CST);
+  int64_t bottom = __atomic_load_n(&deque->bottom, __ATOMIC_SEQ_CST);
+  return top >= bottom;
+}
+
+static tt_task_t *inject_pop(tt_scheduler_t *scheduler) {
+  if (__atomic_load_n(&scheduler->inject_count, __ATOMIC_ACQUIRE) == 0) {
+    return NULL;
+  }
+
+  tt_mutex_lock(&scheduler->inject_lock);
+  tt_task_t *task = scheduler->inject_head;
+  if (task != NULL) {
+    scheduler->inject_head = task->next;
+    if (scheduler->inject_head == NULL) {
+      scheduler->inject_tail = NULL;
+    }
+    __atomic_fetch_sub(&scheduler->inject_count, 1, __ATOMIC_RELAXED);
+  }
+  tt_mutex_unlock(&scheduler->inject_lock);
+  return task;
+}
+
+/* Wake one parked worker if there is any; called after publishing a task */
+static void scheduler_notify(tt_scheduler_t *scheduler) {
+  // Paired with the SEQ_CST sleepers increment in worker_park: either we see
+  // the sleeper, or it sees the task we just published
+  __atomic_thread_fence(__ATOMIC_SEQ_CST);
+  if (__atomic_load_n(&scheduler->sleepers, __ATOMIC_RELAXED) > 0) {
+    __atomic_fetch_add(&scheduler->wake_seq, 1, __ATOMIC_RELEASE);
+    tt_platform_futex_wake(&scheduler->wake_seq, 1);
+  }
+}
+
+static bool scheduler_has_work(tt_scheduler_t *scheduler) {
+  if (__atomic_load_n(&scheduler->inject_count, __ATOMIC_SEQ_CST) > 0) {
+    return true;
+  }
+  for (size_t i = 0; i < scheduler->num_workers; i++) {
+    if (!deque_is_empty(&scheduler->workers[i].deque)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+static tt_task_t *worker_steal(tt_task_worker_t *worker) {
+  tt_scheduler_t *scheduler = worker->scheduler;
+  tt_task_t *task;
+
+  for (size_t attempt = 0; attempt < 2 * scheduler->num_workers; attempt++) {
+    // xorshift32
+    uint32_t x = worker->rng;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    worker->rng = x;
+
+    size_t victim = x % scheduler->num_workers;
+    if (victim != worker->index &&
+        (task = deque_steal(&scheduler->workers[victim].deque)) != NULL) {
+      return task;
+    }
+  }
+  return inject_pop(scheduler);
+}
+
+static tt_task_t *worker_find_task(tt_task_worker_t *worker) {
+  tt_task_t *task = deque_take(&worker->deque);
+  return (task != NULL) ? task : worker_steal(worker);
+}
+
+static void task_run(tt_task_t *task) {
+  tt_task_group_t *group = task->group;
+
+  task->func(task->arg);
+  free(task);
+
+  // The group may go out of scope as soon as its count drops to zero, so the
+  // wake only uses its address
+  uint32_t old = __atomic_fetch_sub(&group->pending, 1, __ATOMIC_ACQ_REL);
+  if (old == (TASK_GROUP_WAITER | 1)) {
+    tt_platform_futex_wake(&group->pending, TT_PLATFORM_WAKE_ALL);
+  }
+}
+
+static void worker_park(tt_task_worker_t *worker) {
+  tt_scheduler_t *scheduler = worker->scheduler;
+  uint32_t seq = __atomic_load_n(&scheduler->wake_seq, __ATOMIC_ACQUIRE);
+
+  __atomic_fetch_add(&scheduler->sleepers, 1, __ATOMIC_SEQ_CST);
+  if (!scheduler_has_work(scheduler) &&
+      !__atomic_load_n(&scheduler->stop, __ATOMIC_ACQUIRE)) {
+    tt_platform_futex_wait(&scheduler->wake_seq, seq, TT_PLATFORM_WAIT_FOREVER);
+  }
+  __atomic_fetch_sub(&scheduler->sleepers, 1, __ATOMIC_RELAXED);
+}
+
+static void *task_worker(void *arg) {
+  tt_task_worker_t *worker = (tt_task_worker_t *)arg;
+  uint32_t idle = 0;
+
+  current_worker = worker;
+
+  for (;;) {
+    tt_task_t *task = worker_find_task(worker);
+    if (task != NULL) {
+      task_run(task);
+      idle = 0;
+      continue;
+    }
+
+    if (__atomic_load_n(&worker->scheduler->stop, __ATOMIC_ACQUIRE)) {
+      break;
+    }
+
+    if (++idle < TT_TASK_SPIN_COUNT) {
+      tt_atomic_cpu_relax();
+    } else {
+      worker_park(worker);
+      idle = 0;
+    }
+  }
+
+  current_worker = NULL;
+  return NULL;
+}
+
+static void scheduler_free(tt_scheduler_t *scheduler) {
+  for (size_t i = 0; i < scheduler->num_workers; i++) {
+    tt_task_array_t *array = scheduler->workers[i].deque.array;
+    while (array != NULL) {
+      tt_task_array_t *prev = array->prev;
+      free(array);
+      array = prev;
+    }
+  }
+  tt_mutex_destroy(&scheduler->inject_lock);
+  free(scheduler->workers);
+  free(scheduler);
+}
+
+/* Stop and join the first started workers */
+static tt_error_t scheduler_stop(tt_scheduler_t *scheduler, size_t started) {
+  tt_error_t result = TT_SUCCESS;
+
+  __atomic_store_n(&scheduler->stop, true, __ATOMIC_RELEASE);
+  __atomic_fetch_add(&scheduler->wake_seq, 1, __ATOMIC_SEQ_CST);
+  tt_platform_futex_wake(&scheduler->wake_seq, TT_PLATFORM_WAKE_ALL);
+
+  for (size_t i = 0; i < started; i++) {
+    tt_error_t join_result = tt_thread_join(scheduler->workers[i].thread, NULL);
+    if (join_result == TT_SUCCESS) {
+      tt_thread_destroy(scheduler->workers[i].thread);
+    } else if (result == TT_SUCCESS) {
+      result = join_result;
+    }
+  }
+  return result;
+}
+
+tt_error_t tt_scheduler_create(tt_scheduler_t **scheduler, size_t num_workers,
+                               const tt_thread_attr_t *attr) {
+  if (scheduler == NULL) {
+    return TT_ERROR_NULL_POINTER;
+  }
+
+  if (num_workers == 0) {
+    return TT_ERROR_INVALID_PARAM;
+  }
+
+  tt_error_t result = tt_thread_init();
+  if (result != TT_SUCCESS) {
+    return result;
+  }
+
+  tt_scheduler_t *new_scheduler = calloc(1, sizeof(*new_scheduler));
+  if (new_scheduler == NULL) {
+    return TT_ERROR_MEMORY;
+  }
+
+  new_scheduler->workers =
+      aligned_alloc(_Alignof(tt_task_worker_t),
+                    num_workers * sizeof(*new_scheduler->workers));
+  if (new_scheduler->workers == NULL) {
+    free(new_scheduler);
+    return TT_ERROR_MEMORY;
+  }
+
+  result = tt_mutex_init_named(&new_scheduler->inject_lock, "tt_task_inject");
+  if (result != TT_SUCCESS) {
+    free(new_scheduler->workers);
+    free(new_scheduler);
+    return result;
+  }
+
+  int64_t size = 1;
+  while (size < TT_TASK_DEQUE_SIZE) {
+    size <<= 1;
+  }
+
+  for (size_t i = 0; i < num_workers; i++) {
+    tt_task_worker_t *worker = &new_scheduler->workers[i];
+    worker->deque.top = 0;
+    worker->deque.bottom = 0;
+    worker->deque.array = task_array_create(size);
+    worker->scheduler = new_scheduler;
+    worker->thread = NULL;
+    worker->rng = (uint32_t)(i + 1) * 0x9E3779B9u;
+    worker->index = i;
+    new_scheduler->num_workers++;
+    if (worker->deque.array == NULL) {
+      scheduler_free(new_scheduler);
+      return TT_ERROR_MEMORY;
+    }
+  }
+
+  for (size_t i = 0; i < num_workers; i++) {
+    result = tt_thread_create(&new_scheduler->workers[i].thread, attr,
+                              task_worker, &new_scheduler->workers[i]);
+    if (result != TT_SUCCESS) {
+      scheduler_stop(new_scheduler, i);
+      scheduler_free(new_scheduler);
+      return result;
+    }
+  }
+
+  *scheduler = new_scheduler;
+  return TT_SUCCESS;
+}
+
+tt_error_t tt_scheduler_destroy(tt_scheduler_t *scheduler) {
+  if (scheduler == NULL) {
+    return TT_ERROR_NULL_POINTER;
+  }
+
+  tt_error_t result = scheduler_stop(scheduler, scheduler->num_workers);
+
+  // Nothing should be left, but do not leak tasks that were never synced
+  tt_task_t *task;
+  while ((task = inject_pop(scheduler)) != NULL) {
+    free(task);
+  }
+  for (size_t i = 0; i < scheduler->num_workers; i++) {
+    while ((task = deque_steal(&scheduler->workers[i].deque)) != NULL) {
+      free(task);
+    }
+  }
+
+  scheduler_free(scheduler);
+  return result;
+}
+
+tt_error_t tt_task_group_init(tt_task_group_t *group,
+                              tt_scheduler_t *scheduler) {
+  if (group == NULL || scheduler == NULL) {
+    return TT_ERROR_NULL_POINTER;
+  }
+
+  group->scheduler = scheduler;
+  group->pending = 0;
+  return TT_SUCCESS;
+}
+
+tt_error_t tt_task_spawn(tt_task_group_t *group, tt_task_func_t func,
+                         void *arg) {
+  if (group == NULL || func == NULL) {
+    return TT_ERROR_NULL_POINTER;
+  }
+
+  tt_task_t *task = malloc(sizeof(*task));
+  if (task == NULL) {
+    return TT_ERROR_MEMORY;
+  }
+  task->func = func;
+  task->arg = arg;
+  task->group = group;
+  task->next = NULL;
+
+  tt_scheduler_t *scheduler = group->scheduler;
+  tt_task_worker_t *worker = current_worker;
+
+  __atomic_fetch_add(&group->pending, 1, __ATOMIC_RELAXED);
+
+  if (worker != NULL && worker->scheduler == scheduler) {
+    if (!deque_push(&worker->deque, task)) {
+      __atomic_fetch_sub(&group->pending, 1, __ATOMIC_RELAXED);
+      free(task);
+      return TT_ERROR_MEMORY;
+    }
+  } else {
+    tt_mutex_lock(&scheduler->inject_lock);
+    if (scheduler->inject_tail != NULL) {
+      scheduler->inject_tail->next = task;
+    } else {
+      scheduler->inject_head = task;
+    }
+    scheduler->inject_tail = task;
+    __atomic_fetch_add(&scheduler->inject_count, 1, __ATOMIC_RELEASE);
+    tt_mutex_unlock(&scheduler->inject_lock);
+  }
+
+  scheduler_notify(scheduler);
+  return TT_SUCCESS;
+}
+
+tt_error_t tt_task_sync(tt_task_group_t *group) {
+  if (group == NULL) {
+    return TT_ERROR_NULL_POINTER;
+  }
+
+  tt_task_worker_t *worker = current_worker;
+  if (worker != NULL && worker->scheduler != group->scheduler) {
+    worker = NULL;
+  }
+
+  uint32_t idle = 0;
+  uint32_t pending;
+  while (((pending = __atomic_load_n(&group->pending, __ATOMIC_ACQUIRE)) &
+          TASK_GROUP_COUNT_MASK) != 0) {
+    // Help out instead of blocking the worker
+    if (worker != NULL) {
+      tt_task_t *task = worker_find_task(worker);
+      if (task != NULL) {
+        task_run(task);
+        idle = 0;
+        continue;
+      }
+      if (++idle < TT_TASK_SPIN_COUNT) {
+        tt_atomic_cpu_relax();
+        continue;
+      }
+    }
+
+    // Nothing to run: the remaining tasks are running elsewhere
+    if (!(pending & TASK_GROUP_WAITER) &&
+        !__atomic_compare_exchange_n(&group->pending, &pending,
+                                     pending | TASK_GROUP_WAITER, false,
+                                     __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+      continue;
+    }
+    tt_platform_futex_wait(&group->pending, pending | TASK_GROUP_WAITER,
+                           TT_PLATFORM_WAIT_FOREVER);
+    idle = 0;
+  }
+
+  // Every task has dropped its reference, clear the waiter flag for reuse
+  __atomic_store_n(&group->pending, 0, __ATOMIC_RELAXED);
+  return TT_SUCCESS;
+}
+
+#else
+tt_error_t tt_scheduler_create(tt_scheduler_t **scheduler,
+                               size_t num_workers __attribute__((unused)),
+                               const tt_thread_attr_t *attr
+                               __attribute__((unused))) {
+  return (scheduler == NULL) ? TT_ERROR_NULL_POINTER
+                             : TT_ERROR_NOT_IMPLEMENTED;
+}
+
+tt_error_t tt_scheduler_destroy(tt_scheduler_t *scheduler
+                                __attribute__((unused))) {
+  return TT_ERROR_NOT_IMPLEMENTED;
+}
+
+tt_error_t tt_task_group_init(tt_task_group_t *group __attribute__((unused)),
+                              tt_scheduler_t *scheduler
+                              __attribute__((unused))) {
+  return TT_ERROR_NOT_IMPLEMENTED;
+}
+
+tt_error_t tt_task_spawn(tt_task_group_t *group __attribute__((unused)),
+                         tt_task_func_t func __attribute__((unused)),
+                         void *arg __attribute__((unused))) {
+  return TT_ERROR_NOT_IMPLEMENTED;
+}
+
+tt_error_t tt_task_sync(tt_task_group_t *group __attribute__((unused))) {
+  return TT_ERROR_NOT_IMPLEMENTED;
+}
+#endif /* TT_CAP_THREADS */
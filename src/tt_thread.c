@@ -7,6 +7,7 @@
  */
 
 #include "tt_thread.h"
+#include "tt_once.h"
 #include "tt_types.h"
 
 #include <stdlib.h>
@@ -46,7 +47,11 @@
 /*   return thread->retval; */
 /* } */
 
-tt_error_t tt_thread_init(void) { return tt_thread_table_init(); }
+static tt_once_t thread_once = TT_ONCE_INIT;
+
+tt_error_t tt_thread_init(void) {
+  return tt_call_once(&thread_once, tt_thread_table_init);
+}
 
 tt_error_t tt_thread_attr_init(tt_thread_attr_t *attr) {
   if (attr == NULL) {
@@ -56,7 +61,9 @@ tt_error_t tt_thread_attr_init(tt_thread_attr_t *attr) {
   static const tt_thread_attr_t default_attrs = {
       .priority = TT_THREAD_PRIORITY_NORMAL,
       .stack_size = TT_DEFAULT_STACK_SIZE,
-      .name = "tt_thread"};
+      .name = "tt_thread",
+      .affinity = 0,
+      .numa_mask = 0};
 
   *attr = default_attrs;
   return TT_SUCCESS;
@@ -68,7 +75,7 @@ tt_error_t tt_thread_create(tt_thread_t **thread, const tt_thread_attr_t *attr,
     return TT_ERROR_NULL_POINTER;
   }
 
-  tt_thread_t *new_thread = (tt_thread_t *)malloc(sizeof(tt_thread_t));
+  tt_thread_t *new_thread = tt_thread_alloc();
   if (new_thread == NULL) {
     return TT_ERROR_MEMORY;
   }
@@ -80,23 +87,33 @@ tt_error_t tt_thread_create(tt_thread_t **thread, const tt_thread_attr_t *attr,
   new_thread->stack_size = attr ? attr->stack_size : TT_DEFAULT_STACK_SIZE;
   new_thread->priority = attr ? attr->priority : TT_THREAD_PRIORITY_NORMAL;
   new_thread->name = attr ? attr->name : "tt_thread";
+  new_thread->numa_mask = attr ? attr->numa_mask : 0;
+  new_thread->suspend_request = 0;
 
   tt_error_t result = tt_platform_thread_create(new_thread, attr, func, arg);
   if (result != TT_SUCCESS) {
-    free(new_thread);
+    tt_thread_free(new_thread);
     return result;
   }
 
   result = tt_thread_table_register(new_thread);
   if (result != TT_SUCCESS) {
     tt_platform_thread_destroy(new_thread);
-    free(new_thread);
+    tt_thread_free(new_thread);
     return result;
   }
   *thread = new_thread;
   return TT_SUCCESS;
 }
 
+tt_error_t tt_thread_cache_init(size_t capacity) {
+  return tt_platform_thread_cache_init(capacity);
+}
+
+tt_error_t tt_thread_cache_cleanup(void) {
+  return tt_platform_thread_cache_cleanup();
+}
+
 tt_error_t tt_thread_join(tt_thread_t *thread, void **retval) {
   return tt_platform_thread_join(thread, retval);
 }
@@ -107,7 +124,8 @@ tt_error_t tt_thread_get_state(const tt_thread_t *thread,
     return TT_ERROR_NULL_POINTER;
   }
 
-  *state = thread->state;
+  // Written by the thread itself when it parks or resumes
+  *state = __atomic_load_n(&thread->state, __ATOMIC_ACQUIRE);
   return TT_SUCCESS;
 }
 
@@ -117,6 +135,10 @@ tt_error_t tt_thread_set_priority(tt_thread_t *thread,
   return tt_platform_thread_set_priority(thread, priority);
 }
 
+tt_error_t tt_thread_set_affinity(tt_thread_t *thread, uint64_t affinity) {
+  return tt_platform_thread_set_affinity(thread, affinity);
+}
+
 tt_error_t tt_thread_suspend(tt_thread_t *thread) {
   return tt_platform_thread_suspend(thread);
 }
@@ -125,6 +147,10 @@ tt_error_t tt_thread_resume(tt_thread_t *thread) {
   return tt_platform_thread_resume(thread);
 }
 
+tt_error_t tt_thread_checkpoint(void) {
+  return tt_platform_thread_checkpoint();
+}
+
 tt_error_t tt_thread_sleep(uint32_t ms) { return tt_platform_thread_sleep(ms); }
 
 tt_thread_t *tt_thread_self(void) { return tt_platform_thread_self(); }
@@ -7,30 +7,165 @@
  */
 
 #include "tt_thread_internal.h"
-#include "tt_mutex.h"
 #include "tt_types.h"
+#include <stdlib.h>
 #include <string.h>
 
 #if defined(TT_CAP_THREADS)
-tt_thread_table_entry_t g_thread_table[TT_MAX_THREADS] = {0};
-tt_mutex_t g_thread_table_mutex = {0};
+tt_thread_table_segment_t *g_thread_table[TT_THREAD_TABLE_MAX_SEGMENTS] = {0};
 
-tt_error_t tt_thread_table_init(void) {
-  tt_error_t result = tt_mutex_init(&g_thread_table_mutex);
-  if (result != TT_SUCCESS) {
-    return result;
+/* Segment where a free slot was last seen; only a starting point for scans */
+static uint32_t g_thread_table_hint = 0;
+
+static tt_thread_table_segment_t *table_segment(uint32_t index) {
+  return __atomic_load_n(&g_thread_table[index], __ATOMIC_ACQUIRE);
+}
+
+static bool table_segment_claim(tt_thread_table_segment_t *segment,
+                                uint32_t index, tt_thread_t *thread) {
+  uint64_t used = __atomic_load_n(&segment->used, __ATOMIC_RELAXED);
+
+  while (used != UINT64_MAX) {
+    uint32_t bit = (uint32_t)__builtin_ctzll(~used);
+    if (__atomic_compare_exchange_n(&segment->used, &used,
+                                    used | (UINT64_C(1) << bit), true,
+                                    __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) {
+      thread->table_slot = index * TT_THREAD_TABLE_SEGMENT_SLOTS + bit;
+      __atomic_store_n(&segment->threads[bit], thread, __ATOMIC_RELEASE);
+      __atomic_store_n(&g_thread_table_hint, index, __ATOMIC_RELAXED);
+      return true;
+    }
+  }
+  return false;
+}
+
+/* Publish a new segment at the first empty index, or return NULL when full */
+static tt_thread_table_segment_t *table_grow(uint32_t *index) {
+  for (uint32_t i = 0; i < TT_THREAD_TABLE_MAX_SEGMENTS; i++) {
+    if (table_segment(i) != NULL) {
+      continue;
+    }
+
+    tt_thread_table_segment_t *segment = calloc(1, sizeof(*segment));
+    if (segment == NULL) {
+      return NULL;
+    }
+
+    tt_thread_table_segment_t *expected = NULL;
+    if (!__atomic_compare_exchange_n(&g_thread_table[i], &expected, segment,
+                                     false, __ATOMIC_ACQ_REL,
+                                     __ATOMIC_ACQUIRE)) {
+      // Another thread grew the table first, use its segment instead
+      free(segment);
+      segment = expected;
+    }
+    *index = i;
+    return segment;
+  }
+  return NULL;
+}
+
+/**
+ * @brief Thread object slab segment, same claim scheme as the table
+ */
+typedef struct {
+  uint64_t used;                                      /**< Object bitmap*/
+  tt_thread_t threads[TT_THREAD_TABLE_SEGMENT_SLOTS]; /**< Objects*/
+} thread_slab_segment_t;
+
+static thread_slab_segment_t *g_thread_slab[TT_THREAD_SLAB_MAX_SEGMENTS];
+
+/* tt_thread_t.slab_slot of objects that came from malloc */
+#define THREAD_SLAB_NONE UINT32_MAX
+
+static tt_thread_t *slab_segment_claim(thread_slab_segment_t *segment,
+                                       uint32_t index) {
+  uint64_t used = __atomic_load_n(&segment->used, __ATOMIC_RELAXED);
+
+  while (used != UINT64_MAX) {
+    uint32_t bit = (uint32_t)__builtin_ctzll(~used);
+    if (__atomic_compare_exchange_n(&segment->used, &used,
+                                    used | (UINT64_C(1) << bit), true,
+                                    __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) {
+      tt_thread_t *thread = &segment->threads[bit];
+      memset(thread, 0, sizeof(*thread));
+      thread->slab_slot = index * TT_THREAD_TABLE_SEGMENT_SLOTS + bit;
+      return thread;
+    }
+  }
+  return NULL;
+}
+
+tt_thread_t *tt_thread_alloc(void) {
+  for (uint32_t i = 0; i < TT_THREAD_SLAB_MAX_SEGMENTS; i++) {
+    thread_slab_segment_t *segment =
+        __atomic_load_n(&g_thread_slab[i], __ATOMIC_ACQUIRE);
+
+    if (segment == NULL) {
+      thread_slab_segment_t *expected = NULL;
+      segment = calloc(1, sizeof(*segment));
+      if (segment == NULL) {
+        break;
+      }
+      if (!__atomic_compare_exchange_n(&g_thread_slab[i], &expected, segment,
+                                       false, __ATOMIC_ACQ_REL,
+                                       __ATOMIC_ACQUIRE)) {
+        free(segment);
+        segment = expected;
+      }
+    }
+
+    tt_thread_t *thread = slab_segment_claim(segment, i);
+    if (thread != NULL) {
+      return thread;
+    }
   }
 
-  tt_mutex_lock(&g_thread_table_mutex);
-  memset(g_thread_table, 0, sizeof(g_thread_table));
-  tt_mutex_unlock(&g_thread_table_mutex);
+  // Slab exhausted
+  tt_thread_t *thread = calloc(1, sizeof(*thread));
+  if (thread != NULL) {
+    thread->slab_slot = THREAD_SLAB_NONE;
+  }
+  return thread;
+}
+
+void tt_thread_free(tt_thread_t *thread) {
+  if (thread == NULL) {
+    return;
+  }
+  if (thread->slab_slot == THREAD_SLAB_NONE) {
+    free(thread);
+    return;
+  }
+
+  uint32_t index = thread->slab_slot / TT_THREAD_TABLE_SEGMENT_SLOTS;
+  uint32_t bit = thread->slab_slot % TT_THREAD_TABLE_SEGMENT_SLOTS;
+  thread_slab_segment_t *segment =
+      __atomic_load_n(&g_thread_slab[index], __ATOMIC_ACQUIRE);
+  __atomic_fetch_and(&segment->used, ~(UINT64_C(1) << bit), __ATOMIC_RELEASE);
+}
+
+tt_error_t tt_thread_table_init(void) {
+  __atomic_store_n(&g_thread_table_hint, 0, __ATOMIC_RELAXED);
   return TT_SUCCESS;
 }
 
 tt_error_t tt_thread_table_cleanup(void) {
-  tt_mutex_lock(&g_thread_table_mutex);
-  memset(g_thread_table, 0, sizeof(g_thread_table));
-  tt_mutex_unlock(&g_thread_table_mutex);
+  // Only safe once no thread can register or unregister any more
+  for (uint32_t i = 0; i < TT_THREAD_TABLE_MAX_SEGMENTS; i++) {
+    free(__atomic_exchange_n(&g_thread_table[i], NULL, __ATOMIC_ACQ_REL));
+  }
+  // Slab segments with live objects stay, their threads may outlive this
+  for (uint32_t i = 0; i < TT_THREAD_SLAB_MAX_SEGMENTS; i++) {
+    thread_slab_segment_t *segment =
+        __atomic_load_n(&g_thread_slab[i], __ATOMIC_ACQUIRE);
+    if (segment != NULL &&
+        __atomic_load_n(&segment->used, __ATOMIC_ACQUIRE) == 0) {
+      __atomic_store_n(&g_thread_slab[i], NULL, __ATOMIC_RELEASE);
+      free(segment);
+    }
+  }
+  __atomic_store_n(&g_thread_table_hint, 0, __ATOMIC_RELAXED);
   return TT_SUCCESS;
 }
 
@@ -39,22 +174,29 @@ tt_error_t tt_thread_table_register(tt_thread_t *thread) {
     return TT_ERROR_NULL_POINTER;
   }
 
-  tt_error_t result = TT_ERROR_NOT_FOUND;
+  thread->table_slot = TT_THREAD_TABLE_CAPACITY;
 
-  tt_mutex_lock(&g_thread_table_mutex);
+  for (;;) {
+    // Scan the published segments, starting where space was last seen
+    uint32_t start = __atomic_load_n(&g_thread_table_hint, __ATOMIC_RELAXED);
+    for (uint32_t n = 0; n < TT_THREAD_TABLE_MAX_SEGMENTS; n++) {
+      uint32_t index = (start + n) % TT_THREAD_TABLE_MAX_SEGMENTS;
+      tt_thread_table_segment_t *segment = table_segment(index);
+      if (segment != NULL && table_segment_claim(segment, index, thread)) {
+        return TT_SUCCESS;
+      }
+    }
 
-  // Find first available slot
-  for (size_t i = 0; i < TT_MAX_THREADS; i++) {
-    if (!g_thread_table[i].in_use) {
-      g_thread_table[i].thread = thread;
-      g_thread_table[i].in_use = true;
-      result = TT_SUCCESS;
-      break;
+    uint32_t index;
+    tt_thread_table_segment_t *segment = table_grow(&index);
+    if (segment == NULL) {
+      return TT_ERROR_MEMORY;
     }
+    if (table_segment_claim(segment, index, thread)) {
+      return TT_SUCCESS;
+    }
+    // The new segment filled up under us; rescan
   }
-
-  tt_mutex_unlock(&g_thread_table_mutex);
-  return result;
 }
 
 tt_error_t tt_thread_table_unregister(tt_thread_t *thread) {
@@ -62,42 +204,85 @@ tt_error_t tt_thread_table_unregister(tt_thread_t *thread) {
     return TT_ERROR_NULL_POINTER;
   }
 
-  tt_error_t result = TT_ERROR_NOT_FOUND;
+  uint32_t slot = thread->table_slot;
+  if (slot >= TT_THREAD_TABLE_CAPACITY) {
+    return TT_ERROR_NOT_FOUND;
+  }
 
-  tt_mutex_lock(&g_thread_table_mutex);
+  uint32_t index = slot / TT_THREAD_TABLE_SEGMENT_SLOTS;
+  uint32_t bit = slot % TT_THREAD_TABLE_SEGMENT_SLOTS;
+  tt_thread_table_segment_t *segment = table_segment(index);
+  if (segment == NULL) {
+    return TT_ERROR_NOT_FOUND;
+  }
 
-  // Find first available slot
-  for (size_t i = 0; i < TT_MAX_THREADS; i++) {
+  // Clear the entry before the bit so a new owner never sees a stale entry
+  tt_thread_t *expected = thread;
+  if (!__atomic_compare_exchange_n(&segment->threads[bit], &expected, NULL,
+                                   false, __ATOMIC_ACQ_REL,
+                                   __ATOMIC_RELAXED)) {
+    return TT_ERROR_NOT_FOUND;
+  }
+  __atomic_fetch_and(&segment->used, ~(UINT64_C(1) << bit), __ATOMIC_RELEASE);
+  __atomic_store_n(&g_thread_table_hint, index, __ATOMIC_RELAXED);
 
-    if (g_thread_table[i].in_use && g_thread_table[i].thread == thread) {
-      g_thread_table[i].thread = NULL;
-      g_thread_table[i].in_use = false;
-      result = TT_SUCCESS;
-      break;
-    }
+  thread->table_slot = TT_THREAD_TABLE_CAPACITY;
+  return TT_SUCCESS;
+}
+
+size_t tt_thread_table_snapshot(tt_thread_t **threads, size_t max_threads) {
+  size_t count = 0;
+
+  if (threads == NULL) {
+    return 0;
   }
 
-  tt_mutex_unlock(&g_thread_table_mutex);
-  return result;
+  for (uint32_t i = 0; i < TT_THREAD_TABLE_MAX_SEGMENTS && count < max_threads;
+       i++) {
+    tt_thread_table_segment_t *segment = table_segment(i);
+    if (segment == NULL) {
+      continue;
+    }
+
+    uint64_t used = __atomic_load_n(&segment->used, __ATOMIC_ACQUIRE);
+    while (used != 0 && count < max_threads) {
+      uint32_t bit = (uint32_t)__builtin_ctzll(used);
+      used &= used - 1;
+
+      // A claimed slot may not be filled in yet
+      tt_thread_t *thread =
+          __atomic_load_n(&segment->threads[bit], __ATOMIC_ACQUIRE);
+      if (thread != NULL) {
+        threads[count++] = thread;
+      }
+    }
+  }
+  return count;
 }
 
 tt_thread_t *
 tt_thread_table_find_by_handle(tt_platform_thread_handle_t handle) {
-  tt_thread_t *result = NULL;
+  for (uint32_t i = 0; i < TT_THREAD_TABLE_MAX_SEGMENTS; i++) {
+    tt_thread_table_segment_t *segment = table_segment(i);
+    if (segment == NULL) {
+      continue;
+    }
 
-  tt_mutex_lock(&g_thread_table_mutex);
+    uint64_t used = __atomic_load_n(&segment->used, __ATOMIC_ACQUIRE);
+    while (used != 0) {
+      uint32_t bit = (uint32_t)__builtin_ctzll(used);
+      used &= used - 1;
 
-  for (size_t i = 0; i < TT_MAX_THREADS; i++) {
-    if (g_thread_table[i].in_use &&
-        memcmp(&g_thread_table[i].thread->handle, &handle,
-               sizeof(tt_platform_thread_handle_t))) {
-      result = g_thread_table[i].thread;
-      break;
+      tt_thread_t *thread =
+          __atomic_load_n(&segment->threads[bit], __ATOMIC_ACQUIRE);
+      if (thread != NULL &&
+          memcmp(&thread->handle, &handle,
+                 sizeof(tt_platform_thread_handle_t)) == 0) {
+        return thread;
+      }
     }
   }
-
-  tt_mutex_unlock(&g_thread_table_mutex);
-  return result;
+  return NULL;
 }
 
 #endif /* TT_CAP_THREADS */
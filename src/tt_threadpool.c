@@ -0,0 +1,244 @@
+/**
+ * @file tt_threadpool.c
+ * @author Mihai Gurei <mihai.gurei@protonmail.com>
+ * @date 2025-01-24
+ * @brief
+ * @copyright Copyright (c) 2025 AnAlphaBeta. All rights reserved.
+ */
+
+#include "tt_threadpool.h"
+#include "tt_mutex.h"
+#include "tt_sem.h"
+#include "tt_thread.h"
+#include "tt_types.h"
+#include <stdlib.h>
+
+#if defined(TT_CAP_THREADS)
+/**
+ * @brief Queued task
+ */
+typedef struct {
+  tt_threadpool_task_t func;
+  void *arg;
+} tt_threadpool_entry_t;
+
+struct tt_threadpool_t {
+  tt_mutex_t lock;              /**< Guards the queue*/
+  tt_threadpool_entry_t *queue; /**< Circular task queue*/
+  size_t capacity;              /**< Queue capacity, power of two*/
+  size_t head;                  /**< Next task to run*/
+  size_t count;                 /**< Queued tasks*/
+  tt_sem_t tasks;               /**< One unit per queued task or stop request*/
+  volatile uint32_t pending;    /**< Queued plus running tasks, idle wait word*/
+  volatile uint32_t idle_waiters; /**< Threads parked on pending*/
+  size_t num_threads;             /**< Started workers*/
+  tt_thread_t **threads;          /**< Worker handles*/
+};
+
+static bool threadpool_pop(tt_threadpool_t *pool, tt_threadpool_entry_t *entry) {
+  bool found = false;
+
+  tt_mutex_lock(&pool->lock);
+  if (pool->count > 0) {
+    *entry = pool->queue[pool->head];
+    pool->head = (pool->head + 1) & (pool->capacity - 1);
+    pool->count--;
+    found = true;
+  }
+  tt_mutex_unlock(&pool->lock);
+  return found;
+}
+
+static void *threadpool_worker(void *arg) {
+  tt_threadpool_t *pool = (tt_threadpool_t *)arg;
+  tt_threadpool_entry_t entry;
+
+  for (;;) {
+    tt_sem_wait(&pool->tasks);
+
+    // Stop requests are posted after the last task, so an empty queue here
+    // means everything has been run
+    if (!threadpool_pop(pool, &entry)) {
+      break;
+    }
+
+    entry.func(entry.arg);
+
+    if (__atomic_sub_fetch(&pool->pending, 1, __ATOMIC_SEQ_CST) == 0 &&
+        __atomic_load_n(&pool->idle_waiters, __ATOMIC_SEQ_CST) > 0) {
+      tt_platform_futex_wake(&pool->pending, TT_PLATFORM_WAKE_ALL);
+    }
+  }
+  return NULL;
+}
+
+/* Stop and join the started workers, then release the pool */
+static tt_error_t threadpool_stop(tt_threadpool_t *pool) {
+  tt_error_t result = TT_SUCCESS;
+
+  for (size_t i = 0; i < pool->num_threads; i++) {
+    tt_sem_post(&pool->tasks);
+  }
+  for (size_t i = 0; i < pool->num_threads; i++) {
+    tt_error_t join_result = tt_thread_join(pool->threads[i], NULL);
+    if (join_result == TT_SUCCESS) {
+      tt_thread_destroy(pool->threads[i]);
+    } else if (result == TT_SUCCESS) {
+      result = join_result;
+    }
+  }
+
+  tt_sem_destroy(&pool->tasks);
+  tt_mutex_destroy(&pool->lock);
+  free(pool->threads);
+  free(pool->queue);
+  free(pool);
+  return result;
+}
+
+tt_error_t tt_threadpool_create(tt_threadpool_t **pool, size_t num_threads,
+                                const tt_thread_attr_t *attr) {
+  if (pool == NULL) {
+    return TT_ERROR_NULL_POINTER;
+  }
+
+  if (num_threads == 0) {
+    return TT_ERROR_INVALID_PARAM;
+  }
+
+  tt_error_t result = tt_thread_init();
+  if (result != TT_SUCCESS) {
+    return result;
+  }
+
+  tt_threadpool_t *new_pool = calloc(1, sizeof(*new_pool));
+  if (new_pool == NULL) {
+    return TT_ERROR_MEMORY;
+  }
+
+  new_pool->capacity = 1;
+  while (new_pool->capacity < TT_THREADPOOL_QUEUE_SIZE) {
+    new_pool->capacity <<= 1;
+  }
+  new_pool->queue = malloc(new_pool->capacity * sizeof(*new_pool->queue));
+  new_pool->threads = calloc(num_threads, sizeof(*new_pool->threads));
+  if (new_pool->queue == NULL || new_pool->threads == NULL) {
+    free(new_pool->queue);
+    free(new_pool->threads);
+    free(new_pool);
+    return TT_ERROR_MEMORY;
+  }
+
+  result = tt_mutex_init_named(&new_pool->lock, "tt_threadpool");
+  if (result != TT_SUCCESS) {
+    free(new_pool->queue);
+    free(new_pool->threads);
+    free(new_pool);
+    return result;
+  }
+  tt_sem_init(&new_pool->tasks, 0);
+
+  for (size_t i = 0; i < num_threads; i++) {
+    result = tt_thread_create(&new_pool->threads[i], attr, threadpool_worker,
+                              new_pool);
+    if (result != TT_SUCCESS) {
+      threadpool_stop(new_pool);
+      return result;
+    }
+    new_pool->num_threads++;
+  }
+
+  *pool = new_pool;
+  return TT_SUCCESS;
+}
+
+tt_error_t tt_threadpool_submit(tt_threadpool_t *pool, tt_threadpool_task_t func,
+                                void *arg) {
+  if (pool == NULL || func == NULL) {
+    return TT_ERROR_NULL_POINTER;
+  }
+
+  tt_mutex_lock(&pool->lock);
+
+  if (pool->count == pool->capacity) {
+    size_t capacity = pool->capacity * 2;
+    tt_threadpool_entry_t *queue = malloc(capacity * sizeof(*queue));
+    if (queue == NULL) {
+      tt_mutex_unlock(&pool->lock);
+      return TT_ERROR_MEMORY;
+    }
+    // Unwrap the ring into the start of the larger buffer
+    for (size_t i = 0; i < pool->count; i++) {
+      queue[i] = pool->queue[(pool->head + i) & (pool->capacity - 1)];
+    }
+    free(pool->queue);
+    pool->queue = queue;
+    pool->capacity = capacity;
+    pool->head = 0;
+  }
+
+  pool->queue[(pool->head + pool->count) & (pool->capacity - 1)] =
+      (tt_threadpool_entry_t){.func = func, .arg = arg};
+  pool->count++;
+  __atomic_fetch_add(&pool->pending, 1, __ATOMIC_RELAXED);
+
+  tt_mutex_unlock(&pool->lock);
+
+  return tt_sem_post(&pool->tasks);
+}
+
+tt_error_t tt_threadpool_wait_idle(tt_threadpool_t *pool) {
+  if (pool == NULL) {
+    return TT_ERROR_NULL_POINTER;
+  }
+
+  uint32_t pending;
+  while ((pending = __atomic_load_n(&pool->pending, __ATOMIC_ACQUIRE)) != 0) {
+    // Paired with the SEQ_CST decrement and waiters load in the worker
+    __atomic_fetch_add(&pool->idle_waiters, 1, __ATOMIC_SEQ_CST);
+    tt_platform_futex_wait(&pool->pending, pending, TT_PLATFORM_WAIT_FOREVER);
+    __atomic_fetch_sub(&pool->idle_waiters, 1, __ATOMIC_RELAXED);
+  }
+  return TT_SUCCESS;
+}
+
+size_t tt_threadpool_size(const tt_threadpool_t *pool) {
+  return (pool != NULL) ? pool->num_threads : 0;
+}
+
+tt_error_t tt_threadpool_destroy(tt_threadpool_t *pool) {
+  if (pool == NULL) {
+    return TT_ERROR_NULL_POINTER;
+  }
+
+  return threadpool_stop(pool);
+}
+
+#else
+tt_error_t tt_threadpool_create(tt_threadpool_t **pool,
+                                size_t num_threads __attribute__((unused)),
+                                const tt_thread_attr_t *attr
+                                __attribute__((unused))) {
+  return (pool == NULL) ? TT_ERROR_NULL_POINTER : TT_ERROR_NOT_IMPLEMENTED;
+}
+
+tt_error_t tt_threadpool_submit(tt_threadpool_t *pool __attribute__((unused)),
+                                tt_threadpool_task_t func
+                                __attribute__((unused)),
+                                void *arg __attribute__((unused))) {
+  return TT_ERROR_NOT_IMPLEMENTED;
+}
+
+tt_error_t tt_threadpool_wait_idle(tt_threadpool_t *pool
+                                   __attribute__((unused))) {
+  return TT_ERROR_NOT_IMPLEMENTED;
+}
+
+size_t tt_threadpool_size(const tt_threadpool_t *pool __attribute__((unused))) {
+  return 0;
+}
+
+tt_error_t tt_threadpool_destroy(tt_threadpool_t *pool __attribute__((unused))) {
+  return TT_ERROR_NOT_IMPLEMENTED;
+}
+#endif /* TT_CAP_THREADS */
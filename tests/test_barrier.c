@@ -0,0 +1,162 @@
+/**
+ * @file test_barrier.c
+ * @author Mihai Gurei <mihai.gurei@protonmail.com>
+ * @date 2025-01-16
+ * @brief Barrier and latch test suite
+ * @copyright Copyright (c) 2025 AnAlphaBeta. All rights reserved.
+ */
+
+#include "tt_barrier.h"
+#include "tt_platform.h"
+#include "tt_test.h"
+#include "tt_thread.h"
+#include <stdint.h>
+
+void setUp(void) {}
+
+void tearDown(void) {}
+
+TT_TEST(test_barrier_null_pointer) {
+  TT_ASSERT_EQUAL(TT_ERROR_NULL_POINTER, tt_barrier_init(NULL, 1), "%d");
+  TT_ASSERT_EQUAL(TT_ERROR_NULL_POINTER, tt_barrier_wait(NULL, NULL), "%d");
+  TT_ASSERT_EQUAL(TT_ERROR_NULL_POINTER, tt_barrier_destroy(NULL), "%d");
+  TT_ASSERT_EQUAL(TT_ERROR_NULL_POINTER, tt_latch_init(NULL, 1), "%d");
+  TT_ASSERT_EQUAL(TT_ERROR_NULL_POINTER, tt_latch_count_down(NULL, 1), "%d");
+  TT_ASSERT_EQUAL(TT_ERROR_NULL_POINTER, tt_latch_wait(NULL), "%d");
+  TT_ASSERT_EQUAL(TT_ERROR_NULL_POINTER, tt_latch_try_wait(NULL), "%d");
+  TT_ASSERT_EQUAL(TT_ERROR_NULL_POINTER, tt_latch_destroy(NULL), "%d");
+  return true;
+}
+
+TT_TEST(test_barrier_single_thread) {
+  tt_barrier_t barrier;
+  bool is_last = false;
+
+  TT_ASSERT_EQUAL(TT_ERROR_INVALID_PARAM, tt_barrier_init(&barrier, 0), "%d");
+  TT_ASSERT_EQUAL(TT_SUCCESS, tt_barrier_init(&barrier, 1), "%d");
+  for (int i = 0; i < 3; i++) {
+    TT_ASSERT_EQUAL(TT_SUCCESS, tt_barrier_wait(&barrier, &is_last), "%d");
+    TT_ASSERT(is_last);
+  }
+  TT_ASSERT_EQUAL(TT_SUCCESS, tt_barrier_destroy(&barrier), "%d");
+  return true;
+}
+
+TT_TEST(test_latch_count_down) {
+  tt_latch_t latch;
+
+  TT_ASSERT_EQUAL(TT_SUCCESS, tt_latch_init(&latch, 3), "%d");
+  TT_ASSERT_EQUAL(TT_ERROR_BUSY, tt_latch_try_wait(&latch), "%d");
+  TT_ASSERT_EQUAL(TT_ERROR_TIMEOUT, tt_latch_timedwait(&latch, 10), "%d");
+  TT_ASSERT_EQUAL(TT_ERROR_INVALID_PARAM, tt_latch_count_down(&latch, 4),
+                  "%d");
+  TT_ASSERT_EQUAL(TT_SUCCESS, tt_latch_count_down(&latch, 2), "%d");
+  TT_ASSERT_EQUAL(TT_ERROR_BUSY, tt_latch_try_wait(&latch), "%d");
+  TT_ASSERT_EQUAL(TT_SUCCESS, tt_latch_arrive_and_wait(&latch), "%d");
+  TT_ASSERT_EQUAL(TT_SUCCESS, tt_latch_try_wait(&latch), "%d");
+  TT_ASSERT_EQUAL(TT_SUCCESS, tt_latch_wait(&latch), "%d");
+  TT_ASSERT_EQUAL(TT_SUCCESS, tt_latch_destroy(&latch), "%d");
+  return true;
+}
+
+#if defined(TT_CAP_THREADS)
+#define BARRIER_THREADS 4
+#define BARRIER_PHASES 1000
+
+static tt_barrier_t phase_barrier;
+static tt_latch_t start_latch;
+static volatile uint32_t phase_work;
+static volatile uint32_t phase_leaders;
+
+static void *phase_worker(void *arg) {
+  (void)arg;
+  uintptr_t errors = 0;
+  bool is_last;
+
+  tt_latch_arrive_and_wait(&start_latch);
+  for (uint32_t phase = 0; phase < BARRIER_PHASES; phase++) {
+    __atomic_fetch_add(&phase_work, 1, __ATOMIC_RELAXED);
+    tt_barrier_wait(&phase_barrier, &is_last);
+    // Every worker must see the whole phase done
+    if (__atomic_load_n(&phase_work, __ATOMIC_RELAXED) <
+        (phase + 1) * BARRIER_THREADS) {
+      errors++;
+    }
+    if (is_last) {
+      __atomic_fetch_add(&phase_leaders, 1, __ATOMIC_RELAXED);
+    }
+    tt_barrier_wait(&phase_barrier, NULL);
+  }
+  return (void *)errors;
+}
+
+static void *noop_worker(void *arg) { return arg; }
+
+TT_TEST(test_barrier_phases) {
+  tt_thread_t *threads[BARRIER_THREADS];
+  void *retval;
+
+  phase_work = 0;
+  phase_leaders = 0;
+  TT_ASSERT_EQUAL(TT_SUCCESS, tt_thread_init(), "%d");
+  TT_ASSERT_EQUAL(TT_SUCCESS,
+                  tt_barrier_init(&phase_barrier, BARRIER_THREADS), "%d");
+  TT_ASSERT_EQUAL(TT_SUCCESS, tt_latch_init(&start_latch, BARRIER_THREADS + 1),
+                  "%d");
+
+  for (int i = 0; i < BARRIER_THREADS; i++) {
+    TT_ASSERT_EQUAL(TT_SUCCESS,
+                    tt_thread_create(&threads[i], NULL, phase_worker, NULL),
+                    "%d");
+  }
+
+  uint64_t start = tt_platform_time_monotonic_ns();
+  TT_ASSERT_EQUAL(TT_SUCCESS, tt_latch_arrive_and_wait(&start_latch), "%d");
+  for (int i = 0; i < BARRIER_THREADS; i++) {
+    TT_ASSERT_EQUAL(TT_SUCCESS, tt_thread_join(threads[i], &retval), "%d");
+    TT_ASSERT_EQUAL(0UL, (unsigned long)(uintptr_t)retval, "%lu");
+    tt_thread_destroy(threads[i]);
+  }
+  uint64_t barrier_ns = tt_platform_time_monotonic_ns() - start;
+
+  TT_ASSERT_EQUAL((uint32_t)BARRIER_PHASES * BARRIER_THREADS, phase_work,
+                  "%u");
+  TT_ASSERT_EQUAL((uint32_t)BARRIER_PHASES, phase_leaders, "%u");
+  TT_ASSERT_EQUAL(TT_SUCCESS, tt_barrier_destroy(&phase_barrier), "%d");
+  TT_ASSERT_EQUAL(TT_SUCCESS, tt_latch_destroy(&start_latch), "%d");
+
+  // Same phase count with a fresh set of threads per phase
+  start = tt_platform_time_monotonic_ns();
+  for (int phase = 0; phase < BARRIER_PHASES / 10; phase++) {
+    for (int i = 0; i < BARRIER_THREADS; i++) {
+      tt_thread_create(&threads[i], NULL, noop_worker, NULL);
+    }
+    for (int i = 0; i < BARRIER_THREADS; i++) {
+      tt_thread_join(threads[i], NULL);
+      tt_thread_destroy(threads[i]);
+    }
+  }
+  uint64_t respawn_ns = (tt_platform_time_monotonic_ns() - start) * 10;
+
+  printf(" [per phase: barrier %.1fus, respawn %.1fus]",
+         (double)barrier_ns / (2.0 * BARRIER_PHASES) / 1e3,
+         (double)respawn_ns / BARRIER_PHASES / 1e3);
+  return true;
+}
+#endif /* TT_CAP_THREADS */
+
+int main(void) {
+  TT_TEST_START("Barrier Test Suite");
+
+  TT_SET_FIXTURES(setUp, tearDown);
+
+  TT_RUN_TEST(test_barrier_null_pointer);
+  TT_RUN_TEST(test_barrier_single_thread);
+  TT_RUN_TEST(test_latch_count_down);
+#if defined(TT_CAP_THREADS)
+  TT_RUN_TEST(test_barrier_phases);
+#endif /* TT_CAP_THREADS */
+
+  TT_TEST_END();
+  return 0;
+}
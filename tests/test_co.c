@@ -0,0 +1,204 @@
+/**
+ * @file test_co.c
+ * @author Mihai Gurei <mihai.gurei@protonmail.com>
+ * @date 2025-02-12
+ * @brief Stackless coroutine test suite
+ * @copyright Copyright (c) 2025 AnAlphaBeta. All rights reserved.
+ */
+
+#include "tt_co.h"
+#include "tt_test.h"
+#include <stdint.h>
+
+#define MESSAGE_SIZE 64
+#define TRACE_SIZE 16
+
+static tt_co_sched_t sched;
+static tt_ringbuf_t rb;
+static uint8_t rb_buffer[4];
+static char trace[TRACE_SIZE];
+static size_t trace_len;
+
+void setUp(void) {
+  tt_co_sched_init(&sched);
+  tt_ringbuf_init(&rb, rb_buffer, sizeof(rb_buffer));
+  trace_len = 0;
+}
+
+void tearDown(void) {}
+
+/* Append its letter, yield, and do it again: ABAB shows round robin */
+static tt_co_state_t letter(tt_co_t *co, void *arg) {
+  TT_CO_BEGIN(co);
+  trace[trace_len++] = *(const char *)arg;
+  TT_CO_YIELD(co);
+  trace[trace_len++] = *(const char *)arg;
+  TT_CO_END(co);
+}
+
+/* Ring buffers smaller than the message force both sides to wait */
+static tt_co_state_t producer(tt_co_t *co, void *arg) {
+  static uint8_t next;
+  (void)arg;
+
+  TT_CO_BEGIN(co);
+  for (next = 0; next < MESSAGE_SIZE; next++) {
+    TT_CO_WAIT_WRITABLE(co, &rb);
+    tt_ringbuf_write(&rb, next);
+  }
+  TT_CO_END(co);
+}
+
+static tt_co_state_t consumer(tt_co_t *co, void *arg) {
+  static size_t received;
+  uint32_t *sum = (uint32_t *)arg;
+  uint8_t byte;
+
+  TT_CO_BEGIN(co);
+  for (received = 0; received < MESSAGE_SIZE; received++) {
+    TT_CO_WAIT_READABLE(co, &rb);
+    tt_ringbuf_read(&rb, &byte);
+    *sum += byte;
+  }
+  TT_CO_END(co);
+}
+
+/* Wait on a flag set from outside the scheduler, then leave early */
+static tt_co_state_t wait_flag(tt_co_t *co, void *arg) {
+  volatile bool *flag = (volatile bool *)arg;
+
+  TT_CO_BEGIN(co);
+  TT_CO_WAIT_UNTIL(co, *flag);
+  TT_CO_EXIT(co);
+  trace[trace_len++] = '!';
+  TT_CO_END(co);
+}
+
+/* Spawn a child from inside a coroutine */
+static tt_co_task_t child_task;
+static const char child_name = 'C';
+
+static tt_co_state_t parent(tt_co_t *co, void *arg) {
+  (void)arg;
+
+  TT_CO_BEGIN(co);
+  tt_co_spawn(&sched, &child_task, letter, (void *)&child_name);
+  trace[trace_len++] = 'P';
+  TT_CO_END(co);
+}
+
+TT_TEST(test_co_invalid) {
+  tt_co_task_t task;
+
+  TT_ASSERT_EQUAL(TT_ERROR_NULL_POINTER, tt_co_sched_init(NULL), "%d");
+  TT_ASSERT_EQUAL(TT_ERROR_NULL_POINTER, tt_co_spawn(NULL, &task, letter, NULL),
+                  "%d");
+  TT_ASSERT_EQUAL(TT_ERROR_NULL_POINTER, tt_co_spawn(&sched, NULL, letter, NULL),
+                  "%d");
+  TT_ASSERT_EQUAL(TT_ERROR_NULL_POINTER, tt_co_spawn(&sched, &task, NULL, NULL),
+                  "%d");
+  TT_ASSERT_EQUAL(TT_ERROR_NULL_POINTER, tt_co_sched_step(NULL, NULL), "%d");
+  TT_ASSERT_EQUAL(TT_ERROR_NULL_POINTER, tt_co_sched_run(NULL), "%d");
+  TT_ASSERT_EQUAL((size_t)0, tt_co_sched_count(NULL), "%zu");
+
+  // Nothing to run
+  TT_ASSERT_EQUAL(TT_SUCCESS, tt_co_sched_run(&sched), "%d");
+
+  // A coroutine costs its resume point and nothing else
+  TT_ASSERT(sizeof(tt_co_t) <= 2);
+  return true;
+}
+
+TT_TEST(test_co_round_robin) {
+  tt_co_task_t tasks[2];
+  const char names[2] = {'A', 'B'};
+
+  for (int i = 0; i < 2; i++) {
+    TT_ASSERT_EQUAL(TT_SUCCESS,
+                    tt_co_spawn(&sched, &tasks[i], letter, (void *)&names[i]),
+                    "%d");
+  }
+  TT_ASSERT_EQUAL((size_t)2, tt_co_sched_count(&sched), "%zu");
+
+  bool progress = false;
+  TT_ASSERT_EQUAL(TT_SUCCESS, tt_co_sched_step(&sched, &progress), "%d");
+  TT_ASSERT(progress);
+  TT_ASSERT_EQUAL((size_t)2, tt_co_sched_count(&sched), "%zu");
+
+  TT_ASSERT_EQUAL(TT_SUCCESS, tt_co_sched_run(&sched), "%d");
+  TT_ASSERT_EQUAL((size_t)0, tt_co_sched_count(&sched), "%zu");
+  TT_ASSERT_EQUAL((size_t)4, trace_len, "%zu");
+  TT_ASSERT(trace[0] == 'A' && trace[1] == 'B' && trace[2] == 'A' &&
+            trace[3] == 'B');
+  return true;
+}
+
+TT_TEST(test_co_ringbuf) {
+  tt_co_task_t tasks[2];
+  uint32_t sum = 0;
+
+  // Consumer first: it must wait for the producer's bytes
+  TT_ASSERT_EQUAL(TT_SUCCESS, tt_co_spawn(&sched, &tasks[0], consumer, &sum),
+                  "%d");
+  TT_ASSERT_EQUAL(TT_SUCCESS, tt_co_spawn(&sched, &tasks[1], producer, NULL),
+                  "%d");
+  TT_ASSERT_EQUAL(TT_SUCCESS, tt_co_sched_run(&sched), "%d");
+
+  TT_ASSERT_EQUAL((uint32_t)(MESSAGE_SIZE * (MESSAGE_SIZE - 1) / 2), sum, "%u");
+  TT_ASSERT(tt_ringbuf_is_empty(&rb));
+  return true;
+}
+
+TT_TEST(test_co_wait_exit) {
+  tt_co_task_t task;
+  volatile bool flag = false;
+  bool progress = true;
+
+  TT_ASSERT_EQUAL(TT_SUCCESS, tt_co_spawn(&sched, &task, wait_flag,
+                                          (void *)&flag),
+                  "%d");
+  for (int i = 0; i < 3; i++) {
+    TT_ASSERT_EQUAL(TT_SUCCESS, tt_co_sched_step(&sched, &progress), "%d");
+    TT_ASSERT(!progress);
+  }
+  TT_ASSERT_EQUAL((size_t)1, tt_co_sched_count(&sched), "%zu");
+
+  flag = true;
+  TT_ASSERT_EQUAL(TT_SUCCESS, tt_co_sched_step(&sched, &progress), "%d");
+  TT_ASSERT(progress);
+  TT_ASSERT_EQUAL((size_t)0, tt_co_sched_count(&sched), "%zu");
+  // TT_CO_EXIT skipped the rest of the body
+  TT_ASSERT_EQUAL((size_t)0, trace_len, "%zu");
+  return true;
+}
+
+TT_TEST(test_co_spawn_inside) {
+  tt_co_task_t task;
+
+  TT_ASSERT_EQUAL(TT_SUCCESS, tt_co_spawn(&sched, &task, parent, NULL), "%d");
+
+  // The child joins the round after the one that spawned it
+  TT_ASSERT_EQUAL(TT_SUCCESS, tt_co_sched_step(&sched, NULL), "%d");
+  TT_ASSERT_EQUAL((size_t)1, trace_len, "%zu");
+  TT_ASSERT_EQUAL((size_t)1, tt_co_sched_count(&sched), "%zu");
+
+  TT_ASSERT_EQUAL(TT_SUCCESS, tt_co_sched_run(&sched), "%d");
+  TT_ASSERT_EQUAL((size_t)3, trace_len, "%zu");
+  TT_ASSERT(trace[0] == 'P' && trace[1] == 'C' && trace[2] == 'C');
+  return true;
+}
+
+int main(void) {
+  TT_TEST_START("Coroutine Test Suite");
+
+  TT_SET_FIXTURES(setUp, tearDown);
+
+  TT_RUN_TEST(test_co_invalid);
+  TT_RUN_TEST(test_co_round_robin);
+  TT_RUN_TEST(test_co_ringbuf);
+  TT_RUN_TEST(test_co_wait_exit);
+  TT_RUN_TEST(test_co_spawn_inside);
+
+  TT_TEST_END();
+  return 0;
+}
@@ -7,6 +7,7 @@
  */
 
 #include "tt_error.h"
+#include "tt_sem.h"
 #include "tt_test.h"
 
 static tt_error_t last_callback_error = TT_SUCCESS;
@@ -73,11 +74,359 @@ TT_TEST(test_error_uninitialized) {
   TT_ASSERT_EQUAL(TT_ERROR_NOT_INITIALIZED, tt_error_get_last(), "%d");
   TT_ASSERT_EQUAL(TT_ERROR_NOT_INITIALIZED,
                   tt_error_register_callback(error_handle_callback), "%d");
+  TT_ASSERT_EQUAL(TT_ERROR_NOT_INITIALIZED, tt_error_dispatch_stop(), "%d");
 
   TT_ASSERT_EQUAL(TT_SUCCESS, tt_error_init(), "%d");
   return true;
 }
 
+static tt_error_t raise_helper(void) {
+  return TT_ERROR_RAISE(TT_ERROR_TIMEOUT);
+}
+
+TT_TEST(test_error_raise) {
+  tt_error_record_t records[TT_ERROR_RING_SIZE + 1];
+
+  tt_error_clear_recent();
+  TT_ASSERT_EQUAL(0u, (unsigned)tt_error_recent(records, 4), "%u");
+
+  TT_ASSERT_EQUAL(TT_ERROR_BUSY, TT_ERROR_RAISE(TT_ERROR_BUSY), "%d");
+  int busy_line = __LINE__ - 1;
+  TT_ASSERT_EQUAL(TT_ERROR_TIMEOUT, raise_helper(), "%d");
+  TT_ASSERT_EQUAL(TT_ERROR_TIMEOUT, tt_error_get_last(), "%d");
+
+  TT_ASSERT_EQUAL(2u, (unsigned)tt_error_recent(records, 4), "%u");
+  TT_ASSERT_EQUAL(TT_ERROR_TIMEOUT, records[0].code, "%d");
+  TT_ASSERT_STR_EQUAL("raise_helper", records[0].func);
+  TT_ASSERT_EQUAL(TT_ERROR_BUSY, records[1].code, "%d");
+  TT_ASSERT_EQUAL((unsigned)busy_line, (unsigned)records[1].line, "%u");
+  TT_ASSERT_STR_EQUAL(__FILE__, records[1].file);
+  TT_ASSERT(records[0].timestamp_ns >= records[1].timestamp_ns);
+
+  // Oldest records are overwritten
+  for (int i = 0; i < TT_ERROR_RING_SIZE; i++) {
+    TT_ERROR_RAISE(TT_ERROR_MEMORY);
+  }
+  TT_ASSERT_EQUAL((unsigned)TT_ERROR_RING_SIZE,
+                  (unsigned)tt_error_recent(records, TT_ERROR_RING_SIZE + 1),
+                  "%u");
+  TT_ASSERT_EQUAL(TT_ERROR_MEMORY, records[TT_ERROR_RING_SIZE - 1].code, "%d");
+
+  tt_error_clear_recent();
+  return true;
+}
+
+#if !defined(TT_ERROR_NO_STATS)
+TT_TEST(test_error_stats) {
+  tt_error_stats_t stats[TT_ERROR_CODE_COUNT];
+
+  tt_error_stats_reset();
+  TT_ASSERT_EQUAL((unsigned)TT_ERROR_CODE_COUNT,
+                  (unsigned)tt_error_stats_snapshot(stats, TT_ERROR_CODE_COUNT),
+                  "%u");
+  TT_ASSERT_EQUAL(0ULL, (unsigned long long)stats[TT_ERROR_BUSY].count,
+                  "%llu");
+
+  tt_error_set_last(TT_ERROR_BUSY);
+  tt_error_set_last(TT_SUCCESS);
+  TT_ERROR_RAISE(TT_ERROR_BUSY);
+  tt_error_set_last(TT_ERROR_MEMORY);
+  tt_error_set_last((tt_error_t)999);
+
+  tt_error_stats_snapshot(stats, TT_ERROR_CODE_COUNT);
+  TT_ASSERT_EQUAL(TT_ERROR_BUSY, stats[TT_ERROR_BUSY].code, "%d");
+  TT_ASSERT_EQUAL(2ULL, (unsigned long long)stats[TT_ERROR_BUSY].count,
+                  "%llu");
+  TT_ASSERT(stats[TT_ERROR_BUSY].first_seen_ns > 0);
+  TT_ASSERT(stats[TT_ERROR_BUSY].last_seen_ns >=
+            stats[TT_ERROR_BUSY].first_seen_ns);
+  TT_ASSERT_EQUAL(1ULL, (unsigned long long)stats[TT_ERROR_MEMORY].count,
+                  "%llu");
+  TT_ASSERT_EQUAL(1ULL, (unsigned long long)stats[TT_ERROR_UNKNOWN].count,
+                  "%llu");
+  TT_ASSERT_EQUAL(0ULL, (unsigned long long)stats[TT_SUCCESS].count, "%llu");
+  TT_ASSERT_EQUAL(0ULL, (unsigned long long)stats[TT_ERROR_TIMEOUT].count,
+                  "%llu");
+  TT_ASSERT_EQUAL(0ULL,
+                  (unsigned long long)stats[TT_ERROR_TIMEOUT].first_seen_ns,
+                  "%llu");
+
+  // Partial copies stop at max
+  TT_ASSERT_EQUAL(3u, (unsigned)tt_error_stats_snapshot(stats, 3), "%u");
+  tt_error_clear_recent();
+  return true;
+}
+#endif /* TT_ERROR_NO_STATS */
+
+static uint32_t event_calls;
+
+/* Spin rather than sleep, also works without TT_CAP_THREADS */
+static void wait_ms(uint32_t ms) {
+  uint64_t end = tt_platform_time_monotonic_ns() + ms * 1000000ULL;
+  while (tt_platform_time_monotonic_ns() < end) {
+  }
+}
+
+static tt_error_event_t last_event;
+
+static void record_event(const tt_error_event_t *event) {
+  event_calls++;
+  last_event = *event;
+}
+
+TT_TEST(test_error_rate_limit) {
+  event_calls = 0;
+  TT_ASSERT_EQUAL(TT_ERROR_INVALID_PARAM,
+                  tt_error_set_rate_limit((tt_error_t)999, 10, 5), "%d");
+  TT_ASSERT_EQUAL(TT_SUCCESS, tt_error_add_event_callback(record_event), "%d");
+  TT_ASSERT_EQUAL(TT_SUCCESS,
+                  tt_error_set_rate_limit(TT_ERROR_BUFFER_FULL, 10, 5), "%d");
+
+  // A storm only gets the burst through
+  for (int i = 0; i < 1000; i++) {
+    tt_error_set_last(TT_ERROR_BUFFER_FULL);
+  }
+  TT_ASSERT_EQUAL(5u, event_calls, "%u");
+  TT_ASSERT_EQUAL(0u, last_event.repeats, "%u");
+  TT_ASSERT_EQUAL(TT_ERROR_BUFFER_FULL, tt_error_get_last(), "%d");
+
+  // Other codes are not limited
+  tt_error_set_last(TT_ERROR_MEMORY);
+  TT_ASSERT_EQUAL(6u, event_calls, "%u");
+
+  // A refilled token carries the suppressed count
+  wait_ms(150);
+  tt_error_set_last(TT_ERROR_BUFFER_FULL);
+  TT_ASSERT_EQUAL(7u, event_calls, "%u");
+  TT_ASSERT_EQUAL(TT_ERROR_BUFFER_FULL, last_event.code, "%d");
+  TT_ASSERT_EQUAL(995u, last_event.repeats, "%u");
+
+  TT_ASSERT_EQUAL(TT_SUCCESS,
+                  tt_error_set_rate_limit(TT_ERROR_ALL_CODES, 0, 0), "%d");
+  tt_error_set_last(TT_ERROR_BUFFER_FULL);
+  TT_ASSERT_EQUAL(8u, event_calls, "%u");
+  return true;
+}
+
+TT_TEST(test_error_dedup) {
+  event_calls = 0;
+  TT_ASSERT_EQUAL(TT_SUCCESS, tt_error_add_event_callback(record_event), "%d");
+  TT_ASSERT_EQUAL(TT_SUCCESS, tt_error_set_dedup_window(TT_ERROR_TIMEOUT, 50),
+                  "%d");
+
+  for (int i = 0; i < 100; i++) {
+    tt_error_set_last(TT_ERROR_TIMEOUT);
+  }
+  TT_ASSERT_EQUAL(1u, event_calls, "%u");
+
+  wait_ms(60);
+  tt_error_set_last(TT_ERROR_TIMEOUT);
+  TT_ASSERT_EQUAL(2u, event_calls, "%u");
+  TT_ASSERT_EQUAL(99u, last_event.repeats, "%u");
+  TT_ASSERT(last_event.timestamp_ns > 0);
+
+  TT_ASSERT_EQUAL(TT_SUCCESS, tt_error_remove_event_callback(record_event),
+                  "%d");
+  TT_ASSERT_EQUAL(TT_ERROR_NOT_FOUND,
+                  tt_error_remove_event_callback(record_event), "%d");
+  return true;
+}
+
+TT_TEST(test_error_dedup_rate_limit) {
+  event_calls = 0;
+  TT_ASSERT_EQUAL(TT_SUCCESS, tt_error_add_event_callback(record_event), "%d");
+  TT_ASSERT_EQUAL(TT_SUCCESS, tt_error_set_rate_limit(TT_ERROR_BUSY, 4, 1),
+                  "%d");
+  TT_ASSERT_EQUAL(TT_SUCCESS, tt_error_set_dedup_window(TT_ERROR_BUSY, 150),
+                  "%d");
+
+  tt_error_set_last(TT_ERROR_BUSY);
+  TT_ASSERT_EQUAL(1u, event_calls, "%u");
+
+  // Past the window but before the 250ms refill: the bucket holds it back
+  wait_ms(200);
+  tt_error_set_last(TT_ERROR_BUSY);
+  TT_ASSERT_EQUAL(1u, event_calls, "%u");
+
+  // Refilled, and the suppressed report did not restart the window
+  wait_ms(100);
+  tt_error_set_last(TT_ERROR_BUSY);
+  TT_ASSERT_EQUAL(2u, event_calls, "%u");
+  TT_ASSERT_EQUAL(1u, last_event.repeats, "%u");
+  return true;
+}
+
+static volatile uint32_t async_first_calls;
+static volatile uint32_t async_second_calls;
+static volatile bool async_on_reporter;
+static _Thread_local bool is_reporter;
+
+static void async_first(tt_error_t error) {
+  (void)error;
+  if (is_reporter) {
+    async_on_reporter = true;
+  }
+  __atomic_fetch_add(&async_first_calls, 1, __ATOMIC_RELAXED);
+}
+
+static void async_second(tt_error_t error) {
+  (void)error;
+  __atomic_fetch_add(&async_second_calls, 1, __ATOMIC_RELAXED);
+}
+
+TT_TEST(test_error_multiple_callbacks) {
+  async_first_calls = 0;
+  async_second_calls = 0;
+
+  TT_ASSERT_EQUAL(TT_ERROR_NULL_POINTER, tt_error_add_callback(NULL), "%d");
+  TT_ASSERT_EQUAL(TT_SUCCESS, tt_error_add_callback(async_first), "%d");
+  TT_ASSERT_EQUAL(TT_SUCCESS, tt_error_add_callback(async_second), "%d");
+  TT_ASSERT_EQUAL(TT_SUCCESS, tt_error_set_last(TT_ERROR_BUSY), "%d");
+  TT_ASSERT_EQUAL(1u, async_first_calls, "%u");
+  TT_ASSERT_EQUAL(1u, async_second_calls, "%u");
+
+  TT_ASSERT_EQUAL(TT_SUCCESS, tt_error_remove_callback(async_second), "%d");
+  TT_ASSERT_EQUAL(TT_ERROR_NOT_FOUND, tt_error_remove_callback(async_second),
+                  "%d");
+  TT_ASSERT_EQUAL(TT_SUCCESS, tt_error_set_last(TT_ERROR_BUSY), "%d");
+  TT_ASSERT_EQUAL(2u, async_first_calls, "%u");
+  TT_ASSERT_EQUAL(1u, async_second_calls, "%u");
+
+  for (int i = 1; i < TT_ERROR_MAX_CALLBACKS; i++) {
+    TT_ASSERT_EQUAL(TT_SUCCESS, tt_error_add_callback(async_second), "%d");
+  }
+  TT_ASSERT_EQUAL(TT_ERROR_BUFFER_FULL, tt_error_add_callback(async_second),
+                  "%d");
+  return true;
+}
+
+#if defined(TT_CAP_THREADS)
+static void *error_other_thread(void *arg) {
+  (void)arg;
+  // Starts clean, whatever the spawning thread reported
+  if (tt_error_get_last() != TT_SUCCESS) {
+    return (void *)1;
+  }
+  tt_error_set_last(TT_ERROR_TIMEOUT);
+  return (tt_error_get_last() == TT_ERROR_TIMEOUT) ? NULL : (void *)1;
+}
+
+TT_TEST(test_error_async_dispatch) {
+  async_first_calls = 0;
+  async_second_calls = 0;
+  async_on_reporter = false;
+  is_reporter = true;
+
+  TT_ASSERT_EQUAL(TT_SUCCESS, tt_error_add_callback(async_first), "%d");
+  TT_ASSERT_EQUAL(TT_SUCCESS, tt_error_add_callback(async_second), "%d");
+  TT_ASSERT_EQUAL(TT_SUCCESS, tt_error_dispatch_start(), "%d");
+  TT_ASSERT_EQUAL(TT_ERROR_ALREADY_INITIALIZED, tt_error_dispatch_start(),
+                  "%d");
+
+  for (int i = 0; i < 32; i++) {
+    TT_ASSERT_EQUAL(TT_SUCCESS, tt_error_set_last(TT_ERROR_TIMEOUT), "%d");
+  }
+  TT_ASSERT_EQUAL(TT_ERROR_TIMEOUT, tt_error_get_last(), "%d");
+  TT_ASSERT_EQUAL(TT_SUCCESS, tt_error_dispatch_stop(), "%d");
+  TT_ASSERT_EQUAL(TT_ERROR_NOT_INITIALIZED, tt_error_dispatch_stop(), "%d");
+
+  // Stop delivers everything queued
+  TT_ASSERT_EQUAL(32u, async_first_calls, "%u");
+  TT_ASSERT_EQUAL(32u, async_second_calls, "%u");
+  TT_ASSERT(!async_on_reporter);
+  TT_ASSERT_EQUAL(0u, tt_error_dispatch_dropped(), "%u");
+  return true;
+}
+
+static tt_sem_t async_gate;
+
+static void async_blocking(tt_error_t error) {
+  (void)error;
+  tt_sem_wait(&async_gate);
+}
+
+TT_TEST(test_error_async_overflow) {
+  const uint32_t total = 4 * TT_ERROR_QUEUE_SIZE;
+
+  async_second_calls = 0;
+  TT_ASSERT_EQUAL(TT_SUCCESS, tt_sem_init(&async_gate, 0), "%d");
+  TT_ASSERT_EQUAL(TT_SUCCESS, tt_error_add_callback(async_blocking), "%d");
+  TT_ASSERT_EQUAL(TT_SUCCESS, tt_error_add_callback(async_second), "%d");
+  TT_ASSERT_EQUAL(TT_SUCCESS, tt_error_dispatch_start(), "%d");
+
+  // The dispatcher is stuck in the first callback, the reporter is not
+  for (uint32_t i = 0; i < total; i++) {
+    tt_error_set_last(TT_ERROR_BUFFER_FULL);
+  }
+  uint32_t dropped = tt_error_dispatch_dropped();
+  TT_ASSERT(dropped > 0);
+
+  for (uint32_t i = 0; i < total; i++) {
+    tt_sem_post(&async_gate);
+  }
+  TT_ASSERT_EQUAL(TT_SUCCESS, tt_error_dispatch_stop(), "%d");
+  TT_ASSERT_EQUAL(total, async_second_calls + dropped, "%u");
+  return true;
+}
+
+/* One-shot callback: removes itself once the gate opens */
+static void async_once(tt_error_t error) {
+  (void)error;
+  tt_sem_wait(&async_gate);
+  tt_error_remove_callback(async_once);
+  __atomic_fetch_add(&async_first_calls, 1, __ATOMIC_RELAXED);
+}
+
+static void *async_open_gate(void *arg) {
+  (void)arg;
+  // Late enough that tt_error_dispatch_stop is already joining
+  tt_thread_sleep(20);
+  tt_sem_post(&async_gate);
+  return NULL;
+}
+
+TT_TEST(test_error_async_stop_in_callback) {
+  tt_thread_t *opener;
+
+  async_first_calls = 0;
+  TT_ASSERT_EQUAL(TT_SUCCESS, tt_sem_init(&async_gate, 0), "%d");
+  TT_ASSERT_EQUAL(TT_SUCCESS, tt_error_add_callback(async_once), "%d");
+  TT_ASSERT_EQUAL(TT_SUCCESS, tt_error_dispatch_start(), "%d");
+  TT_ASSERT_EQUAL(TT_SUCCESS, tt_error_set_last(TT_ERROR_TIMEOUT), "%d");
+  TT_ASSERT_EQUAL(TT_SUCCESS,
+                  tt_thread_create(&opener, NULL, async_open_gate, NULL),
+                  "%d");
+
+  // The callback takes the registry lock while stop waits for it
+  TT_ASSERT_EQUAL(TT_SUCCESS, tt_error_dispatch_stop(), "%d");
+  TT_ASSERT_EQUAL(TT_SUCCESS, tt_thread_join(opener, NULL), "%d");
+  tt_thread_destroy(opener);
+  tt_sem_destroy(&async_gate);
+
+  TT_ASSERT_EQUAL(1u, async_first_calls, "%u");
+  TT_ASSERT_EQUAL(TT_ERROR_NOT_FOUND, tt_error_remove_callback(async_once),
+                  "%d");
+  return true;
+}
+
+TT_TEST(test_error_thread_local) {
+  tt_thread_t *thread;
+  void *retval;
+
+  TT_ASSERT_EQUAL(TT_SUCCESS, tt_error_set_last(TT_ERROR_BUFFER_FULL), "%d");
+  TT_ASSERT_EQUAL(TT_SUCCESS, tt_thread_init(), "%d");
+  TT_ASSERT_EQUAL(TT_SUCCESS,
+                  tt_thread_create(&thread, NULL, error_other_thread, NULL),
+                  "%d");
+  TT_ASSERT_EQUAL(TT_SUCCESS, tt_thread_join(thread, &retval), "%d");
+  tt_thread_destroy(thread);
+
+  TT_ASSERT(retval == NULL);
+  TT_ASSERT_EQUAL(TT_ERROR_BUFFER_FULL, tt_error_get_last(), "%d");
+  return true;
+}
+#endif /* TT_CAP_THREADS */
+
 int main(void) {
   TT_TEST_START("Error Handling Test Suite");
 
@@ -88,6 +437,20 @@ int main(void) {
   TT_RUN_TEST(test_error_callback);
   TT_RUN_TEST(test_error_clear);
   TT_RUN_TEST(test_error_uninitialized);
+  TT_RUN_TEST(test_error_raise);
+  TT_RUN_TEST(test_error_multiple_callbacks);
+  TT_RUN_TEST(test_error_rate_limit);
+  TT_RUN_TEST(test_error_dedup);
+  TT_RUN_TEST(test_error_dedup_rate_limit);
+#if !defined(TT_ERROR_NO_STATS)
+  TT_RUN_TEST(test_error_stats);
+#endif /* TT_ERROR_NO_STATS */
+#if defined(TT_CAP_THREADS)
+  TT_RUN_TEST(test_error_thread_local);
+  TT_RUN_TEST(test_error_async_dispatch);
+  TT_RUN_TEST(test_error_async_overflow);
+  TT_RUN_TEST(test_error_async_stop_in_callback);
+#endif /* TT_CAP_THREADS */
 
   TT_TEST_END();
   return 0;
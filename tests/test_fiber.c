@@ -0,0 +1,281 @@
+/**
+ * @file test_fiber.c
+ * @author Mihai Gurei <mihai.gurei@protonmail.com>
+ * @date 2025-02-10
+ * @brief Fiber test suite
+ * @copyright Copyright (c) 2025 AnAlphaBeta. All rights reserved.
+ */
+
+#include "tt_fiber.h"
+#include "tt_platform.h"
+#include "tt_test.h"
+#include <stdint.h>
+
+#define MANY_FIBERS 10000
+#define MANY_ROUNDS 4
+#define SMALL_STACK (16 * 1024)
+#define PING_PONG_ROUNDS 100000
+#define TIMED_ROUNDS 10000
+
+static volatile uint32_t counter;
+static volatile uint32_t gate;
+static volatile uint32_t finished;
+static volatile uint32_t turn;
+static size_t max_timers;
+
+void setUp(void) {
+  counter = 0;
+  gate = 0;
+  finished = 0;
+  turn = 0;
+  max_timers = 0;
+}
+
+void tearDown(void) {}
+
+#if defined(TT_CAP_THREADS)
+static void noop(void *arg) { (void)arg; }
+
+static void count_and_yield(void *arg) {
+  (void)arg;
+  for (int i = 0; i < MANY_ROUNDS; i++) {
+    __atomic_fetch_add(&counter, 1, __ATOMIC_RELAXED);
+    tt_fiber_yield();
+  }
+}
+
+/* Park on gate until the main thread opens it */
+static void wait_gate(void *arg) {
+  tt_error_t *result = (tt_error_t *)arg;
+
+  while (__atomic_load_n(&gate, __ATOMIC_ACQUIRE) == 0) {
+    *result = tt_fiber_wait(&gate, 0, TT_FIBER_WAIT_FOREVER);
+  }
+  __atomic_fetch_add(&finished, 1, __ATOMIC_RELEASE);
+}
+
+static void wait_timeout(void *arg) {
+  *(tt_error_t *)arg = tt_fiber_wait(&gate, 0, 10);
+}
+
+static void sleep_20ms(void *arg) {
+  uint64_t start = tt_platform_time_monotonic_ns();
+  tt_fiber_sleep(20);
+  *(uint64_t *)arg = tt_platform_time_monotonic_ns() - start;
+}
+
+static void ping_pong(void *arg) {
+  (void)arg;
+  for (int i = 0; i < PING_PONG_ROUNDS; i++) {
+    tt_fiber_yield();
+  }
+}
+
+/* Join another fiber from inside a fiber */
+static void join_child(void *arg) {
+  tt_fiber_scheduler_t *scheduler = (tt_fiber_scheduler_t *)arg;
+  tt_fiber_t *child;
+
+  if (tt_fiber_spawn(scheduler, sleep_20ms, (void *)&(uint64_t){0}, &child) ==
+          TT_SUCCESS &&
+      tt_fiber_join(child) == TT_SUCCESS) {
+    __atomic_fetch_add(&finished, 1, __ATOMIC_RELEASE);
+  }
+}
+
+/* Many short timed waits, each ended by a wake or a changed value */
+static void timed_waiter(void *arg) {
+  tt_fiber_scheduler_t *scheduler = (tt_fiber_scheduler_t *)arg;
+
+  for (uint32_t i = 0; i < TIMED_ROUNDS; i++) {
+    tt_fiber_wait(&turn, turn + 1, 1000);
+    while (__atomic_load_n(&turn, __ATOMIC_ACQUIRE) == i) {
+      tt_fiber_wait(&turn, i, 1000);
+    }
+    size_t timers = tt_fiber_scheduler_timers(scheduler);
+    if (timers > max_timers) {
+      max_timers = timers;
+    }
+  }
+}
+
+static void timed_waker(void *arg) {
+  (void)arg;
+  for (uint32_t i = 0; i < TIMED_ROUNDS; i++) {
+    __atomic_store_n(&turn, i + 1, __ATOMIC_RELEASE);
+    tt_fiber_wake(&turn, 1);
+    tt_fiber_yield();
+  }
+}
+#endif /* TT_CAP_THREADS */
+
+TT_TEST(test_fiber_invalid) {
+  tt_fiber_scheduler_t *scheduler;
+
+  TT_ASSERT_EQUAL(TT_ERROR_NULL_POINTER, tt_fiber_scheduler_create(NULL, 1, 0),
+                  "%d");
+#if defined(TT_CAP_THREADS)
+  TT_ASSERT_EQUAL(TT_ERROR_INVALID_PARAM,
+                  tt_fiber_scheduler_create(&scheduler, 0, 0), "%d");
+  TT_ASSERT_EQUAL(TT_ERROR_NULL_POINTER, tt_fiber_scheduler_destroy(NULL),
+                  "%d");
+  TT_ASSERT_EQUAL(TT_ERROR_NULL_POINTER, tt_fiber_spawn(NULL, noop, NULL, NULL),
+                  "%d");
+  TT_ASSERT_EQUAL(TT_ERROR_NULL_POINTER, tt_fiber_join(NULL), "%d");
+  TT_ASSERT_EQUAL(TT_ERROR_NULL_POINTER, tt_fiber_wait(NULL, 0, 0), "%d");
+  TT_ASSERT_EQUAL(TT_ERROR_NULL_POINTER, tt_fiber_wake(NULL, 1), "%d");
+  TT_ASSERT_EQUAL((size_t)0, tt_fiber_scheduler_timers(NULL), "%zu");
+
+  // Not inside a fiber
+  TT_ASSERT(tt_fiber_self() == NULL);
+  TT_ASSERT_EQUAL(TT_ERROR_NOT_INITIALIZED, tt_fiber_yield(), "%d");
+  TT_ASSERT_EQUAL(TT_ERROR_TIMEOUT, tt_fiber_wait(&gate, 0, 1), "%d");
+  TT_ASSERT_EQUAL(TT_SUCCESS, tt_fiber_wait(&gate, 1, 1), "%d");
+#else
+  TT_ASSERT_EQUAL(TT_ERROR_NOT_IMPLEMENTED,
+                  tt_fiber_scheduler_create(&scheduler, 1, 0), "%d");
+#endif /* TT_CAP_THREADS */
+  return true;
+}
+
+#if defined(TT_CAP_THREADS)
+TT_TEST(test_fiber_many) {
+  tt_fiber_scheduler_t *scheduler;
+
+  TT_ASSERT_EQUAL(TT_SUCCESS,
+                  tt_fiber_scheduler_create(&scheduler, 2, SMALL_STACK), "%d");
+
+  uint64_t start = tt_platform_time_monotonic_ns();
+  for (int i = 0; i < MANY_FIBERS; i++) {
+    TT_ASSERT_EQUAL(TT_SUCCESS,
+                    tt_fiber_spawn(scheduler, count_and_yield, NULL, NULL),
+                    "%d");
+  }
+  TT_ASSERT_EQUAL(TT_SUCCESS, tt_fiber_scheduler_destroy(scheduler), "%d");
+  uint64_t elapsed_ns = tt_platform_time_monotonic_ns() - start;
+
+  TT_ASSERT_EQUAL((uint32_t)(MANY_FIBERS * MANY_ROUNDS), counter, "%u");
+  printf(" [%.2fms for %d fibers]", (double)elapsed_ns / 1e6, MANY_FIBERS);
+  return true;
+}
+
+TT_TEST(test_fiber_wait_wake) {
+  tt_fiber_scheduler_t *scheduler;
+  tt_error_t results[4] = {TT_ERROR_UNKNOWN, TT_ERROR_UNKNOWN,
+                           TT_ERROR_UNKNOWN, TT_ERROR_UNKNOWN};
+  tt_error_t timeout_result = TT_ERROR_UNKNOWN;
+
+  TT_ASSERT_EQUAL(TT_SUCCESS, tt_fiber_scheduler_create(&scheduler, 2, 0),
+                  "%d");
+  for (int i = 0; i < 4; i++) {
+    TT_ASSERT_EQUAL(TT_SUCCESS,
+                    tt_fiber_spawn(scheduler, wait_gate, &results[i], NULL),
+                    "%d");
+  }
+  TT_ASSERT_EQUAL(TT_SUCCESS,
+                  tt_fiber_spawn(scheduler, wait_timeout, &timeout_result,
+                                 NULL),
+                  "%d");
+
+  // The waiters stay parked until the gate opens
+  tt_platform_thread_sleep(30);
+  TT_ASSERT_EQUAL(0U, finished, "%u");
+
+  __atomic_store_n(&gate, 1, __ATOMIC_RELEASE);
+  TT_ASSERT_EQUAL(TT_SUCCESS, tt_fiber_wake(&gate, TT_PLATFORM_WAKE_ALL),
+                  "%d");
+  TT_ASSERT_EQUAL(TT_SUCCESS, tt_fiber_scheduler_destroy(scheduler), "%d");
+
+  TT_ASSERT_EQUAL(4U, finished, "%u");
+  for (int i = 0; i < 4; i++) {
+    TT_ASSERT_EQUAL(TT_SUCCESS, results[i], "%d");
+  }
+  TT_ASSERT_EQUAL(TT_ERROR_TIMEOUT, timeout_result, "%d");
+  return true;
+}
+
+TT_TEST(test_fiber_sleep_join) {
+  tt_fiber_scheduler_t *scheduler;
+  tt_fiber_t *fiber;
+  uint64_t slept_ns = 0;
+
+  TT_ASSERT_EQUAL(TT_SUCCESS, tt_fiber_scheduler_create(&scheduler, 1, 0),
+                  "%d");
+  TT_ASSERT_EQUAL(TT_SUCCESS,
+                  tt_fiber_spawn(scheduler, sleep_20ms, &slept_ns, &fiber),
+                  "%d");
+  TT_ASSERT_EQUAL(TT_SUCCESS, tt_fiber_join(fiber), "%d");
+  TT_ASSERT(slept_ns >= 20000000ULL);
+
+  // Joining from a fiber parks only that fiber
+  TT_ASSERT_EQUAL(TT_SUCCESS,
+                  tt_fiber_spawn(scheduler, join_child, scheduler, &fiber),
+                  "%d");
+  TT_ASSERT_EQUAL(TT_SUCCESS, tt_fiber_join(fiber), "%d");
+  TT_ASSERT_EQUAL(1U, finished, "%u");
+
+  TT_ASSERT_EQUAL(TT_SUCCESS, tt_fiber_scheduler_destroy(scheduler), "%d");
+  return true;
+}
+
+TT_TEST(test_fiber_timers_bounded) {
+  tt_fiber_scheduler_t *scheduler;
+  tt_fiber_t *fibers[2];
+
+  TT_ASSERT_EQUAL(TT_SUCCESS, tt_fiber_scheduler_create(&scheduler, 1, 0),
+                  "%d");
+  TT_ASSERT_EQUAL(TT_SUCCESS,
+                  tt_fiber_spawn(scheduler, timed_waiter, scheduler,
+                                 &fibers[0]),
+                  "%d");
+  TT_ASSERT_EQUAL(TT_SUCCESS,
+                  tt_fiber_spawn(scheduler, timed_waker, NULL, &fibers[1]),
+                  "%d");
+  for (int i = 0; i < 2; i++) {
+    TT_ASSERT_EQUAL(TT_SUCCESS, tt_fiber_join(fibers[i]), "%d");
+  }
+
+  // Ended waits take their timeout along instead of leaving it to expire
+  TT_ASSERT(max_timers <= 1);
+  TT_ASSERT_EQUAL((size_t)0, tt_fiber_scheduler_timers(scheduler), "%zu");
+  TT_ASSERT_EQUAL(TT_SUCCESS, tt_fiber_scheduler_destroy(scheduler), "%d");
+  return true;
+}
+
+TT_TEST(test_fiber_switch_cost) {
+  tt_fiber_scheduler_t *scheduler;
+
+  TT_ASSERT_EQUAL(TT_SUCCESS, tt_fiber_scheduler_create(&scheduler, 1, 0),
+                  "%d");
+
+  uint64_t start = tt_platform_time_monotonic_ns();
+  TT_ASSERT_EQUAL(TT_SUCCESS, tt_fiber_spawn(scheduler, ping_pong, NULL, NULL),
+                  "%d");
+  TT_ASSERT_EQUAL(TT_SUCCESS, tt_fiber_spawn(scheduler, ping_pong, NULL, NULL),
+                  "%d");
+  TT_ASSERT_EQUAL(TT_SUCCESS, tt_fiber_scheduler_destroy(scheduler), "%d");
+  uint64_t elapsed_ns = tt_platform_time_monotonic_ns() - start;
+
+  printf(" [%.1fns per yield]",
+         (double)elapsed_ns / (2.0 * PING_PONG_ROUNDS));
+  return true;
+}
+#endif /* TT_CAP_THREADS */
+
+int main(void) {
+  TT_TEST_START("Fiber Test Suite");
+
+  TT_SET_FIXTURES(setUp, tearDown);
+
+  TT_RUN_TEST(test_fiber_invalid);
+#if defined(TT_CAP_THREADS)
+  TT_RUN_TEST(test_fiber_many);
+  TT_RUN_TEST(test_fiber_wait_wake);
+  TT_RUN_TEST(test_fiber_sleep_join);
+  TT_RUN_TEST(test_fiber_timers_bounded);
+  TT_RUN_TEST(test_fiber_switch_cost);
+#endif /* TT_CAP_THREADS */
+
+  TT_TEST_END();
+  return 0;
+}
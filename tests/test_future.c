@@ -0,0 +1,191 @@
+/**
+ * @file test_future.c
+ * @author Mihai Gurei <mihai.gurei@protonmail.com>
+ * @date 2025-01-30
+ * @brief Future test suite
+ * @copyright Copyright (c) 2025 AnAlphaBeta. All rights reserved.
+ */
+
+#include "tt_future.h"
+#include "tt_test.h"
+#include "tt_thread.h"
+#include "tt_threadpool.h"
+#include <stdint.h>
+
+void setUp(void) {}
+
+void tearDown(void) {}
+
+TT_TEST(test_future_null_pointer) {
+  TT_ASSERT_EQUAL(TT_ERROR_NULL_POINTER, tt_future_create(NULL), "%d");
+  TT_ASSERT(!tt_future_is_ready(NULL));
+#if defined(TT_CAP_THREADS)
+  TT_ASSERT_EQUAL(TT_ERROR_NULL_POINTER, tt_future_set(NULL, NULL), "%d");
+  TT_ASSERT_EQUAL(TT_ERROR_NULL_POINTER, tt_future_get(NULL, NULL), "%d");
+  TT_ASSERT_EQUAL(TT_ERROR_NULL_POINTER, tt_future_timedget(NULL, NULL, 0),
+                  "%d");
+  TT_ASSERT_EQUAL(TT_ERROR_NULL_POINTER, tt_future_then(NULL, NULL, NULL, NULL),
+                  "%d");
+  TT_ASSERT_EQUAL(TT_ERROR_NULL_POINTER,
+                  tt_future_async(NULL, NULL, NULL, NULL), "%d");
+  TT_ASSERT_EQUAL(TT_ERROR_NULL_POINTER, tt_future_release(NULL), "%d");
+#else
+  tt_future_t *future = NULL;
+  TT_ASSERT_EQUAL(TT_ERROR_NOT_IMPLEMENTED, tt_future_create(&future), "%d");
+#endif /* TT_CAP_THREADS */
+  return true;
+}
+
+#if defined(TT_CAP_THREADS)
+#define FUTURE_THREADS 4
+#define PIPELINE_LENGTH 1000
+
+static void *add_one(void *value, void *arg) {
+  (void)arg;
+  return (void *)((uintptr_t)value + 1);
+}
+
+static void *double_value(void *value, void *arg) {
+  (void)arg;
+  return (void *)((uintptr_t)value * 2);
+}
+
+static void *square(void *arg) {
+  uintptr_t n = (uintptr_t)arg;
+  return (void *)(n * n);
+}
+
+static void *record_thread(void *value, void *arg) {
+  *(tt_thread_t **)arg = tt_thread_self();
+  return value;
+}
+
+static void complete_task(void *arg) {
+  tt_future_set((tt_future_t *)arg, (void *)1);
+}
+
+TT_TEST(test_future_set_get) {
+  tt_future_t *future = NULL;
+  void *value = NULL;
+
+  TT_ASSERT_EQUAL(TT_SUCCESS, tt_future_create(&future), "%d");
+  TT_ASSERT(!tt_future_is_ready(future));
+  TT_ASSERT_EQUAL(TT_ERROR_TIMEOUT, tt_future_timedget(future, &value, 10),
+                  "%d");
+
+  TT_ASSERT_EQUAL(TT_SUCCESS, tt_future_set(future, (void *)42), "%d");
+  TT_ASSERT_EQUAL(TT_ERROR_ALREADY_INITIALIZED,
+                  tt_future_set(future, (void *)7), "%d");
+  TT_ASSERT(tt_future_is_ready(future));
+  TT_ASSERT_EQUAL(TT_SUCCESS, tt_future_get(future, &value), "%d");
+  TT_ASSERT_EQUAL(42UL, (unsigned long)(uintptr_t)value, "%lu");
+  TT_ASSERT_EQUAL(TT_SUCCESS, tt_future_timedget(future, &value, 0), "%d");
+
+  TT_ASSERT_EQUAL(TT_SUCCESS, tt_future_release(future), "%d");
+  return true;
+}
+
+TT_TEST(test_future_then_ordering) {
+  tt_future_t *future = NULL;
+  tt_future_t *added = NULL;
+  tt_future_t *doubled = NULL;
+  tt_future_t *late = NULL;
+  void *value = NULL;
+
+  TT_ASSERT_EQUAL(TT_SUCCESS, tt_future_create(&future), "%d");
+  TT_ASSERT_EQUAL(TT_SUCCESS, tt_future_then(future, add_one, NULL, &added),
+                  "%d");
+  TT_ASSERT_EQUAL(TT_SUCCESS,
+                  tt_future_then(added, double_value, NULL, &doubled), "%d");
+  TT_ASSERT(!tt_future_is_ready(doubled));
+
+  TT_ASSERT_EQUAL(TT_SUCCESS, tt_future_set(future, (void *)4), "%d");
+  TT_ASSERT(tt_future_is_ready(doubled));
+  TT_ASSERT_EQUAL(TT_SUCCESS, tt_future_get(doubled, &value), "%d");
+  TT_ASSERT_EQUAL(10UL, (unsigned long)(uintptr_t)value, "%lu");
+
+  // Chaining onto a completed future runs straight away
+  TT_ASSERT_EQUAL(TT_SUCCESS, tt_future_then(future, add_one, NULL, &late),
+                  "%d");
+  TT_ASSERT(tt_future_is_ready(late));
+
+  tt_future_release(late);
+  tt_future_release(doubled);
+  tt_future_release(added);
+  tt_future_release(future);
+  return true;
+}
+
+TT_TEST(test_future_unset_release) {
+  tt_future_t *future = NULL;
+  tt_future_t *next = NULL;
+
+  // Dropping a never completed future also frees its continuations
+  TT_ASSERT_EQUAL(TT_SUCCESS, tt_future_create(&future), "%d");
+  TT_ASSERT_EQUAL(TT_SUCCESS, tt_future_then(future, add_one, NULL, &next),
+                  "%d");
+  TT_ASSERT_EQUAL(TT_SUCCESS, tt_future_release(next), "%d");
+  TT_ASSERT_EQUAL(TT_SUCCESS, tt_future_release(future), "%d");
+  return true;
+}
+
+TT_TEST(test_future_async_pipeline) {
+  tt_threadpool_t *pool = NULL;
+  tt_future_t *futures[PIPELINE_LENGTH];
+  tt_future_t *stage;
+  tt_thread_t *ran_on = NULL;
+  void *value = NULL;
+
+  TT_ASSERT_EQUAL(TT_SUCCESS, tt_threadpool_create(&pool, FUTURE_THREADS, NULL),
+                  "%d");
+
+  // square(n) + 1 on the pool, no joins in between
+  for (uintptr_t i = 0; i < PIPELINE_LENGTH; i++) {
+    tt_future_t *squared = NULL;
+    TT_ASSERT_EQUAL(TT_SUCCESS,
+                    tt_future_async(pool, square, (void *)i, &squared), "%d");
+    TT_ASSERT_EQUAL(TT_SUCCESS,
+                    tt_future_then(squared, add_one, NULL, &futures[i]), "%d");
+    tt_future_release(squared);
+  }
+  for (uintptr_t i = 0; i < PIPELINE_LENGTH; i++) {
+    TT_ASSERT_EQUAL(TT_SUCCESS, tt_future_get(futures[i], &value), "%d");
+    TT_ASSERT_EQUAL((unsigned long)(i * i + 1),
+                    (unsigned long)(uintptr_t)value, "%lu");
+    tt_future_release(futures[i]);
+  }
+
+  // A continuation registered before completion runs on the pool worker
+  tt_future_t *gate = NULL;
+  TT_ASSERT_EQUAL(TT_SUCCESS, tt_future_create(&gate), "%d");
+  TT_ASSERT_EQUAL(TT_SUCCESS,
+                  tt_future_then(gate, record_thread, &ran_on, &stage), "%d");
+  TT_ASSERT_EQUAL(TT_SUCCESS, tt_threadpool_submit(pool, complete_task, gate),
+                  "%d");
+  TT_ASSERT_EQUAL(TT_SUCCESS, tt_future_get(stage, NULL), "%d");
+  TT_ASSERT(ran_on != NULL);
+  TT_ASSERT(ran_on != tt_thread_self());
+
+  tt_future_release(stage);
+  tt_future_release(gate);
+  TT_ASSERT_EQUAL(TT_SUCCESS, tt_threadpool_destroy(pool), "%d");
+  return true;
+}
+#endif /* TT_CAP_THREADS */
+
+int main(void) {
+  TT_TEST_START("Future Test Suite");
+
+  TT_SET_FIXTURES(setUp, tearDown);
+
+  TT_RUN_TEST(test_future_null_pointer);
+#if defined(TT_CAP_THREADS)
+  TT_RUN_TEST(test_future_set_get);
+  TT_RUN_TEST(test_future_then_ordering);
+  TT_RUN_TEST(test_future_unset_release);
+  TT_RUN_TEST(test_future_async_pipeline);
+#endif /* TT_CAP_THREADS */
+
+  TT_TEST_END();
+  return 0;
+}
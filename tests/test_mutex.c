@@ -6,11 +6,20 @@
  * @copyright Copyright (c) 2024 AnAlphaBeta. All rights reserved.
  */
 
+#define _GNU_SOURCE /* CPU affinity for the priority inversion test */
+
 #include "tt_error.h"
 #include "tt_mutex.h"
+#include "tt_sem.h"
 #include "tt_test.h"
+#include "tt_thread.h"
 #include <stddef.h>
 
+#if defined(TT_TARGET_LINUX) && defined(TT_CAP_THREADS)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
 #if defined(TT_CAP_MUTEX)
 static tt_mutex_t test_mutex;
 
@@ -52,6 +61,341 @@ TT_TEST(test_mutex_trylock) {
   return true;
 }
 
+TT_TEST(test_mutex_init_named) {
+  tt_mutex_t mutex;
+  TT_ASSERT_EQUAL(TT_ERROR_NULL_POINTER, tt_mutex_init_named(NULL, "x"), "%d");
+  TT_ASSERT_EQUAL(TT_SUCCESS, tt_mutex_init_named(&mutex, "test_named"), "%d");
+  TT_ASSERT_EQUAL(TT_SUCCESS, tt_mutex_lock(&mutex), "%d");
+  TT_ASSERT_EQUAL(TT_SUCCESS, tt_mutex_unlock(&mutex), "%d");
+  TT_ASSERT_EQUAL(TT_SUCCESS, tt_mutex_destroy(&mutex), "%d");
+  return true;
+}
+
+#if defined(TT_CAP_THREADS)
+static tt_mutex_t timed_mutex;
+static tt_sem_t timed_held;
+
+static void *timed_holder(void *arg) {
+  uint32_t hold_ms = *(uint32_t *)arg;
+  tt_mutex_lock(&timed_mutex);
+  tt_sem_post(&timed_held);
+  tt_thread_sleep(hold_ms);
+  tt_mutex_unlock(&timed_mutex);
+  return NULL;
+}
+
+TT_TEST(test_mutex_timedlock) {
+  tt_thread_t *thread;
+  uint32_t hold_ms;
+
+  TT_ASSERT_EQUAL(TT_ERROR_NULL_POINTER, tt_mutex_timedlock(NULL, 10), "%d");
+  TT_ASSERT_EQUAL(TT_SUCCESS, tt_thread_init(), "%d");
+  TT_ASSERT_EQUAL(TT_SUCCESS, tt_mutex_init(&timed_mutex), "%d");
+  TT_ASSERT_EQUAL(TT_SUCCESS, tt_sem_init(&timed_held, 0), "%d");
+
+  /* Uncontended */
+  TT_ASSERT_EQUAL(TT_SUCCESS, tt_mutex_timedlock(&timed_mutex, 10), "%d");
+  TT_ASSERT_EQUAL(TT_SUCCESS, tt_mutex_unlock(&timed_mutex), "%d");
+
+  /* Owner outlives the timeout */
+  hold_ms = 200;
+  TT_ASSERT_EQUAL(TT_SUCCESS,
+                  tt_thread_create(&thread, NULL, timed_holder, &hold_ms),
+                  "%d");
+  TT_ASSERT_EQUAL(TT_SUCCESS, tt_sem_wait(&timed_held), "%d");
+  uint64_t start = tt_platform_time_monotonic_ns();
+  TT_ASSERT_EQUAL(TT_ERROR_TIMEOUT, tt_mutex_timedlock(&timed_mutex, 50),
+                  "%d");
+  TT_ASSERT(tt_platform_time_monotonic_ns() - start >= 50000000ULL);
+  TT_ASSERT_EQUAL(TT_SUCCESS, tt_thread_join(thread, NULL), "%d");
+  tt_thread_destroy(thread);
+
+  /* Owner releases before the timeout */
+  hold_ms = 20;
+  TT_ASSERT_EQUAL(TT_SUCCESS,
+                  tt_thread_create(&thread, NULL, timed_holder, &hold_ms),
+                  "%d");
+  TT_ASSERT_EQUAL(TT_SUCCESS, tt_sem_wait(&timed_held), "%d");
+  TT_ASSERT_EQUAL(TT_SUCCESS, tt_mutex_timedlock(&timed_mutex, 1000), "%d");
+  TT_ASSERT_EQUAL(TT_SUCCESS, tt_mutex_unlock(&timed_mutex), "%d");
+  TT_ASSERT_EQUAL(TT_SUCCESS, tt_thread_join(thread, NULL), "%d");
+  tt_thread_destroy(thread);
+
+  tt_sem_destroy(&timed_held);
+  tt_mutex_destroy(&timed_mutex);
+  return true;
+}
+#endif /* TT_CAP_THREADS */
+
+#if defined(TT_MUTEX_STATS)
+static tt_mutex_t stats_mutex;
+
+static bool find_stats(const char *name, tt_mutex_stats_t *out) {
+  tt_mutex_stats_t stats[TT_MUTEX_STATS_MAX_LOCKS];
+  size_t count = tt_mutex_stats_snapshot(stats, TT_MUTEX_STATS_MAX_LOCKS);
+  for (size_t i = 0; i < count; i++) {
+    if (strcmp(stats[i].name, name) == 0) {
+      *out = stats[i];
+      return true;
+    }
+  }
+  return false;
+}
+
+static void *stats_contender(void *arg) {
+  (void)arg;
+  tt_mutex_lock(&stats_mutex);
+  tt_mutex_unlock(&stats_mutex);
+  return NULL;
+}
+
+TT_TEST(test_mutex_stats) {
+  tt_mutex_stats_t stats;
+
+  TT_ASSERT_EQUAL(TT_SUCCESS, tt_mutex_init_named(&stats_mutex, "test_stats"),
+                  "%d");
+  tt_mutex_stats_reset();
+  for (int i = 0; i < 10; i++) {
+    TT_ASSERT_EQUAL(TT_SUCCESS, tt_mutex_lock(&stats_mutex), "%d");
+    TT_ASSERT_EQUAL(TT_SUCCESS, tt_mutex_unlock(&stats_mutex), "%d");
+  }
+
+  TT_ASSERT(find_stats("test_stats", &stats));
+  TT_ASSERT_EQUAL(10ULL, (unsigned long long)stats.acquisitions, "%llu");
+  TT_ASSERT_EQUAL(0ULL, (unsigned long long)stats.contended, "%llu");
+
+  uint32_t holds = 0;
+  for (size_t b = 0; b < TT_MUTEX_STATS_BUCKETS; b++) {
+    holds += stats.hold_hist[b];
+  }
+  TT_ASSERT_EQUAL(10u, holds, "%u");
+
+#if defined(TT_CAP_THREADS)
+  tt_thread_t *thread;
+  TT_ASSERT_EQUAL(TT_SUCCESS, tt_thread_init(), "%d");
+  TT_ASSERT_EQUAL(TT_SUCCESS, tt_mutex_lock(&stats_mutex), "%d");
+  TT_ASSERT_EQUAL(TT_SUCCESS,
+                  tt_thread_create(&thread, NULL, stats_contender, NULL), "%d");
+  tt_thread_sleep(20);
+  TT_ASSERT_EQUAL(TT_SUCCESS, tt_mutex_unlock(&stats_mutex), "%d");
+  TT_ASSERT_EQUAL(TT_SUCCESS, tt_thread_join(thread, NULL), "%d");
+  tt_thread_destroy(thread);
+
+  TT_ASSERT(find_stats("test_stats", &stats));
+  TT_ASSERT_EQUAL(12ULL, (unsigned long long)stats.acquisitions, "%llu");
+  TT_ASSERT_EQUAL(1ULL, (unsigned long long)stats.contended, "%llu");
+  TT_ASSERT(stats.wait_max_ns >= 10000000ULL);
+  TT_ASSERT_EQUAL((unsigned long long)stats.wait_max_ns,
+                  (unsigned long long)stats.wait_total_ns, "%llu");
+
+  // Most contended lock is reported first
+  tt_mutex_stats_t top;
+  TT_ASSERT_EQUAL((size_t)1, tt_mutex_stats_snapshot(&top, 1), "%zu");
+  TT_ASSERT_STR_EQUAL("test_stats", top.name);
+#else
+  (void)stats_contender;
+#endif /* TT_CAP_THREADS */
+
+  TT_ASSERT_EQUAL(TT_SUCCESS, tt_mutex_destroy(&stats_mutex), "%d");
+  return true;
+}
+#endif /* TT_MUTEX_STATS */
+
+TT_TEST(test_mutex_attr) {
+  tt_mutex_attr_t attr;
+  tt_mutex_t mutex;
+
+  TT_ASSERT_EQUAL(TT_ERROR_NULL_POINTER, tt_mutex_attr_init(NULL), "%d");
+  TT_ASSERT_EQUAL(TT_SUCCESS, tt_mutex_attr_init(&attr), "%d");
+  TT_ASSERT_EQUAL(TT_MUTEX_PROTOCOL_NONE, attr.protocol, "%d");
+
+  attr.protocol = TT_MUTEX_PROTOCOL_INHERIT;
+  attr.name = "test_pi";
+  TT_ASSERT_EQUAL(TT_SUCCESS, tt_mutex_init_attr(&mutex, &attr), "%d");
+  TT_ASSERT_EQUAL(TT_SUCCESS, tt_mutex_lock(&mutex), "%d");
+  TT_ASSERT_EQUAL(TT_ERROR_BUSY, tt_mutex_trylock(&mutex), "%d");
+  TT_ASSERT_EQUAL(TT_SUCCESS, tt_mutex_unlock(&mutex), "%d");
+  TT_ASSERT_EQUAL(TT_SUCCESS, tt_mutex_destroy(&mutex), "%d");
+
+  attr.protocol = (tt_mutex_protocol_t)42;
+  TT_ASSERT_EQUAL(TT_ERROR_INVALID_PARAM, tt_mutex_init_attr(&mutex, &attr),
+                  "%d");
+  return true;
+}
+
+#if defined(TT_TARGET_LINUX) && defined(TT_CAP_THREADS)
+#define INVERSION_HOLD_MS 5
+#define INVERSION_HOG_MS 200
+
+static tt_mutex_t inversion_mutex;
+static tt_sem_t inversion_go;
+static uint64_t inversion_blocked_ns;
+
+static bool set_fifo(int priority) {
+  struct sched_param param = {.sched_priority = priority};
+  return pthread_setschedparam(pthread_self(), SCHED_FIFO, &param) == 0;
+}
+
+static void spin_ms(uint32_t ms) {
+  uint64_t end = tt_platform_time_monotonic_ns() + ms * 1000000ULL;
+  while (tt_platform_time_monotonic_ns() < end) {
+  }
+}
+
+static void *inversion_low(void *arg) {
+  (void)arg;
+  set_fifo(10);
+  tt_mutex_lock(&inversion_mutex);
+  tt_sem_wait(&inversion_go);
+  spin_ms(INVERSION_HOLD_MS);
+  tt_mutex_unlock(&inversion_mutex);
+  return NULL;
+}
+
+static void *inversion_medium(void *arg) {
+  (void)arg;
+  set_fifo(20);
+  spin_ms(INVERSION_HOG_MS);
+  return NULL;
+}
+
+static void *inversion_high(void *arg) {
+  (void)arg;
+  set_fifo(30);
+  uint64_t start = tt_platform_time_monotonic_ns();
+  tt_mutex_lock(&inversion_mutex);
+  inversion_blocked_ns = tt_platform_time_monotonic_ns() - start;
+  tt_mutex_unlock(&inversion_mutex);
+  return NULL;
+}
+
+/*
+ * Low priority thread holds the lock, high priority thread blocks on it
+ * while a medium priority thread hogs the only CPU. Threads inherit the
+ * orchestrating thread's FIFO 40 and drop to their own priority once they
+ * run, so the order of events is deterministic.
+ */
+static bool run_inversion(tt_mutex_protocol_t protocol, uint64_t *blocked_ns) {
+  tt_mutex_attr_t attr;
+  tt_thread_t *low, *medium, *high;
+
+  tt_mutex_attr_init(&attr);
+  attr.protocol = protocol;
+  TT_ASSERT_EQUAL(TT_SUCCESS, tt_mutex_init_attr(&inversion_mutex, &attr),
+                  "%d");
+  TT_ASSERT_EQUAL(TT_SUCCESS, tt_sem_init(&inversion_go, 0), "%d");
+
+  TT_ASSERT_EQUAL(TT_SUCCESS,
+                  tt_thread_create(&low, NULL, inversion_low, NULL), "%d");
+  tt_thread_sleep(10); // Let low take the lock and park
+  TT_ASSERT_EQUAL(TT_SUCCESS, tt_sem_post(&inversion_go), "%d");
+  TT_ASSERT_EQUAL(TT_SUCCESS,
+                  tt_thread_create(&high, NULL, inversion_high, NULL), "%d");
+  TT_ASSERT_EQUAL(TT_SUCCESS,
+                  tt_thread_create(&medium, NULL, inversion_medium, NULL),
+                  "%d");
+
+  TT_ASSERT_EQUAL(TT_SUCCESS, tt_thread_join(high, NULL), "%d");
+  TT_ASSERT_EQUAL(TT_SUCCESS, tt_thread_join(medium, NULL), "%d");
+  TT_ASSERT_EQUAL(TT_SUCCESS, tt_thread_join(low, NULL), "%d");
+  tt_thread_destroy(high);
+  tt_thread_destroy(medium);
+  tt_thread_destroy(low);
+
+  tt_sem_destroy(&inversion_go);
+  tt_mutex_destroy(&inversion_mutex);
+  *blocked_ns = inversion_blocked_ns;
+  return true;
+}
+
+TT_TEST(test_mutex_priority_inheritance) {
+  struct sched_param saved_param;
+  int saved_policy;
+  cpu_set_t saved_cpus, one_cpu;
+
+  TT_ASSERT_EQUAL(TT_SUCCESS, tt_thread_init(), "%d");
+  pthread_getschedparam(pthread_self(), &saved_policy, &saved_param);
+  pthread_getaffinity_np(pthread_self(), sizeof(saved_cpus), &saved_cpus);
+
+  // Run everything on one CPU so the medium thread can starve the owner
+  CPU_ZERO(&one_cpu);
+  for (int cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+    if (CPU_ISSET(cpu, &saved_cpus)) {
+      CPU_SET(cpu, &one_cpu);
+      break;
+    }
+  }
+  pthread_setaffinity_np(pthread_self(), sizeof(one_cpu), &one_cpu);
+
+  if (!set_fifo(40)) {
+    pthread_setaffinity_np(pthread_self(), sizeof(saved_cpus), &saved_cpus);
+    printf(" [skipped: SCHED_FIFO not permitted]");
+    return true;
+  }
+
+  uint64_t pi_ns = 0, plain_ns = 0;
+  bool ok = run_inversion(TT_MUTEX_PROTOCOL_INHERIT, &pi_ns) &&
+            run_inversion(TT_MUTEX_PROTOCOL_NONE, &plain_ns);
+
+  pthread_setschedparam(pthread_self(), saved_policy, &saved_param);
+  pthread_setaffinity_np(pthread_self(), sizeof(saved_cpus), &saved_cpus);
+  TT_ASSERT(ok);
+
+  printf(" [blocked: inherit %.1fms, none %.1fms]", (double)pi_ns / 1e6,
+         (double)plain_ns / 1e6);
+
+  // With inheritance the owner preempts the hog, so the high priority
+  // thread waits for the critical section only
+  TT_ASSERT(pi_ns < (INVERSION_HOG_MS / 4) * 1000000ULL);
+  return true;
+}
+#endif /* TT_TARGET_LINUX && TT_CAP_THREADS */
+
+#if defined(TT_LOCKDEP)
+TT_TEST(test_mutex_lockdep_inversion) {
+  tt_mutex_t a, b, c;
+  TT_ASSERT_EQUAL(TT_SUCCESS, tt_mutex_init_named(&a, "lockdep_a"), "%d");
+  TT_ASSERT_EQUAL(TT_SUCCESS, tt_mutex_init_named(&b, "lockdep_b"), "%d");
+  TT_ASSERT_EQUAL(TT_SUCCESS, tt_mutex_init(&c), "%d");
+  tt_lockdep_reset();
+
+  // Establish a -> b -> c
+  TT_ASSERT_EQUAL(TT_SUCCESS, tt_mutex_lock(&a), "%d");
+  TT_ASSERT_EQUAL(TT_SUCCESS, tt_mutex_lock(&b), "%d");
+  TT_ASSERT_EQUAL(TT_SUCCESS, tt_mutex_lock(&c), "%d");
+  TT_ASSERT_EQUAL(TT_SUCCESS, tt_mutex_unlock(&c), "%d");
+  TT_ASSERT_EQUAL(TT_SUCCESS, tt_mutex_unlock(&b), "%d");
+  TT_ASSERT_EQUAL(TT_SUCCESS, tt_mutex_unlock(&a), "%d");
+  TT_ASSERT_EQUAL(0u, tt_lockdep_violations(), "%u");
+
+  // Consistent order and trylock never report
+  TT_ASSERT_EQUAL(TT_SUCCESS, tt_mutex_lock(&a), "%d");
+  TT_ASSERT_EQUAL(TT_SUCCESS, tt_mutex_lock(&c), "%d");
+  TT_ASSERT_EQUAL(TT_SUCCESS, tt_mutex_unlock(&c), "%d");
+  TT_ASSERT_EQUAL(TT_SUCCESS, tt_mutex_unlock(&a), "%d");
+  TT_ASSERT_EQUAL(TT_SUCCESS, tt_mutex_lock(&b), "%d");
+  TT_ASSERT_EQUAL(TT_SUCCESS, tt_mutex_trylock(&a), "%d");
+  TT_ASSERT_EQUAL(TT_SUCCESS, tt_mutex_unlock(&a), "%d");
+  TT_ASSERT_EQUAL(TT_SUCCESS, tt_mutex_unlock(&b), "%d");
+  TT_ASSERT_EQUAL(0u, tt_lockdep_violations(), "%u");
+
+  // c -> a closes the cycle through b, reported once without deadlocking
+  printf("\n");
+  for (int i = 0; i < 2; i++) {
+    TT_ASSERT_EQUAL(TT_SUCCESS, tt_mutex_lock(&c), "%d");
+    TT_ASSERT_EQUAL(TT_SUCCESS, tt_mutex_lock(&a), "%d");
+    TT_ASSERT_EQUAL(TT_SUCCESS, tt_mutex_unlock(&a), "%d");
+    TT_ASSERT_EQUAL(TT_SUCCESS, tt_mutex_unlock(&c), "%d");
+  }
+  TT_ASSERT_EQUAL(1u, tt_lockdep_violations(), "%u");
+
+  tt_mutex_destroy(&c);
+  tt_mutex_destroy(&b);
+  tt_mutex_destroy(&a);
+  return true;
+}
+#endif /* TT_LOCKDEP */
+
 #else  /* General non platform specific mutex implementation */
 static tt_mutex_t test_mutex;
 
@@ -92,6 +436,25 @@ TT_TEST(test_mutex_trylock) {
   TT_ASSERT(!tt_mutex_is_locked(&test_mutex));
   return true;
 }
+
+static uint32_t yield_calls;
+
+static void count_yield(void) { yield_calls++; }
+
+TT_TEST(test_mutex_yield_hook) {
+  yield_calls = 0;
+  tt_mutex_set_yield_hook(count_yield);
+
+  TT_ASSERT_EQUAL(TT_SUCCESS, tt_mutex_lock(&test_mutex), "%d");
+  TT_ASSERT_EQUAL(TT_ERROR_TIMEOUT, tt_mutex_timedlock(&test_mutex, 5), "%d");
+  TT_ASSERT(yield_calls > 0);
+  TT_ASSERT_EQUAL(TT_SUCCESS, tt_mutex_unlock(&test_mutex), "%d");
+
+  tt_mutex_set_yield_hook(NULL);
+  TT_ASSERT_EQUAL(TT_SUCCESS, tt_mutex_timedlock(&test_mutex, 5), "%d");
+  TT_ASSERT_EQUAL(TT_SUCCESS, tt_mutex_unlock(&test_mutex), "%d");
+  return true;
+}
 #endif /* TT_CAP_MUTEX */
 
 int main(void) {
@@ -104,11 +467,26 @@ int main(void) {
   TT_RUN_TEST(test_mutex_null_pointer);
   TT_RUN_TEST(test_mutex_lock_unlock);
   TT_RUN_TEST(test_mutex_trylock);
+  TT_RUN_TEST(test_mutex_init_named);
+  TT_RUN_TEST(test_mutex_attr);
+#if defined(TT_CAP_THREADS)
+  TT_RUN_TEST(test_mutex_timedlock);
+#endif /* TT_CAP_THREADS */
+#if defined(TT_TARGET_LINUX) && defined(TT_CAP_THREADS)
+  TT_RUN_TEST(test_mutex_priority_inheritance);
+#endif /* TT_TARGET_LINUX && TT_CAP_THREADS */
+#if defined(TT_MUTEX_STATS)
+  TT_RUN_TEST(test_mutex_stats);
+#endif /* TT_MUTEX_STATS */
+#if defined(TT_LOCKDEP)
+  TT_RUN_TEST(test_mutex_lockdep_inversion);
+#endif /* TT_LOCKDEP */
 #else
   TT_RUN_TEST(test_mutex_init);
   TT_RUN_TEST(test_mutex_null_pointer);
   TT_RUN_TEST(test_mutex_lock_unlock);
   TT_RUN_TEST(test_mutex_trylock);
+  TT_RUN_TEST(test_mutex_yield_hook);
 #endif /* TT_CAP_MUTEX*/
 
   TT_TEST_END();
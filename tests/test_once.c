@@ -0,0 +1,122 @@
+/**
+ * @file test_once.c
+ * @author Mihai Gurei <mihai.gurei@protonmail.com>
+ * @date 2025-01-14
+ * @brief One-time initialization test suite
+ * @copyright Copyright (c) 2025 AnAlphaBeta. All rights reserved.
+ */
+
+#include "tt_once.h"
+#include "tt_platform.h"
+#include "tt_test.h"
+#include "tt_thread.h"
+#include <stdint.h>
+
+static tt_once_t test_once;
+static uint32_t init_calls;
+static tt_error_t init_result;
+
+void setUp(void) {
+  tt_once_reset(&test_once);
+  init_calls = 0;
+  init_result = TT_SUCCESS;
+}
+
+void tearDown(void) {}
+
+static tt_error_t counting_init(void) {
+  __atomic_fetch_add(&init_calls, 1, __ATOMIC_RELAXED);
+  return init_result;
+}
+
+TT_TEST(test_once_null_pointer) {
+  TT_ASSERT_EQUAL(TT_ERROR_NULL_POINTER, tt_call_once(&test_once, NULL), "%d");
+  TT_ASSERT_EQUAL(TT_ERROR_NULL_POINTER, tt_call_once_slow(NULL, counting_init),
+                  "%d");
+  return true;
+}
+
+TT_TEST(test_once_runs_once) {
+  TT_ASSERT(!tt_once_is_done(&test_once));
+  for (int i = 0; i < 3; i++) {
+    TT_ASSERT_EQUAL(TT_SUCCESS, tt_call_once(&test_once, counting_init), "%d");
+  }
+  TT_ASSERT_EQUAL(1u, init_calls, "%u");
+  TT_ASSERT(tt_once_is_done(&test_once));
+
+  tt_once_reset(&test_once);
+  TT_ASSERT_EQUAL(TT_SUCCESS, tt_call_once(&test_once, counting_init), "%d");
+  TT_ASSERT_EQUAL(2u, init_calls, "%u");
+  return true;
+}
+
+TT_TEST(test_once_failure_retries) {
+  init_result = TT_ERROR_MEMORY;
+  TT_ASSERT_EQUAL(TT_ERROR_MEMORY, tt_call_once(&test_once, counting_init),
+                  "%d");
+  TT_ASSERT(!tt_once_is_done(&test_once));
+
+  init_result = TT_SUCCESS;
+  TT_ASSERT_EQUAL(TT_SUCCESS, tt_call_once(&test_once, counting_init), "%d");
+  TT_ASSERT_EQUAL(2u, init_calls, "%u");
+  TT_ASSERT(tt_once_is_done(&test_once));
+  return true;
+}
+
+#if defined(TT_CAP_THREADS)
+#define ONCE_THREADS 8
+
+static volatile bool slow_init_done;
+
+static tt_error_t slow_init(void) {
+  __atomic_fetch_add(&init_calls, 1, __ATOMIC_RELAXED);
+  tt_thread_sleep(50);
+  slow_init_done = true;
+  return TT_SUCCESS;
+}
+
+static void *once_caller(void *arg) {
+  (void)arg;
+  if (tt_call_once(&test_once, slow_init) != TT_SUCCESS) {
+    return (void *)0;
+  }
+  // Nobody returns before the initializer has finished
+  return (void *)(uintptr_t)slow_init_done;
+}
+
+TT_TEST(test_once_concurrent) {
+  tt_thread_t *threads[ONCE_THREADS];
+  void *retval;
+
+  slow_init_done = false;
+  TT_ASSERT_EQUAL(TT_SUCCESS, tt_thread_init(), "%d");
+  for (int i = 0; i < ONCE_THREADS; i++) {
+    TT_ASSERT_EQUAL(TT_SUCCESS,
+                    tt_thread_create(&threads[i], NULL, once_caller, NULL),
+                    "%d");
+  }
+  for (int i = 0; i < ONCE_THREADS; i++) {
+    TT_ASSERT_EQUAL(TT_SUCCESS, tt_thread_join(threads[i], &retval), "%d");
+    TT_ASSERT_EQUAL(1u, (unsigned)(uintptr_t)retval, "%u");
+    tt_thread_destroy(threads[i]);
+  }
+  TT_ASSERT_EQUAL(1u, init_calls, "%u");
+  return true;
+}
+#endif /* TT_CAP_THREADS */
+
+int main(void) {
+  TT_TEST_START("Once Test Suite");
+
+  TT_SET_FIXTURES(setUp, tearDown);
+
+  TT_RUN_TEST(test_once_null_pointer);
+  TT_RUN_TEST(test_once_runs_once);
+  TT_RUN_TEST(test_once_failure_retries);
+#if defined(TT_CAP_THREADS)
+  TT_RUN_TEST(test_once_concurrent);
+#endif /* TT_CAP_THREADS */
+
+  TT_TEST_END();
+  return 0;
+}
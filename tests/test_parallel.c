@@ -0,0 +1,171 @@
+/**
+ * @file test_parallel.c
+ * @author Mihai Gurei <mihai.gurei@protonmail.com>
+ * @date 2025-02-03
+ * @brief Parallel loop test suite
+ * @copyright Copyright (c) 2025 AnAlphaBeta. All rights reserved.
+ */
+
+#include "tt_parallel.h"
+#include "tt_platform.h"
+#include "tt_test.h"
+#include <stdint.h>
+
+#define SAMPLES 1000000
+#define ODD_SAMPLES 1001
+
+static float input[SAMPLES];
+static _Alignas(64) float output[SAMPLES];
+static volatile uint32_t body_calls;
+static volatile uint32_t misaligned_splits;
+
+void setUp(void) {
+  for (size_t i = 0; i < SAMPLES; i++) {
+    input[i] = (float)(i % 1000);
+    output[i] = 0.0f;
+  }
+  body_calls = 0;
+  misaligned_splits = 0;
+}
+
+void tearDown(void) {}
+
+static void scale(size_t begin, size_t end, void *ctx) {
+  float gain = *(const float *)ctx;
+
+  __atomic_fetch_add(&body_calls, 1, __ATOMIC_RELAXED);
+  if (begin % TT_PARALLEL_SPLIT_ALIGN != 0) {
+    __atomic_fetch_add(&misaligned_splits, 1, __ATOMIC_RELAXED);
+  }
+  for (size_t i = begin; i < end; i++) {
+    output[i] = input[i] * gain;
+  }
+}
+
+static void sum_range(size_t begin, size_t end, void *acc, void *ctx) {
+  (void)ctx;
+  uint64_t *sum = (uint64_t *)acc;
+  for (size_t i = begin; i < end; i++) {
+    *sum += (uint64_t)input[i];
+  }
+}
+
+static void sum_join(void *acc, const void *other, void *ctx) {
+  (void)ctx;
+  *(uint64_t *)acc += *(const uint64_t *)other;
+}
+
+/* Record the first index seen, joins must keep left-to-right order */
+static void first_range(size_t begin, size_t end, void *acc, void *ctx) {
+  (void)ctx;
+  size_t *first = (size_t *)acc;
+  if (begin < end && *first == SIZE_MAX) {
+    *first = begin;
+  }
+}
+
+static void first_join(void *acc, const void *other, void *ctx) {
+  (void)ctx;
+  if (*(size_t *)acc == SIZE_MAX) {
+    *(size_t *)acc = *(const size_t *)other;
+  }
+}
+
+TT_TEST(test_parallel_invalid) {
+  uint64_t sum = 0;
+  const uint64_t zero = 0;
+  unsigned char big[TT_PARALLEL_REDUCE_MAX_SIZE + 1] = {0};
+
+  TT_ASSERT_EQUAL(TT_ERROR_NULL_POINTER, tt_parallel_for(0, 1, 0, NULL, NULL),
+                  "%d");
+  TT_ASSERT_EQUAL(TT_ERROR_NULL_POINTER,
+                  tt_parallel_reduce(0, 1, 0, NULL, sizeof(sum), &zero,
+                                     sum_range, sum_join, NULL),
+                  "%d");
+  TT_ASSERT_EQUAL(TT_ERROR_INVALID_PARAM,
+                  tt_parallel_reduce(0, 1, 0, big, sizeof(big), big, sum_range,
+                                     sum_join, NULL),
+                  "%d");
+
+  // Empty range does nothing
+  float gain = 2.0f;
+  TT_ASSERT_EQUAL(TT_SUCCESS, tt_parallel_for(5, 5, 0, scale, &gain), "%d");
+  TT_ASSERT_EQUAL(0U, body_calls, "%u");
+  return true;
+}
+
+TT_TEST(test_parallel_for) {
+  float gain = 0.5f;
+
+  TT_ASSERT_EQUAL(TT_SUCCESS, tt_parallel_for(0, SAMPLES, 0, scale, &gain),
+                  "%d");
+  for (size_t i = 0; i < SAMPLES; i++) {
+    if (output[i] != input[i] * gain) {
+      TT_ASSERT_EQUAL((double)(input[i] * gain), (double)output[i], "%f");
+    }
+  }
+#if defined(TT_CAP_THREADS)
+  TT_ASSERT(body_calls > 1);
+#endif /* TT_CAP_THREADS */
+  // Every piece starts on a cache line of the float output
+  TT_ASSERT_EQUAL(0U, misaligned_splits, "%u");
+  return true;
+}
+
+TT_TEST(test_parallel_for_grain) {
+  float gain = 3.0f;
+
+  // Odd size and tiny grain: every index must be visited exactly once
+  TT_ASSERT_EQUAL(TT_SUCCESS, tt_parallel_for(0, ODD_SAMPLES, 1, scale, &gain),
+                  "%d");
+  for (size_t i = 0; i < ODD_SAMPLES; i++) {
+    TT_ASSERT(output[i] == input[i] * gain);
+  }
+  TT_ASSERT(output[ODD_SAMPLES] == 0.0f);
+  return true;
+}
+
+TT_TEST(test_parallel_reduce) {
+  const uint64_t zero = 0;
+  uint64_t sum = 0;
+  uint64_t expected = 0;
+
+  for (size_t i = 0; i < SAMPLES; i++) {
+    expected += (uint64_t)input[i];
+  }
+
+  uint64_t start = tt_platform_time_monotonic_ns();
+  TT_ASSERT_EQUAL(TT_SUCCESS,
+                  tt_parallel_reduce(0, SAMPLES, 0, &sum, sizeof(sum), &zero,
+                                     sum_range, sum_join, NULL),
+                  "%d");
+  uint64_t elapsed_ns = tt_platform_time_monotonic_ns() - start;
+  TT_ASSERT_EQUAL((unsigned long)expected, (unsigned long)sum, "%lu");
+
+  const size_t none = SIZE_MAX;
+  size_t first = SIZE_MAX;
+  TT_ASSERT_EQUAL(TT_SUCCESS,
+                  tt_parallel_reduce(17, SAMPLES, 64, &first, sizeof(first),
+                                     &none, first_range, first_join, NULL),
+                  "%d");
+  TT_ASSERT_EQUAL((size_t)17, first, "%zu");
+
+  printf(" [%.2fms for %d samples]", (double)elapsed_ns / 1e6, SAMPLES);
+  return true;
+}
+
+int main(void) {
+  TT_TEST_START("Parallel Loop Test Suite");
+
+  TT_SET_FIXTURES(setUp, tearDown);
+
+  TT_RUN_TEST(test_parallel_invalid);
+  TT_RUN_TEST(test_parallel_for);
+  TT_RUN_TEST(test_parallel_for_grain);
+  TT_RUN_TEST(test_parallel_reduce);
+
+  tt_parallel_cleanup();
+
+  TT_TEST_END();
+  return 0;
+}
@@ -0,0 +1,139 @@
+/**
+ * @file test_sem.c
+ * @author Mihai Gurei <mihai.gurei@protonmail.com>
+ * @date 2025-01-12
+ * @brief Counting semaphore test suite
+ * @copyright Copyright (c) 2025 AnAlphaBeta. All rights reserved.
+ */
+
+#include "tt_platform.h"
+#include "tt_sem.h"
+#include "tt_test.h"
+#include "tt_thread.h"
+#include <stdint.h>
+
+static tt_sem_t test_sem;
+
+void setUp(void) { tt_sem_init(&test_sem, 0); }
+
+void tearDown(void) { tt_sem_destroy(&test_sem); }
+
+TT_TEST(test_sem_null_pointer) {
+  TT_ASSERT_EQUAL(TT_ERROR_NULL_POINTER, tt_sem_init(NULL, 0), "%d");
+  TT_ASSERT_EQUAL(TT_ERROR_NULL_POINTER, tt_sem_post(NULL), "%d");
+  TT_ASSERT_EQUAL(TT_ERROR_NULL_POINTER, tt_sem_wait(NULL), "%d");
+  TT_ASSERT_EQUAL(TT_ERROR_NULL_POINTER, tt_sem_trywait(NULL), "%d");
+  TT_ASSERT_EQUAL(TT_ERROR_NULL_POINTER, tt_sem_timedwait(NULL, 0), "%d");
+  TT_ASSERT_EQUAL(TT_ERROR_NULL_POINTER, tt_sem_destroy(NULL), "%d");
+  TT_ASSERT_EQUAL(0u, tt_sem_get_value(NULL), "%u");
+  return true;
+}
+
+TT_TEST(test_sem_post_trywait) {
+  TT_ASSERT_EQUAL(TT_ERROR_BUSY, tt_sem_trywait(&test_sem), "%d");
+
+  TT_ASSERT_EQUAL(TT_SUCCESS, tt_sem_post(&test_sem), "%d");
+  TT_ASSERT_EQUAL(TT_SUCCESS, tt_sem_post(&test_sem), "%d");
+  TT_ASSERT_EQUAL(2u, tt_sem_get_value(&test_sem), "%u");
+
+  TT_ASSERT_EQUAL(TT_SUCCESS, tt_sem_trywait(&test_sem), "%d");
+  TT_ASSERT_EQUAL(TT_SUCCESS, tt_sem_wait(&test_sem), "%d");
+  TT_ASSERT_EQUAL(0u, tt_sem_get_value(&test_sem), "%u");
+  TT_ASSERT_EQUAL(TT_ERROR_BUSY, tt_sem_trywait(&test_sem), "%d");
+  return true;
+}
+
+TT_TEST(test_sem_timedwait) {
+  uint64_t start = tt_platform_time_monotonic_ns();
+  TT_ASSERT_EQUAL(TT_ERROR_TIMEOUT, tt_sem_timedwait(&test_sem, 50), "%d");
+  uint64_t elapsed_ms = (tt_platform_time_monotonic_ns() - start) / 1000000;
+  TT_ASSERT(elapsed_ms >= 50);
+
+  TT_ASSERT_EQUAL(TT_SUCCESS, tt_sem_post(&test_sem), "%d");
+  TT_ASSERT_EQUAL(TT_SUCCESS, tt_sem_timedwait(&test_sem, 50), "%d");
+  return true;
+}
+
+#if defined(TT_CAP_THREADS)
+#define SEM_PAIRS 2
+#define SEM_ITEMS 200000
+
+static tt_sem_t items;
+static tt_sem_t slots;
+
+static void *sem_producer(void *arg) {
+  (void)arg;
+  for (int i = 0; i < SEM_ITEMS; i++) {
+    tt_sem_wait(&slots);
+    tt_sem_post(&items);
+  }
+  return NULL;
+}
+
+static void *sem_consumer(void *arg) {
+  (void)arg;
+  uintptr_t consumed = 0;
+  for (int i = 0; i < SEM_ITEMS; i++) {
+    if (tt_sem_wait(&items) == TT_SUCCESS) {
+      consumed++;
+    }
+    tt_sem_post(&slots);
+  }
+  return (void *)consumed;
+}
+
+TT_TEST(test_sem_throughput) {
+  tt_thread_t *threads[2 * SEM_PAIRS];
+  void *retval;
+
+  TT_ASSERT_EQUAL(TT_SUCCESS, tt_thread_init(), "%d");
+  TT_ASSERT_EQUAL(TT_SUCCESS, tt_sem_init(&items, 0), "%d");
+  TT_ASSERT_EQUAL(TT_SUCCESS, tt_sem_init(&slots, 64), "%d");
+
+  uint64_t start = tt_platform_time_monotonic_ns();
+  for (int i = 0; i < SEM_PAIRS; i++) {
+    TT_ASSERT_EQUAL(
+        TT_SUCCESS,
+        tt_thread_create(&threads[2 * i], NULL, sem_producer, NULL), "%d");
+    TT_ASSERT_EQUAL(
+        TT_SUCCESS,
+        tt_thread_create(&threads[2 * i + 1], NULL, sem_consumer, NULL),
+        "%d");
+  }
+
+  uintptr_t consumed = 0;
+  for (int i = 0; i < 2 * SEM_PAIRS; i++) {
+    TT_ASSERT_EQUAL(TT_SUCCESS, tt_thread_join(threads[i], &retval), "%d");
+    consumed += (uintptr_t)retval;
+    tt_thread_destroy(threads[i]);
+  }
+  uint64_t elapsed_ns = tt_platform_time_monotonic_ns() - start;
+
+  TT_ASSERT_EQUAL((uintptr_t)SEM_PAIRS * SEM_ITEMS, consumed, "%lu");
+  TT_ASSERT_EQUAL(0u, tt_sem_get_value(&items), "%u");
+  TT_ASSERT_EQUAL(64u, tt_sem_get_value(&slots), "%u");
+
+  printf(" [%.0f ops/s]",
+         (2.0 * SEM_PAIRS * SEM_ITEMS) / ((double)elapsed_ns / 1e9));
+
+  TT_ASSERT_EQUAL(TT_SUCCESS, tt_sem_destroy(&items), "%d");
+  TT_ASSERT_EQUAL(TT_SUCCESS, tt_sem_destroy(&slots), "%d");
+  return true;
+}
+#endif /* TT_CAP_THREADS */
+
+int main(void) {
+  TT_TEST_START("Semaphore Test Suite");
+
+  TT_SET_FIXTURES(setUp, tearDown);
+
+  TT_RUN_TEST(test_sem_null_pointer);
+  TT_RUN_TEST(test_sem_post_trywait);
+  TT_RUN_TEST(test_sem_timedwait);
+#if defined(TT_CAP_THREADS)
+  TT_RUN_TEST(test_sem_throughput);
+#endif /* TT_CAP_THREADS */
+
+  TT_TEST_END();
+  return 0;
+}
@@ -0,0 +1,174 @@
+/**
+ * @file test_task.c
+ * @author Mihai Gurei <mihai.gurei@protonmail.com>
+ * @date 2025-01-27
+ * @brief Work-stealing scheduler test suite
+ * @copyright Copyright (c) 2025 AnAlphaBeta. All rights reserved.
+ */
+
+#include "tt_platform.h"
+#include "tt_task.h"
+#include "tt_test.h"
+#include "tt_thread.h"
+#include <stdint.h>
+
+void setUp(void) {}
+
+void tearDown(void) {}
+
+TT_TEST(test_task_null_pointer) {
+  TT_ASSERT_EQUAL(TT_ERROR_NULL_POINTER, tt_scheduler_create(NULL, 1, NULL),
+                  "%d");
+#if defined(TT_CAP_THREADS)
+  TT_ASSERT_EQUAL(TT_ERROR_NULL_POINTER, tt_scheduler_destroy(NULL), "%d");
+  TT_ASSERT_EQUAL(TT_ERROR_NULL_POINTER, tt_task_group_init(NULL, NULL), "%d");
+  TT_ASSERT_EQUAL(TT_ERROR_NULL_POINTER, tt_task_spawn(NULL, NULL, NULL),
+                  "%d");
+  TT_ASSERT_EQUAL(TT_ERROR_NULL_POINTER, tt_task_sync(NULL), "%d");
+#else
+  tt_scheduler_t *scheduler = NULL;
+  TT_ASSERT_EQUAL(TT_ERROR_NOT_IMPLEMENTED,
+                  tt_scheduler_create(&scheduler, 1, NULL), "%d");
+#endif /* TT_CAP_THREADS */
+  return true;
+}
+
+#if defined(TT_CAP_THREADS)
+#define TASK_WORKERS 4
+#define FIB_N 22
+#define FIB_RESULT 17711
+#define FAN_OUT 1000
+
+static tt_scheduler_t *fib_scheduler;
+static volatile uint32_t fib_tasks;
+
+typedef struct {
+  int n;
+  uint64_t result;
+} fib_arg_t;
+
+/* Recursive fib that spawns one branch and runs the other inline */
+static void fib_task(void *arg) {
+  fib_arg_t *fib = (fib_arg_t *)arg;
+
+  __atomic_fetch_add(&fib_tasks, 1, __ATOMIC_RELAXED);
+  if (fib->n < 2) {
+    fib->result = (uint64_t)fib->n;
+    return;
+  }
+
+  tt_task_group_t group;
+  fib_arg_t left = {.n = fib->n - 1, .result = 0};
+  fib_arg_t right = {.n = fib->n - 2, .result = 0};
+
+  tt_task_group_init(&group, fib_scheduler);
+  tt_task_spawn(&group, fib_task, &left);
+  fib_task(&right);
+  tt_task_sync(&group);
+
+  fib->result = left.result + right.result;
+}
+
+static bool run_fib(size_t workers, uint64_t *elapsed_ns) {
+  tt_task_group_t group;
+  fib_arg_t root = {.n = FIB_N, .result = 0};
+
+  fib_tasks = 0;
+  TT_ASSERT_EQUAL(TT_SUCCESS, tt_scheduler_create(&fib_scheduler, workers, NULL),
+                  "%d");
+
+  uint64_t start = tt_platform_time_monotonic_ns();
+  TT_ASSERT_EQUAL(TT_SUCCESS, tt_task_group_init(&group, fib_scheduler), "%d");
+  TT_ASSERT_EQUAL(TT_SUCCESS, tt_task_spawn(&group, fib_task, &root), "%d");
+  TT_ASSERT_EQUAL(TT_SUCCESS, tt_task_sync(&group), "%d");
+  *elapsed_ns = tt_platform_time_monotonic_ns() - start;
+
+  TT_ASSERT_EQUAL((uint64_t)FIB_RESULT, root.result, "%lu");
+  TT_ASSERT_EQUAL(TT_SUCCESS, tt_scheduler_destroy(fib_scheduler), "%d");
+  return true;
+}
+
+TT_TEST(test_task_invalid) {
+  tt_scheduler_t *scheduler = NULL;
+
+  TT_ASSERT_EQUAL(TT_ERROR_INVALID_PARAM, tt_scheduler_create(&scheduler, 0, NULL),
+                  "%d");
+  return true;
+}
+
+TT_TEST(test_task_fib_single_worker) {
+  uint64_t elapsed_ns;
+
+  // Sync must run its own children when nobody else can steal them
+  return run_fib(1, &elapsed_ns);
+}
+
+TT_TEST(test_task_fib) {
+  uint64_t elapsed_ns;
+
+  if (!run_fib(TASK_WORKERS, &elapsed_ns)) {
+    return false;
+  }
+  printf(" [%u tasks, %.1fns per task]", fib_tasks,
+         (double)elapsed_ns / fib_tasks);
+  return true;
+}
+
+static volatile uint32_t fan_count;
+
+static void fan_leaf(void *arg) {
+  (void)arg;
+  __atomic_fetch_add(&fan_count, 1, __ATOMIC_RELAXED);
+}
+
+static void fan_root(void *arg) {
+  tt_task_group_t group;
+
+  // More children than the initial deque holds
+  tt_task_group_init(&group, (tt_scheduler_t *)arg);
+  for (int i = 0; i < FAN_OUT; i++) {
+    tt_task_spawn(&group, fan_leaf, NULL);
+  }
+  tt_task_sync(&group);
+}
+
+TT_TEST(test_task_fan_out) {
+  tt_scheduler_t *scheduler = NULL;
+  tt_task_group_t group;
+
+  fan_count = 0;
+  TT_ASSERT_EQUAL(TT_SUCCESS,
+                  tt_scheduler_create(&scheduler, TASK_WORKERS, NULL), "%d");
+  TT_ASSERT_EQUAL(TT_SUCCESS, tt_task_group_init(&group, scheduler), "%d");
+
+  // Several roots from outside the scheduler, reusing the group
+  for (int round = 1; round <= 3; round++) {
+    for (int i = 0; i < 4; i++) {
+      TT_ASSERT_EQUAL(TT_SUCCESS, tt_task_spawn(&group, fan_root, scheduler),
+                      "%d");
+    }
+    TT_ASSERT_EQUAL(TT_SUCCESS, tt_task_sync(&group), "%d");
+    TT_ASSERT_EQUAL((uint32_t)(round * 4 * FAN_OUT), fan_count, "%u");
+  }
+
+  TT_ASSERT_EQUAL(TT_SUCCESS, tt_scheduler_destroy(scheduler), "%d");
+  return true;
+}
+#endif /* TT_CAP_THREADS */
+
+int main(void) {
+  TT_TEST_START("Task Scheduler Test Suite");
+
+  TT_SET_FIXTURES(setUp, tearDown);
+
+  TT_RUN_TEST(test_task_null_pointer);
+#if defined(TT_CAP_THREADS)
+  TT_RUN_TEST(test_task_invalid);
+  TT_RUN_TEST(test_task_fib_single_worker);
+  TT_RUN_TEST(test_task_fib);
+  TT_RUN_TEST(test_task_fan_out);
+#endif /* TT_CAP_THREADS */
+
+  TT_TEST_END();
+  return 0;
+}
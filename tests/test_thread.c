@@ -6,6 +6,8 @@
  * @copyright Copyright (c) 2024 AnAlphaBeta. All rights reserved.
  */
 
+#define _GNU_SOURCE /* Thread CPU clocks, names and SCHED_BATCH */
+
 #include "tt_atomic.h"
 #include "tt_mutex.h"
 #include "tt_platform.h"
@@ -14,6 +16,10 @@
 #include "tt_thread_internal.h"
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
 
 // DEBUG PRINTS ON/OFF
 #define TEST_THREAD_PRINT 0
@@ -50,22 +56,19 @@ static void test_setup(void) {
 
 #if (TEST_THREAD_PRINT == 1)
 void tt_thread_table_print_status(void) {
+  static tt_thread_t *threads[TT_THREAD_TABLE_CAPACITY];
+  size_t count = tt_thread_table_snapshot(threads, TT_THREAD_TABLE_CAPACITY);
+
   printf("\nThread Table Status\n");
   printf("----------------------------------------\n");
-  printf("Index | In Use |    Thread Ptr    | State\n");
+  printf(" Slot  |    Thread Ptr    | State\n");
   printf("----------------------------------------\n");
 
-  tt_mutex_lock(&g_thread_table_mutex);
-
-  for (size_t i = 0; i < TT_MAX_THREADS; i++) {
-    if (g_thread_table[i].in_use) {
-      printf("[%3zu] |   YES   | %p | %d\n", i,
-             (void *)&g_thread_table[i].thread,
-             g_thread_table[i].thread->state);
-    }
+  for (size_t i = 0; i < count; i++) {
+    printf("[%4u] | %p | %d\n", threads[i]->table_slot, (void *)threads[i],
+           threads[i]->state);
   }
 
-  tt_mutex_unlock(&g_thread_table_mutex);
   printf("----------------------------------------\n\n");
 }
 #endif /* TEST_THREAD_PRINT */
@@ -183,6 +186,26 @@ TT_TEST(test_thread_sleep) {
   return true;
 }
 
+static void *report_policy(void *arg) {
+  (void)arg;
+  int policy = -1;
+  struct sched_param param;
+  pthread_getschedparam(pthread_self(), &policy, &param);
+  return (void *)(intptr_t)policy;
+}
+
+/* Memory policy mode of the calling thread, -1 without NUMA support */
+static void *report_mempolicy(void *arg) {
+  (void)arg;
+  int mode = -1;
+#if defined(SYS_get_mempolicy)
+  if (syscall(SYS_get_mempolicy, &mode, NULL, 0, NULL, 0) != 0) {
+    mode = -1;
+  }
+#endif
+  return (void *)(intptr_t)mode;
+}
+
 TT_TEST(test_thread_priority) {
   test_setup();
 
@@ -191,8 +214,23 @@ TT_TEST(test_thread_priority) {
   tt_error_t result = tt_thread_create(&thread, NULL, increment_counter, NULL);
   TT_ASSERT_EQUAL(TT_SUCCESS, result, "%d");
 
+  // Real-time levels need CAP_SYS_NICE, anything else must be reported
   result = tt_thread_set_priority(thread, TT_THREAD_PRIORITY_HIGH);
-  TT_ASSERT_EQUAL(TT_SUCCESS, result, "%d");
+  TT_ASSERT(result == TT_SUCCESS || result == TT_ERROR_THREAD_PRIORITY);
+  result = tt_thread_set_priority(thread, TT_THREAD_PRIORITY_LOW);
+  TT_ASSERT(result == TT_SUCCESS || result == TT_ERROR_THREAD_PRIORITY);
+  TT_ASSERT_EQUAL(TT_ERROR_INVALID_PARAM,
+                  tt_thread_set_priority(thread, (tt_thread_priority_t)42),
+                  "%d");
+
+  // The reported range spans what the levels map to, not SCHED_OTHER's 0..0
+  tt_platform_info_t info;
+  result = tt_platform_init();
+  TT_ASSERT(result == TT_SUCCESS || result == TT_ERROR_ALREADY_INITIALIZED);
+  TT_ASSERT_EQUAL(TT_SUCCESS, tt_platform_get_info(&info), "%d");
+  TT_ASSERT_EQUAL(0, info.thread.min_priority, "%d");
+  TT_ASSERT_EQUAL(sched_get_priority_max(SCHED_FIFO) - 1,
+                  info.thread.max_priority, "%d");
 
   result = tt_thread_join(thread, &retval);
   TT_ASSERT_EQUAL(TT_SUCCESS, result, "%d");
@@ -202,6 +240,34 @@ TT_TEST(test_thread_priority) {
   return true;
 }
 
+TT_TEST(test_thread_priority_attr) {
+  test_setup();
+
+  tt_thread_t *thread;
+  tt_thread_attr_t attr;
+  void *retval = NULL;
+
+  tt_thread_attr_init(&attr);
+  attr.priority = TT_THREAD_PRIORITY_REALTIME;
+  tt_error_t result = tt_thread_create(&thread, &attr, report_policy, NULL);
+  if (result == TT_ERROR_THREAD_PRIORITY) {
+    printf(" [no real-time privilege]");
+    return true;
+  }
+  TT_ASSERT_EQUAL(TT_SUCCESS, result, "%d");
+  TT_ASSERT_EQUAL(TT_SUCCESS, tt_thread_join(thread, &retval), "%d");
+  TT_ASSERT_EQUAL(SCHED_FIFO, (int)(intptr_t)retval, "%d");
+  tt_thread_destroy(thread);
+
+  attr.priority = TT_THREAD_PRIORITY_HIGH;
+  TT_ASSERT_EQUAL(TT_SUCCESS,
+                  tt_thread_create(&thread, &attr, report_policy, NULL), "%d");
+  TT_ASSERT_EQUAL(TT_SUCCESS, tt_thread_join(thread, &retval), "%d");
+  TT_ASSERT_EQUAL(SCHED_RR, (int)(intptr_t)retval, "%d");
+  tt_thread_destroy(thread);
+  return true;
+}
+
 TT_TEST(test_thread_state) {
   test_setup();
 
@@ -229,6 +295,452 @@ TT_TEST(test_thread_state) {
   return true;
 }
 
+static void *report_self(void *arg) {
+  (void)arg;
+  return tt_thread_self();
+}
+
+TT_TEST(test_thread_self) {
+  test_setup();
+
+  tt_thread_t *thread;
+  void *retval = NULL;
+
+  TT_ASSERT(tt_thread_self() == NULL);
+
+  tt_error_t result = tt_thread_create(&thread, NULL, report_self, NULL);
+  TT_ASSERT_EQUAL(TT_SUCCESS, result, "%d");
+
+  result = tt_thread_join(thread, &retval);
+  TT_ASSERT_EQUAL(TT_SUCCESS, result, "%d");
+  TT_ASSERT(retval == thread);
+
+  tt_thread_destroy(thread);
+  return true;
+}
+
+static volatile uint64_t suspend_progress;
+static volatile bool suspend_stop;
+
+static void *checkpoint_loop(void *arg) {
+  (void)arg;
+  while (!__atomic_load_n(&suspend_stop, __ATOMIC_ACQUIRE)) {
+    __atomic_fetch_add(&suspend_progress, 1, __ATOMIC_RELAXED);
+    tt_thread_checkpoint();
+  }
+  return NULL;
+}
+
+static void *suspend_self(void *arg) {
+  (void)arg;
+  tt_thread_suspend(tt_thread_self());
+  return (void *)(uintptr_t)suspend_progress;
+}
+
+/* Poll until the thread reports the given state, false after about 1s */
+static bool wait_for_state(tt_thread_t *thread, tt_thread_state_t wanted) {
+  tt_thread_state_t state;
+  for (int i = 0; i < 1000; i++) {
+    if (tt_thread_get_state(thread, &state) == TT_SUCCESS && state == wanted) {
+      return true;
+    }
+    tt_thread_sleep(1);
+  }
+  return false;
+}
+
+static uint64_t thread_cpu_ns(tt_thread_t *thread) {
+  clockid_t clock;
+  struct timespec ts;
+  if (pthread_getcpuclockid(thread->handle, &clock) != 0 ||
+      clock_gettime(clock, &ts) != 0) {
+    return 0;
+  }
+  return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+TT_TEST(test_thread_suspend_resume) {
+  test_setup();
+
+  tt_thread_t *thread;
+  suspend_progress = 0;
+  suspend_stop = false;
+
+  TT_ASSERT_EQUAL(TT_ERROR_NULL_POINTER, tt_thread_suspend(NULL), "%d");
+  TT_ASSERT_EQUAL(TT_ERROR_NULL_POINTER, tt_thread_resume(NULL), "%d");
+  // Not a tt thread: nothing to park
+  TT_ASSERT_EQUAL(TT_SUCCESS, tt_thread_checkpoint(), "%d");
+
+  TT_ASSERT_EQUAL(TT_SUCCESS,
+                  tt_thread_create(&thread, NULL, checkpoint_loop, NULL), "%d");
+  TT_ASSERT_EQUAL(TT_SUCCESS, tt_thread_suspend(thread), "%d");
+  TT_ASSERT(wait_for_state(thread, TT_THREAD_STATE_SUSPENDED));
+
+  // Parked: no progress and no CPU time while suspended
+  uint64_t progress = __atomic_load_n(&suspend_progress, __ATOMIC_RELAXED);
+  uint64_t cpu = thread_cpu_ns(thread);
+  tt_thread_sleep(50);
+  TT_ASSERT_EQUAL((unsigned long)progress,
+                  (unsigned long)__atomic_load_n(&suspend_progress,
+                                                 __ATOMIC_RELAXED),
+                  "%lu");
+  TT_ASSERT(thread_cpu_ns(thread) - cpu < 1000000ULL);
+
+  TT_ASSERT_EQUAL(TT_SUCCESS, tt_thread_resume(thread), "%d");
+  TT_ASSERT(wait_for_state(thread, TT_THREAD_STATE_RUNNING));
+  while (__atomic_load_n(&suspend_progress, __ATOMIC_RELAXED) == progress) {
+    tt_thread_sleep(1);
+  }
+
+  __atomic_store_n(&suspend_stop, true, __ATOMIC_RELEASE);
+  TT_ASSERT_EQUAL(TT_SUCCESS, tt_thread_join(thread, NULL), "%d");
+  tt_thread_destroy(thread);
+
+  // A thread suspending itself stays parked until resumed
+  void *retval = NULL;
+  suspend_progress = 7;
+  TT_ASSERT_EQUAL(TT_SUCCESS,
+                  tt_thread_create(&thread, NULL, suspend_self, NULL), "%d");
+  TT_ASSERT(wait_for_state(thread, TT_THREAD_STATE_SUSPENDED));
+  suspend_progress = 8;
+  TT_ASSERT_EQUAL(TT_SUCCESS, tt_thread_resume(thread), "%d");
+  TT_ASSERT_EQUAL(TT_SUCCESS, tt_thread_join(thread, &retval), "%d");
+  TT_ASSERT_EQUAL(8UL, (unsigned long)(uintptr_t)retval, "%lu");
+  tt_thread_destroy(thread);
+  return true;
+}
+
+static void *report_name(void *arg) {
+  static _Thread_local char name[16];
+  (void)arg;
+  pthread_getname_np(pthread_self(), name, sizeof(name));
+  return name;
+}
+
+static void *noop(void *arg) { return arg; }
+
+/* Average create, join and destroy round trip in nanoseconds */
+static uint64_t create_round_trip_ns(int rounds) {
+  tt_thread_t *thread;
+  uint64_t start = tt_platform_time_monotonic_ns();
+  for (int i = 0; i < rounds; i++) {
+    if (tt_thread_create(&thread, NULL, noop, NULL) != TT_SUCCESS) {
+      return 0;
+    }
+    tt_thread_join(thread, NULL);
+    tt_thread_destroy(thread);
+  }
+  return (tt_platform_time_monotonic_ns() - start) / (uint64_t)rounds;
+}
+
+TT_TEST(test_thread_cache) {
+  test_setup();
+
+  tt_thread_t *thread;
+  tt_thread_attr_t attr;
+  void *retval = NULL;
+
+  TT_ASSERT_EQUAL(TT_ERROR_INVALID_PARAM, tt_thread_cache_init(0), "%d");
+  uint64_t cold_ns = create_round_trip_ns(200);
+  TT_ASSERT_EQUAL(TT_SUCCESS, tt_thread_cache_init(4), "%d");
+
+  TT_ASSERT_EQUAL(TT_SUCCESS,
+                  tt_thread_create(&thread, NULL, report_self, NULL), "%d");
+  pthread_t first = thread->handle;
+  TT_ASSERT_EQUAL(TT_SUCCESS, tt_thread_join(thread, &retval), "%d");
+  TT_ASSERT(retval == thread);
+  tt_thread_destroy(thread);
+
+  // Same OS thread again, with the new attributes applied
+  tt_thread_attr_init(&attr);
+  attr.name = "cached-worker-name";
+  attr.priority = TT_THREAD_PRIORITY_LOW;
+  TT_ASSERT_EQUAL(TT_SUCCESS,
+                  tt_thread_create(&thread, &attr, report_name, NULL), "%d");
+  TT_ASSERT(pthread_equal(first, thread->handle));
+  TT_ASSERT_EQUAL(TT_SUCCESS, tt_thread_join(thread, &retval), "%d");
+  TT_ASSERT(strcmp("cached-worker-n", (const char *)retval) == 0);
+  tt_thread_destroy(thread);
+
+  TT_ASSERT_EQUAL(TT_SUCCESS,
+                  tt_thread_create(&thread, &attr, report_policy, NULL), "%d");
+  TT_ASSERT_EQUAL(TT_SUCCESS, tt_thread_join(thread, &retval), "%d");
+  TT_ASSERT_EQUAL(SCHED_BATCH, (int)(intptr_t)retval, "%d");
+  tt_thread_destroy(thread);
+
+  // Back to the defaults, nothing of the previous job survives
+  TT_ASSERT_EQUAL(TT_SUCCESS,
+                  tt_thread_create(&thread, NULL, report_policy, NULL), "%d");
+  TT_ASSERT(pthread_equal(first, thread->handle));
+  TT_ASSERT_EQUAL(TT_SUCCESS, tt_thread_join(thread, &retval), "%d");
+  TT_ASSERT_EQUAL(SCHED_OTHER, (int)(intptr_t)retval, "%d");
+  tt_thread_destroy(thread);
+
+  // More threads at once than the cache keeps
+  tt_thread_t *threads[8];
+  for (int i = 0; i < 8; i++) {
+    TT_ASSERT_EQUAL(TT_SUCCESS,
+                    tt_thread_create(&threads[i], NULL, increment_counter,
+                                     NULL),
+                    "%d");
+  }
+  for (int i = 0; i < 8; i++) {
+    TT_ASSERT_EQUAL(TT_SUCCESS, tt_thread_join(threads[i], &retval), "%d");
+    TT_ASSERT_EQUAL(ITERATIONS, (int)(uintptr_t)retval, "%d");
+    tt_thread_destroy(threads[i]);
+  }
+
+  uint64_t warm_ns = create_round_trip_ns(200);
+  TT_ASSERT_EQUAL(TT_SUCCESS, tt_thread_cache_cleanup(), "%d");
+  TT_ASSERT(warm_ns > 0);
+
+  printf(" [create+join: %.1fus cold, %.1fus cached]", (double)cold_ns / 1e3,
+         (double)warm_ns / 1e3);
+  return true;
+}
+
+/* Scheduling a NORMAL child ends up with, as seen by the child itself */
+typedef struct {
+  pthread_t handle;
+  int policy;
+  cpu_set_t cpus;
+} sched_report_t;
+
+static void *report_sched(void *arg) {
+  sched_report_t *report = (sched_report_t *)arg;
+  struct sched_param param;
+
+  report->handle = pthread_self();
+  pthread_getschedparam(pthread_self(), &report->policy, &param);
+  pthread_getaffinity_np(pthread_self(), sizeof(report->cpus), &report->cpus);
+  return NULL;
+}
+
+/* Pin itself to CPU 0, then start a NORMAL child that must inherit that */
+static void *create_normal_child(void *arg) {
+  tt_thread_t *child;
+  cpu_set_t set;
+
+  CPU_ZERO(&set);
+  CPU_SET(0, &set);
+  if (pthread_setaffinity_np(pthread_self(), sizeof(set), &set) != 0 ||
+      tt_thread_create(&child, NULL, report_sched, arg) != TT_SUCCESS) {
+    return NULL;
+  }
+  tt_thread_join(child, NULL);
+  tt_thread_destroy(child);
+  return arg;
+}
+
+static volatile uint32_t hold_released;
+
+static void *hold(void *arg) {
+  while (!__atomic_load_n(&hold_released, __ATOMIC_ACQUIRE)) {
+    tt_thread_sleep(1);
+  }
+  return arg;
+}
+
+TT_TEST(test_thread_cache_inherit) {
+  test_setup();
+
+  tt_thread_t *creator;
+  tt_thread_t *warm[2];
+  tt_thread_attr_t attr;
+  sched_report_t fresh;
+  sched_report_t cached;
+  void *retval = NULL;
+
+  // A LOW creator runs as SCHED_BATCH, which a NORMAL child inherits
+  tt_thread_attr_init(&attr);
+  attr.priority = TT_THREAD_PRIORITY_LOW;
+  TT_ASSERT_EQUAL(TT_SUCCESS,
+                  tt_thread_create(&creator, &attr, create_normal_child,
+                                   &fresh),
+                  "%d");
+  TT_ASSERT_EQUAL(TT_SUCCESS, tt_thread_join(creator, &retval), "%d");
+  TT_ASSERT(retval == &fresh);
+  tt_thread_destroy(creator);
+  TT_ASSERT_EQUAL(SCHED_BATCH, fresh.policy, "%d");
+
+  // Two idle carriers set up by the main thread: one for the creator, one
+  // for its child
+  TT_ASSERT_EQUAL(TT_SUCCESS, tt_thread_cache_init(4), "%d");
+  hold_released = 0;
+  for (int i = 0; i < 2; i++) {
+    TT_ASSERT_EQUAL(TT_SUCCESS, tt_thread_create(&warm[i], NULL, hold, NULL),
+                    "%d");
+  }
+  __atomic_store_n(&hold_released, 1, __ATOMIC_RELEASE);
+  for (int i = 0; i < 2; i++) {
+    TT_ASSERT_EQUAL(TT_SUCCESS, tt_thread_join(warm[i], NULL), "%d");
+  }
+
+  TT_ASSERT_EQUAL(TT_SUCCESS,
+                  tt_thread_create(&creator, &attr, create_normal_child,
+                                   &cached),
+                  "%d");
+  TT_ASSERT_EQUAL(TT_SUCCESS, tt_thread_join(creator, &retval), "%d");
+  TT_ASSERT(retval == &cached);
+  tt_thread_destroy(creator);
+  TT_ASSERT(pthread_equal(cached.handle, warm[0]->handle) ||
+            pthread_equal(cached.handle, warm[1]->handle));
+  for (int i = 0; i < 2; i++) {
+    tt_thread_destroy(warm[i]);
+  }
+  TT_ASSERT_EQUAL(TT_SUCCESS, tt_thread_cache_cleanup(), "%d");
+
+  // A reused carrier looks exactly like a fresh thread
+  TT_ASSERT_EQUAL(fresh.policy, cached.policy, "%d");
+  TT_ASSERT(CPU_EQUAL(&fresh.cpus, &cached.cpus));
+  TT_ASSERT_EQUAL(1, CPU_COUNT(&cached.cpus), "%d");
+  return true;
+}
+
+TT_TEST(test_thread_affinity) {
+  test_setup();
+
+  tt_thread_t *thread;
+  tt_thread_attr_t attr;
+  void *retval = NULL;
+
+  TT_ASSERT_EQUAL(TT_SUCCESS, tt_thread_attr_init(&attr), "%d");
+  TT_ASSERT_EQUAL((uint64_t)0, attr.affinity, "%lu");
+  TT_ASSERT_EQUAL((uint64_t)0, attr.numa_mask, "%lu");
+
+  // CPU 0 and NUMA node 0 exist everywhere; the node is only a preference
+  attr.affinity = 1;
+  attr.numa_mask = 1;
+  tt_error_t result = tt_thread_create(&thread, &attr, report_self, NULL);
+  TT_ASSERT_EQUAL(TT_SUCCESS, result, "%d");
+
+  TT_ASSERT_EQUAL(TT_SUCCESS, tt_thread_set_affinity(thread, 0), "%d");
+  TT_ASSERT_EQUAL(TT_SUCCESS, tt_thread_set_affinity(thread, 1), "%d");
+
+  result = tt_thread_join(thread, &retval);
+  TT_ASSERT_EQUAL(TT_SUCCESS, result, "%d");
+  TT_ASSERT(retval == thread);
+  tt_thread_destroy(thread);
+
+  TT_ASSERT_EQUAL(TT_ERROR_NULL_POINTER, tt_thread_set_affinity(NULL, 1),
+                  "%d");
+
+  // Several nodes are all preferred where the kernel has PREFERRED_MANY (5),
+  // older kernels fall back to PREFERRED (1)
+  attr.affinity = 0;
+  attr.numa_mask = 3;
+  result = tt_thread_create(&thread, &attr, report_mempolicy, NULL);
+  TT_ASSERT_EQUAL(TT_SUCCESS, result, "%d");
+  TT_ASSERT_EQUAL(TT_SUCCESS, tt_thread_join(thread, &retval), "%d");
+  int mode = (int)(intptr_t)retval;
+  TT_ASSERT(mode == -1 || mode == 5 || mode == 1);
+  tt_thread_destroy(thread);
+
+  // A mask of CPUs the machine does not have is rejected
+  uint32_t cpus = (uint32_t)sysconf(_SC_NPROCESSORS_CONF);
+  if (cpus < 64) {
+    attr.affinity = ~UINT64_C(0) << cpus;
+    attr.numa_mask = 0;
+    result = tt_thread_create(&thread, &attr, report_self, NULL);
+    TT_ASSERT_EQUAL(TT_ERROR_INVALID_PARAM, result, "%d");
+  }
+  return true;
+}
+
+#define TABLE_TEST_THREADS (3 * TT_THREAD_TABLE_SEGMENT_SLOTS + 5)
+#define TABLE_CHURN_ROUNDS 2000
+
+static tt_thread_t table_threads[TABLE_TEST_THREADS];
+static tt_thread_t *table_view[TT_THREAD_TABLE_CAPACITY];
+
+TT_TEST(test_thread_table_growth) {
+  test_setup();
+
+  size_t base = tt_thread_table_snapshot(table_view, TT_THREAD_TABLE_CAPACITY);
+
+  // More entries than one segment holds forces the table to grow
+  for (size_t i = 0; i < TABLE_TEST_THREADS; i++) {
+    TT_ASSERT_EQUAL(TT_SUCCESS, tt_thread_table_register(&table_threads[i]),
+                    "%d");
+  }
+  TT_ASSERT_EQUAL(base + TABLE_TEST_THREADS,
+                  tt_thread_table_snapshot(table_view,
+                                           TT_THREAD_TABLE_CAPACITY),
+                  "%zu");
+
+  // Freed slots are handed out again before the table grows further
+  uint32_t slot = table_threads[7].table_slot;
+  TT_ASSERT_EQUAL(TT_SUCCESS, tt_thread_table_unregister(&table_threads[7]),
+                  "%d");
+  TT_ASSERT_EQUAL(TT_ERROR_NOT_FOUND,
+                  tt_thread_table_unregister(&table_threads[7]), "%d");
+  TT_ASSERT_EQUAL(TT_SUCCESS, tt_thread_table_register(&table_threads[7]),
+                  "%d");
+  TT_ASSERT_EQUAL(slot, table_threads[7].table_slot, "%u");
+
+  for (size_t i = 0; i < TABLE_TEST_THREADS; i++) {
+    TT_ASSERT_EQUAL(TT_SUCCESS, tt_thread_table_unregister(&table_threads[i]),
+                    "%d");
+  }
+  TT_ASSERT_EQUAL(base,
+                  tt_thread_table_snapshot(table_view,
+                                           TT_THREAD_TABLE_CAPACITY),
+                  "%zu");
+  return true;
+}
+
+static void *table_churn(void *arg) {
+  tt_thread_t *mine = (tt_thread_t *)arg;
+
+  for (int round = 0; round < TABLE_CHURN_ROUNDS; round++) {
+    for (int i = 0; i < 8; i++) {
+      if (tt_thread_table_register(&mine[i]) != TT_SUCCESS) {
+        return NULL;
+      }
+    }
+    for (int i = 0; i < 8; i++) {
+      if (tt_thread_table_unregister(&mine[i]) != TT_SUCCESS) {
+        return NULL;
+      }
+    }
+  }
+  return (void *)1;
+}
+
+TT_TEST(test_thread_table_concurrent) {
+  test_setup();
+
+  tt_thread_t *threads[NUM_THREADS];
+  void *retval;
+
+  size_t base = tt_thread_table_snapshot(table_view, TT_THREAD_TABLE_CAPACITY);
+
+  for (int i = 0; i < NUM_THREADS; i++) {
+    tt_error_t result = tt_thread_create(&threads[i], NULL, table_churn,
+                                         &table_threads[i * 8]);
+    TT_ASSERT_EQUAL(TT_SUCCESS, result, "%d");
+  }
+
+  // Snapshots must not block or fail while the table churns
+  for (int i = 0; i < 100; i++) {
+    size_t count =
+        tt_thread_table_snapshot(table_view, TT_THREAD_TABLE_CAPACITY);
+    TT_ASSERT(count <= base + NUM_THREADS + NUM_THREADS * 8);
+  }
+
+  for (int i = 0; i < NUM_THREADS; i++) {
+    TT_ASSERT_EQUAL(TT_SUCCESS, tt_thread_join(threads[i], &retval), "%d");
+    TT_ASSERT(retval != NULL);
+    tt_thread_destroy(threads[i]);
+  }
+
+  TT_ASSERT_EQUAL(base,
+                  tt_thread_table_snapshot(table_view,
+                                           TT_THREAD_TABLE_CAPACITY),
+                  "%zu");
+  return true;
+}
+
 #endif /* TT_CAP_THREADS */
 /* Test suite main function */
 int main(void) {
@@ -240,7 +752,15 @@ int main(void) {
   TT_RUN_TEST(test_thread_concurrent_execution);
   TT_RUN_TEST(test_thread_sleep);
   TT_RUN_TEST(test_thread_priority);
+  TT_RUN_TEST(test_thread_priority_attr);
   TT_RUN_TEST(test_thread_state);
+  TT_RUN_TEST(test_thread_self);
+  TT_RUN_TEST(test_thread_suspend_resume);
+  TT_RUN_TEST(test_thread_cache);
+  TT_RUN_TEST(test_thread_cache_inherit);
+  TT_RUN_TEST(test_thread_affinity);
+  TT_RUN_TEST(test_thread_table_growth);
+  TT_RUN_TEST(test_thread_table_concurrent);
 #else
   printf("Thread capability inactive. Add -DTT_CAP_THREADS to activate it.\n");
 #endif /* TT_CAP_THREADS */
@@ -0,0 +1,160 @@
+/**
+ * @file test_threadpool.c
+ * @author Mihai Gurei <mihai.gurei@protonmail.com>
+ * @date 2025-01-24
+ * @brief Thread pool test suite
+ * @copyright Copyright (c) 2025 AnAlphaBeta. All rights reserved.
+ */
+
+#include "tt_platform.h"
+#include "tt_test.h"
+#include "tt_thread.h"
+#include "tt_threadpool.h"
+#include <stdint.h>
+
+void setUp(void) {}
+
+void tearDown(void) {}
+
+TT_TEST(test_threadpool_null_pointer) {
+  TT_ASSERT_EQUAL(TT_ERROR_NULL_POINTER, tt_threadpool_create(NULL, 1, NULL),
+                  "%d");
+  TT_ASSERT_EQUAL((size_t)0, tt_threadpool_size(NULL), "%zu");
+#if defined(TT_CAP_THREADS)
+  TT_ASSERT_EQUAL(TT_ERROR_NULL_POINTER, tt_threadpool_submit(NULL, NULL, NULL),
+                  "%d");
+  TT_ASSERT_EQUAL(TT_ERROR_NULL_POINTER, tt_threadpool_wait_idle(NULL), "%d");
+  TT_ASSERT_EQUAL(TT_ERROR_NULL_POINTER, tt_threadpool_destroy(NULL), "%d");
+#else
+  tt_threadpool_t *pool = NULL;
+  TT_ASSERT_EQUAL(TT_ERROR_NOT_IMPLEMENTED,
+                  tt_threadpool_create(&pool, 1, NULL), "%d");
+#endif /* TT_CAP_THREADS */
+  return true;
+}
+
+#if defined(TT_CAP_THREADS)
+#define POOL_THREADS 4
+#define POOL_TASKS 10000
+#define SPAWN_TASKS 1000
+
+static volatile uint32_t tasks_run;
+
+static void count_task(void *arg) {
+  __atomic_fetch_add(&tasks_run, (uint32_t)(uintptr_t)arg, __ATOMIC_RELAXED);
+}
+
+static void *count_thread(void *arg) {
+  count_task(arg);
+  return NULL;
+}
+
+TT_TEST(test_threadpool_invalid) {
+  tt_threadpool_t *pool = NULL;
+
+  TT_ASSERT_EQUAL(TT_ERROR_INVALID_PARAM, tt_threadpool_create(&pool, 0, NULL),
+                  "%d");
+  TT_ASSERT_EQUAL(TT_SUCCESS, tt_threadpool_create(&pool, 1, NULL), "%d");
+  TT_ASSERT_EQUAL(TT_ERROR_NULL_POINTER, tt_threadpool_submit(pool, NULL, NULL),
+                  "%d");
+  TT_ASSERT_EQUAL(TT_SUCCESS, tt_threadpool_destroy(pool), "%d");
+  return true;
+}
+
+TT_TEST(test_threadpool_wait_idle) {
+  tt_threadpool_t *pool = NULL;
+
+  tasks_run = 0;
+  TT_ASSERT_EQUAL(TT_SUCCESS, tt_threadpool_create(&pool, POOL_THREADS, NULL),
+                  "%d");
+  TT_ASSERT_EQUAL((size_t)POOL_THREADS, tt_threadpool_size(pool), "%zu");
+
+  // An idle pool returns straight away
+  TT_ASSERT_EQUAL(TT_SUCCESS, tt_threadpool_wait_idle(pool), "%d");
+
+  // Enough tasks to grow the queue past its initial capacity
+  for (int round = 1; round <= 3; round++) {
+    for (int i = 0; i < 4 * TT_THREADPOOL_QUEUE_SIZE; i++) {
+      TT_ASSERT_EQUAL(TT_SUCCESS,
+                      tt_threadpool_submit(pool, count_task, (void *)1), "%d");
+    }
+    TT_ASSERT_EQUAL(TT_SUCCESS, tt_threadpool_wait_idle(pool), "%d");
+    TT_ASSERT_EQUAL((uint32_t)(round * 4 * TT_THREADPOOL_QUEUE_SIZE),
+                    tasks_run, "%u");
+  }
+
+  TT_ASSERT_EQUAL(TT_SUCCESS, tt_threadpool_destroy(pool), "%d");
+  return true;
+}
+
+TT_TEST(test_threadpool_destroy_drains) {
+  tt_threadpool_t *pool = NULL;
+  tt_thread_attr_t attr = {
+      .priority = TT_THREAD_PRIORITY_NORMAL,
+      .stack_size = 64 * 1024,
+      .name = "pool_worker",
+  };
+
+  tasks_run = 0;
+  TT_ASSERT_EQUAL(TT_SUCCESS, tt_threadpool_create(&pool, 2, &attr), "%d");
+  for (int i = 0; i < 100; i++) {
+    TT_ASSERT_EQUAL(TT_SUCCESS, tt_threadpool_submit(pool, count_task, (void *)1),
+                    "%d");
+  }
+  TT_ASSERT_EQUAL(TT_SUCCESS, tt_threadpool_destroy(pool), "%d");
+  TT_ASSERT_EQUAL(100U, tasks_run, "%u");
+  return true;
+}
+
+TT_TEST(test_threadpool_throughput) {
+  tt_threadpool_t *pool = NULL;
+  tt_thread_t *thread;
+
+  tasks_run = 0;
+  TT_ASSERT_EQUAL(TT_SUCCESS, tt_threadpool_create(&pool, POOL_THREADS, NULL),
+                  "%d");
+
+  uint64_t start = tt_platform_time_monotonic_ns();
+  for (int i = 0; i < POOL_TASKS; i++) {
+    tt_threadpool_submit(pool, count_task, (void *)1);
+  }
+  TT_ASSERT_EQUAL(TT_SUCCESS, tt_threadpool_wait_idle(pool), "%d");
+  uint64_t pool_ns = tt_platform_time_monotonic_ns() - start;
+
+  TT_ASSERT_EQUAL((uint32_t)POOL_TASKS, tasks_run, "%u");
+  TT_ASSERT_EQUAL(TT_SUCCESS, tt_threadpool_destroy(pool), "%d");
+
+  // Same work with a thread created and joined per task
+  start = tt_platform_time_monotonic_ns();
+  for (int i = 0; i < SPAWN_TASKS; i++) {
+    tt_thread_create(&thread, NULL, count_thread, (void *)1);
+    tt_thread_join(thread, NULL);
+    tt_thread_destroy(thread);
+  }
+  uint64_t spawn_ns = tt_platform_time_monotonic_ns() - start;
+
+  TT_ASSERT_EQUAL((uint32_t)(POOL_TASKS + SPAWN_TASKS), tasks_run, "%u");
+
+  printf(" [tasks/s: pool %.0f, thread per task %.0f]",
+         POOL_TASKS * 1e9 / (double)pool_ns,
+         SPAWN_TASKS * 1e9 / (double)spawn_ns);
+  return true;
+}
+#endif /* TT_CAP_THREADS */
+
+int main(void) {
+  TT_TEST_START("Thread Pool Test Suite");
+
+  TT_SET_FIXTURES(setUp, tearDown);
+
+  TT_RUN_TEST(test_threadpool_null_pointer);
+#if defined(TT_CAP_THREADS)
+  TT_RUN_TEST(test_threadpool_invalid);
+  TT_RUN_TEST(test_threadpool_wait_idle);
+  TT_RUN_TEST(test_threadpool_destroy_drains);
+  TT_RUN_TEST(test_threadpool_throughput);
+#endif /* TT_CAP_THREADS */
+
+  TT_TEST_END();
+  return 0;
+}